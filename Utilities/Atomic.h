@@ -557,6 +557,33 @@ struct atomic_storage<T, 16> : atomic_storage<T, 0>
 		while (!_InterlockedCompareExchange128((volatile llong*)&dest, hi, lo, cmp));
 		return *(T*)+cmp;
 	}
+#else
+	// Use cmpxchg16b directly (__atomic builtins call libatomic for 16-byte types)
+	static inline bool compare_exchange(T& dest, T& comp, T exch)
+	{
+		const u128 cmp = *(u128*)&comp;
+		const u128 old = __sync_val_compare_and_swap((volatile u128*)&dest, cmp, *(u128*)&exch);
+		*(u128*)&comp = old;
+		return old == cmp;
+	}
+
+	static inline T load(const T& dest)
+	{
+		const u128 result = __sync_val_compare_and_swap((volatile u128*)&dest, u128{0}, u128{0});
+		return *(T*)&result;
+	}
+
+	static inline void store(T& dest, T value)
+	{
+		exchange(dest, value);
+	}
+
+	static inline T exchange(T& dest, T value)
+	{
+		T cmp = dest;
+		while (!compare_exchange(dest, cmp, value));
+		return cmp;
+	}
 #endif
 
 	// TODO
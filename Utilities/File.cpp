@@ -90,6 +90,8 @@ static fs::error to_error(DWORD e)
 	case ERROR_NEGATIVE_SEEK: return fs::error::inval;
 	case ERROR_DIRECTORY: return fs::error::inval;
 	case ERROR_INVALID_NAME: return fs::error::inval;
+	case ERROR_NOT_ENOUGH_MEMORY: return fs::error::nomem;
+	case ERROR_COMMITMENT_LIMIT: return fs::error::nomem;
 	default: fmt::throw_exception("Unknown Win32 error: %u.", e);
 	}
 }
@@ -121,6 +123,7 @@ static fs::error to_error(int e)
 	case EEXIST: return fs::error::exist;
 	case EINVAL: return fs::error::inval;
 	case EACCES: return fs::error::acces;
+	case ENOMEM: return fs::error::nomem;
 	default: fmt::throw_exception("Unknown system error: %d.", e);
 	}
 }
@@ -153,6 +156,24 @@ namespace fs
 	{
 	}
 
+	u64 file_base::read_at(u64 offset, void* buffer, u64 size)
+	{
+		const u64 old_pos = seek(0, seek_cur);
+		seek(offset, seek_set);
+		const u64 result = read(buffer, size);
+		seek(old_pos, seek_set);
+		return result;
+	}
+
+	u64 file_base::write_at(u64 offset, const void* buffer, u64 size)
+	{
+		const u64 old_pos = seek(0, seek_cur);
+		seek(offset, seek_set);
+		const u64 result = write(buffer, size);
+		seek(old_pos, seek_set);
+		return result;
+	}
+
 	dir_base::~dir_base()
 	{
 	}
@@ -714,15 +735,44 @@ fs::file::file(const std::string& path, bs_t<open_mode> mode)
 	class windows_file final : public file_base
 	{
 		const HANDLE m_handle;
+		const DWORD m_access;
+
+		// Additional handle for positional access (its file pointer is never used)
+		atomic_t<HANDLE> m_pos_handle{};
+
+		HANDLE get_pos_handle()
+		{
+			if (const HANDLE handle = m_pos_handle)
+			{
+				return handle;
+			}
+
+			const HANDLE handle = ReOpenFile(m_handle, m_access, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, 0);
+			verify("file::reopen" HERE), handle != INVALID_HANDLE_VALUE;
+
+			if (const HANDLE old = m_pos_handle.compare_and_swap(nullptr, handle))
+			{
+				CloseHandle(handle);
+				return old;
+			}
+
+			return handle;
+		}
 
 	public:
-		windows_file(HANDLE handle)
+		windows_file(HANDLE handle, DWORD access)
 			: m_handle(handle)
+			, m_access(access)
 		{
 		}
 
 		~windows_file() override
 		{
+			if (const HANDLE handle = m_pos_handle)
+			{
+				CloseHandle(handle);
+			}
+
 			CloseHandle(m_handle);
 		}
 
@@ -786,6 +836,44 @@ fs::file::file(const std::string& path, bs_t<open_mode> mode)
 			return nwritten;
 		}
 
+		u64 read_at(u64 offset, void* buffer, u64 count) override
+		{
+			const int size = narrow<int>(count, "file::read_at" HERE);
+
+			OVERLAPPED ovl{};
+			ovl.Offset = static_cast<DWORD>(offset);
+			ovl.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+			DWORD nread;
+			if (!ReadFile(get_pos_handle(), buffer, size, &nread, &ovl))
+			{
+				verify("file::read_at" HERE), GetLastError() == ERROR_HANDLE_EOF;
+				return 0;
+			}
+
+			return nread;
+		}
+
+		u64 write_at(u64 offset, const void* buffer, u64 count) override
+		{
+			if (m_access & FILE_APPEND_DATA)
+			{
+				// Appending handle can't write at the offset
+				return write(buffer, count);
+			}
+
+			const int size = narrow<int>(count, "file::write_at" HERE);
+
+			OVERLAPPED ovl{};
+			ovl.Offset = static_cast<DWORD>(offset);
+			ovl.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+			DWORD nwritten;
+			verify("file::write_at" HERE), WriteFile(get_pos_handle(), buffer, size, &nwritten, &ovl);
+
+			return nwritten;
+		}
+
 		u64 seek(s64 offset, seek_mode whence) override
 		{
 			LARGE_INTEGER pos;
@@ -811,7 +899,7 @@ fs::file::file(const std::string& path, bs_t<open_mode> mode)
 		}
 	};
 
-	m_file = std::make_unique<windows_file>(handle);
+	m_file = std::make_unique<windows_file>(handle, access);
 #else
 	int flags = 0;
 
@@ -835,10 +923,12 @@ fs::file::file(const std::string& path, bs_t<open_mode> mode)
 	class unix_file final : public file_base
 	{
 		const int m_fd;
+		const bool m_append;
 
 	public:
-		unix_file(int fd)
+		unix_file(int fd, bool append)
 			: m_fd(fd)
+			, m_append(append)
 		{
 		}
 
@@ -890,6 +980,28 @@ fs::file::file(const std::string& path, bs_t<open_mode> mode)
 			return result;
 		}
 
+		u64 read_at(u64 offset, void* buffer, u64 count) override
+		{
+			const auto result = ::pread(m_fd, buffer, count, offset);
+			verify("file::read_at" HERE), result != -1;
+
+			return result;
+		}
+
+		u64 write_at(u64 offset, const void* buffer, u64 count) override
+		{
+			if (m_append)
+			{
+				// pwrite() ignores the offset of O_APPEND file, do the same explicitly
+				return write(buffer, count);
+			}
+
+			const auto result = ::pwrite(m_fd, buffer, count, offset);
+			verify("file::write_at" HERE), result != -1;
+
+			return result;
+		}
+
 		u64 seek(s64 offset, seek_mode whence) override
 		{
 			const int mode =
@@ -913,7 +1025,7 @@ fs::file::file(const std::string& path, bs_t<open_mode> mode)
 		}
 	};
 
-	m_file = std::make_unique<unix_file>(fd);
+	m_file = std::make_unique<unix_file>(fd, test(mode & fs::append));
 #endif
 }
 
@@ -982,6 +1094,114 @@ fs::file::file(const void* ptr, std::size_t size)
 	m_file = std::make_unique<memory_stream>(ptr, size);
 }
 
+fs::file_view::file_view(const std::string& path)
+{
+	if (get_virtual_device(path))
+	{
+		g_tls_error = error::inval;
+		return;
+	}
+
+#ifdef _WIN32
+	const HANDLE handle = CreateFileW(to_wchar(path).get(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+	if (handle == INVALID_HANDLE_VALUE)
+	{
+		g_tls_error = to_error(GetLastError());
+		return;
+	}
+
+	LARGE_INTEGER size;
+	verify("file_view::size" HERE), GetFileSizeEx(handle, &size);
+
+	// Empty files can't be mapped
+	if (size.QuadPart == 0)
+	{
+		CloseHandle(handle);
+		g_tls_error = error::inval;
+		return;
+	}
+
+	const HANDLE mapping = CreateFileMappingW(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+
+	if (!mapping)
+	{
+		g_tls_error = to_error(GetLastError());
+		CloseHandle(handle);
+		return;
+	}
+
+	CloseHandle(handle);
+
+	const auto ptr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+	if (!ptr)
+	{
+		g_tls_error = to_error(GetLastError());
+		CloseHandle(mapping);
+		return;
+	}
+
+	CloseHandle(mapping);
+
+	m_ptr = static_cast<const u8*>(ptr);
+	m_size = size.QuadPart;
+#else
+	const int fd = ::open(path.c_str(), O_RDONLY);
+
+	if (fd == -1)
+	{
+		g_tls_error = to_error(errno);
+		return;
+	}
+
+	struct ::stat file_info;
+
+	if (::fstat(fd, &file_info) != 0)
+	{
+		g_tls_error = to_error(errno);
+		::close(fd);
+		return;
+	}
+
+	// Empty files can't be mapped
+	if (file_info.st_size == 0)
+	{
+		g_tls_error = error::inval;
+		::close(fd);
+		return;
+	}
+
+	const auto ptr = ::mmap(nullptr, file_info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+
+	if (ptr == MAP_FAILED)
+	{
+		g_tls_error = to_error(errno);
+		::close(fd);
+		return;
+	}
+
+	::close(fd);
+
+	::madvise(ptr, file_info.st_size, MADV_SEQUENTIAL);
+
+	m_ptr = static_cast<const u8*>(ptr);
+	m_size = file_info.st_size;
+#endif
+}
+
+fs::file_view::~file_view()
+{
+	if (m_ptr)
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(m_ptr);
+#else
+		::munmap(const_cast<u8*>(m_ptr), m_size);
+#endif
+	}
+}
+
 void fs::dir::xnull() const
 {
 	fmt::throw_exception<std::logic_error>("fs::dir is null");
@@ -1352,6 +1572,7 @@ void fmt_class_string<fs::error>::format(std::string& out, u64 arg)
 		case fs::error::inval: return "Invalid arguments";
 		case fs::error::noent: return "Not found";
 		case fs::error::exist: return "Already exists";
+		case fs::error::nomem: return "Not enough memory";
 		}
 
 		return unknown;
@@ -66,6 +66,10 @@ namespace fs
 		virtual u64 write(const void* buffer, u64 size) = 0;
 		virtual u64 seek(s64 offset, seek_mode whence) = 0;
 		virtual u64 size() = 0;
+
+		// Positional access (default implementation changes the file position temporarily)
+		virtual u64 read_at(u64 offset, void* buffer, u64 size);
+		virtual u64 write_at(u64 offset, const void* buffer, u64 size);
 	};
 
 	// Directory entry (TODO)
@@ -220,6 +224,20 @@ namespace fs
 			return m_file->write(buffer, count);
 		}
 
+		// Read the data at specified offset without changing the current position (if supported natively)
+		u64 read_at(u64 offset, void* buffer, u64 count) const
+		{
+			if (!m_file) xnull();
+			return m_file->read_at(offset, buffer, count);
+		}
+
+		// Write the data at specified offset without changing the current position (if supported natively), files opened with fs::append are written at the end
+		u64 write_at(u64 offset, const void* buffer, u64 count) const
+		{
+			if (!m_file) xnull();
+			return m_file->write_at(offset, buffer, count);
+		}
+
 		// Change current position, returns resulting position
 		u64 seek(s64 offset, seek_mode whence = seek_set) const
 		{
@@ -328,6 +346,53 @@ namespace fs
 		}
 	};
 
+	// Read-only memory mapping of the whole file (the file must not be truncated while mapped)
+	class file_view final
+	{
+		const u8* m_ptr = nullptr;
+		u64 m_size = 0;
+
+	public:
+		file_view() = default;
+
+		// Map existing file, check the result with operator bool()
+		explicit file_view(const std::string& path);
+
+		file_view(const file_view&) = delete;
+
+		file_view(file_view&& other)
+			: m_ptr(other.m_ptr)
+			, m_size(other.m_size)
+		{
+			other.m_ptr = nullptr;
+			other.m_size = 0;
+		}
+
+		file_view& operator=(file_view&& other)
+		{
+			std::swap(m_ptr, other.m_ptr);
+			std::swap(m_size, other.m_size);
+			return *this;
+		}
+
+		~file_view();
+
+		explicit operator bool() const
+		{
+			return m_ptr != nullptr;
+		}
+
+		const u8* data() const
+		{
+			return m_ptr;
+		}
+
+		u64 size() const
+		{
+			return m_size;
+		}
+	};
+
 	class dir final
 	{
 		std::unique_ptr<dir_base> m_dir;
@@ -467,6 +532,7 @@ namespace fs
 		noent,
 		exist,
 		acces,
+		nomem,
 	};
 
 	// Error code returned
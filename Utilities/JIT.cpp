@@ -16,9 +16,13 @@
 #endif
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/FormattedStream.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Host.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/Object/ObjectFile.h"
+#include "llvm/Target/TargetMachine.h"
 #include "llvm/ExecutionEngine/ExecutionEngine.h"
 #include "llvm/ExecutionEngine/RTDyldMemoryManager.h"
-#include "llvm/ExecutionEngine/JITEventListener.h"
 #ifdef _MSC_VER
 #pragma warning(pop)
 #endif
@@ -35,9 +39,6 @@
 
 #include "JIT.h"
 
-// Global LLVM context (thread-unsafe)
-llvm::LLVMContext g_llvm_ctx;
-
 // Size of virtual memory area reserved: 512 MB
 static const u64 s_memory_size = 0x20000000;
 
@@ -59,26 +60,59 @@ static void* const s_memory = []() -> void*
 #endif
 }();
 
-// Code section
-static u8* s_code_addr;
-static u64 s_code_size;
+// Next free address in the reserved area (shared by all jit_compiler instances)
+static u8* s_next = static_cast<u8*>(s_memory);
 
-// EH frames
-static u8* s_unwind_info;
-static u64 s_unwind_size;
+// Code model depends on the placement of the JIT memory (relative to the executable)
+static const llvm::CodeModel::Model s_code_model = (u64)s_memory <= 0x60000000 ? llvm::CodeModel::Small : llvm::CodeModel::Large; // TODO
 
-#ifdef _WIN32
-static std::vector<RUNTIME_FUNCTION> s_unwind; // Custom .pdata section replacement
-#endif
+// Number of existing memory managers, the reserved area is reset when it drops to zero
+static u32 s_count = 0;
+
+static std::mutex s_alloc_mutex;
+
+// Expand the range to page boundaries (protection is set per page)
+static std::pair<u8*, u64> page_range(u8* ptr, u64 size)
+{
+	const u64 start = (u64)ptr & ~0xfffull;
+	return {(u8*)start, ::align((u64)ptr + size, 4096) - start};
+}
 
 // Helper class
 struct MemoryManager final : llvm::RTDyldMemoryManager
 {
 	std::unordered_map<std::string, std::uintptr_t> table;
 
+	// Code sections (one per loaded object)
+	std::vector<std::pair<u8*, u64>> m_code;
+
+	// Data sections
+	std::vector<std::pair<u8*, u64>> m_data;
+
+	// EH frames (one per loaded object)
+	std::vector<std::pair<u8*, u64>> m_unwind_info;
+
+	// Pages reserved by this instance
+	std::vector<std::pair<u8*, u64>> m_pages;
+
+	// Free tails of the last code and data pages, small sections are packed there
+	std::pair<u8*, u8*> m_code_free{};
+	std::pair<u8*, u8*> m_data_free{};
+
+	// Number of sections already finalized
+	std::size_t m_code_done = 0;
+	std::size_t m_data_done = 0;
+
+#ifdef _WIN32
+	std::vector<std::vector<RUNTIME_FUNCTION>> m_unwind; // Custom .pdata section replacement (one table per fin() call)
+	std::size_t m_unwind_done = 0; // Number of code sections registered
+#endif
+
 	MemoryManager(std::unordered_map<std::string, std::uintptr_t>&& table)
 		: table(std::move(table))
 	{
+		std::lock_guard<std::mutex> lock(s_alloc_mutex);
+		s_count++;
 	}
 
 	[[noreturn]] static void null()
@@ -107,40 +141,66 @@ struct MemoryManager final : llvm::RTDyldMemoryManager
 		return (u64)null;
 	}
 
+	// Allocate a new section in the free tail of the last page, or reserve new pages
+	u8* allocate(std::pair<u8*, u8*>& free, std::uintptr_t size, uint align)
+	{
+		u8* ptr = (u8*)::align((u64)free.first, std::max<uint>(align, 16));
+
+		if (!free.first || ptr + size > free.second)
+		{
+			std::lock_guard<std::mutex> lock(s_alloc_mutex);
+
+			// Simple allocation
+			const u64 next = ::align((u64)s_next + size, 4096);
+
+			if (next > (u64)s_memory + s_memory_size)
+			{
+				return nullptr;
+			}
+
+			ptr = std::exchange(s_next, (u8*)next);
+			m_pages.emplace_back(ptr, next - (u64)ptr);
+			free.second = (u8*)next;
+		}
+
+		free.first = ptr + size;
+		return ptr;
+	}
+
 	virtual u8* allocateCodeSection(std::uintptr_t size, uint align, uint sec_id, llvm::StringRef sec_name) override
 	{
-		// Simple allocation
-		const u64 next = ::align((u64)m_next + size, 4096);
+		const auto ptr = allocate(m_code_free, size, align);
 
-		if (next > (u64)s_memory + s_memory_size)
+		if (!ptr)
 		{
 			LOG_FATAL(GENERAL, "LLVM: Out of memory (size=0x%llx, aligned 0x%x)", size, align);
 			return nullptr;
 		}
 
+		// The page may be shared with a finalized section, make it writable again
+		const auto range = page_range(ptr, size);
+
 #ifdef _WIN32
-		if (!VirtualAlloc(m_next, size, MEM_COMMIT, PAGE_EXECUTE_READWRITE))
+		if (!VirtualAlloc(range.first, range.second, MEM_COMMIT, PAGE_EXECUTE_READWRITE))
 #else
-		if (::mprotect(m_next, size, PROT_READ | PROT_WRITE | PROT_EXEC))
+		if (::mprotect(range.first, range.second, PROT_READ | PROT_WRITE | PROT_EXEC))
 #endif
 		{
-			LOG_FATAL(GENERAL, "LLVM: Failed to allocate memory at %p", m_next);
+			LOG_FATAL(GENERAL, "LLVM: Failed to allocate memory at %p", ptr);
 			return nullptr;
 		}
 
-		s_code_addr = (u8*)m_next;
-		s_code_size = size;
+		m_code.emplace_back(ptr, size);
 
-		LOG_SUCCESS(GENERAL, "LLVM: Code section %u '%s' allocated -> %p (size=0x%llx, aligned 0x%x)", sec_id, sec_name.data(), m_next, size, align);
-		return (u8*)std::exchange(m_next, (void*)next);
+		LOG_SUCCESS(GENERAL, "LLVM: Code section %u '%s' allocated -> %p (size=0x%llx, aligned 0x%x)", sec_id, sec_name.data(), ptr, size, align);
+		return ptr;
 	}
 
 	virtual u8* allocateDataSection(std::uintptr_t size, uint align, uint sec_id, llvm::StringRef sec_name, bool is_ro) override
 	{
-		// Simple allocation
-		const u64 next = ::align((u64)m_next + size, 4096);
+		const auto ptr = allocate(m_data_free, size, align);
 
-		if (next > (u64)s_memory + s_memory_size)
+		if (!ptr)
 		{
 			LOG_FATAL(GENERAL, "LLVM: Out of memory (size=0x%llx, aligned 0x%x)", size, align);
 			return nullptr;
@@ -151,38 +211,56 @@ struct MemoryManager final : llvm::RTDyldMemoryManager
 			LOG_ERROR(GENERAL, "LLVM: Writeable data section not supported!");
 		}
 
+		const auto range = page_range(ptr, size);
+
 #ifdef _WIN32
-		if (!VirtualAlloc(m_next, size, MEM_COMMIT, PAGE_READWRITE))
+		if (!VirtualAlloc(range.first, range.second, MEM_COMMIT, PAGE_READWRITE))
 #else
-		if (::mprotect(m_next, size, PROT_READ | PROT_WRITE))
+		if (::mprotect(range.first, range.second, PROT_READ | PROT_WRITE))
 #endif
 		{
-			LOG_FATAL(GENERAL, "LLVM: Failed to allocate memory at %p", m_next);
+			LOG_FATAL(GENERAL, "LLVM: Failed to allocate memory at %p", ptr);
 			return nullptr;
 		}
 
-		LOG_SUCCESS(GENERAL, "LLVM: Data section %u '%s' allocated -> %p (size=0x%llx, aligned 0x%x, %s)", sec_id, sec_name.data(), m_next, size, align, is_ro ? "ro" : "rw");
-		return (u8*)std::exchange(m_next, (void*)next);
+		m_data.emplace_back(ptr, size);
+
+		LOG_SUCCESS(GENERAL, "LLVM: Data section %u '%s' allocated -> %p (size=0x%llx, aligned 0x%x, %s)", sec_id, sec_name.data(), ptr, size, align, is_ro ? "ro" : "rw");
+		return ptr;
 	}
 
 	virtual bool finalizeMemory(std::string* = nullptr) override
 	{
+		// Only protect own sections loaded since the last call: other instances may be loading objects concurrently
 		// TODO: make only read-only sections read-only
+		for (; m_data_done < m_data.size(); m_data_done++)
+		{
+			const auto range = page_range(m_data[m_data_done].first, m_data[m_data_done].second);
 #ifdef _WIN32
-		DWORD op;
-		VirtualProtect(s_memory, (u64)m_next - (u64)s_memory, PAGE_READONLY, &op);
-		VirtualProtect(s_code_addr, s_code_size, PAGE_EXECUTE_READ, &op);
+			DWORD op;
+			VirtualProtect(range.first, range.second, PAGE_READONLY, &op);
 #else
-		::mprotect(s_memory, (u64)m_next - (u64)s_memory, PROT_READ);
-		::mprotect(s_code_addr, s_code_size, PROT_READ | PROT_EXEC);
+			::mprotect(range.first, range.second, PROT_READ);
 #endif
+		}
+
+		for (; m_code_done < m_code.size(); m_code_done++)
+		{
+			const auto range = page_range(m_code[m_code_done].first, m_code[m_code_done].second);
+#ifdef _WIN32
+			DWORD op;
+			VirtualProtect(range.first, range.second, PAGE_EXECUTE_READ, &op);
+#else
+			::mprotect(range.first, range.second, PROT_READ | PROT_EXEC);
+#endif
+		}
+
 		return false;
 	}
 
 	virtual void registerEHFrames(u8* addr, u64 load_addr, std::size_t size) override
 	{
-		s_unwind_info = addr;
-		s_unwind_size = size;
+		m_unwind_info.emplace_back(addr, size);
 
 		return RTDyldMemoryManager::registerEHFrames(addr, load_addr, size);
 	}
@@ -197,62 +275,67 @@ struct MemoryManager final : llvm::RTDyldMemoryManager
 	~MemoryManager()
 	{
 #ifdef _WIN32
-		if (!RtlDeleteFunctionTable(s_unwind.data()))
+		for (auto& table : m_unwind)
 		{
-			LOG_FATAL(GENERAL, "RtlDeleteFunctionTable(%p) failed! Error %u", s_unwind_info, GetLastError());
+			if (!RtlDeleteFunctionTable(table.data()))
+			{
+				LOG_FATAL(GENERAL, "RtlDeleteFunctionTable(%p) failed! Error %u", table.data(), GetLastError());
+			}
 		}
+#endif
+
+		std::lock_guard<std::mutex> lock(s_alloc_mutex);
 
-		if (!VirtualFree(s_memory, 0, MEM_DECOMMIT))
+		for (const auto& sec : m_pages)
 		{
-			LOG_FATAL(GENERAL, "VirtualFree(%p) failed! Error %u", s_memory, GetLastError());
-		}
+#ifdef _WIN32
+			if (!VirtualFree(sec.first, sec.second, MEM_DECOMMIT))
+			{
+				LOG_FATAL(GENERAL, "VirtualFree(%p) failed! Error %u", sec.first, GetLastError());
+			}
 #else
-		if (!::mmap(s_memory, s_memory_size, PROT_NONE, MAP_FIXED | MAP_ANON | MAP_PRIVATE, -1, 0))
-		{
-			LOG_FATAL(GENERAL, "mmap(%p) failed! Error %d", s_memory, errno);
-		}
+			if (::mmap(sec.first, sec.second, PROT_NONE, MAP_FIXED | MAP_ANON | MAP_PRIVATE, -1, 0) == MAP_FAILED)
+			{
+				LOG_FATAL(GENERAL, "mmap(%p) failed! Error %d", sec.first, errno);
+			}
 
-		// TODO: unregister EH frames if necessary
+			// TODO: unregister EH frames if necessary
 #endif
-	}
-
-private:
-	void* m_next = s_memory;
-};
+		}
 
-// Helper class
-struct EventListener final : llvm::JITEventListener
-{
-	virtual void NotifyObjectEmitted(const llvm::object::ObjectFile& obj, const llvm::RuntimeDyld::LoadedObjectInfo& inf) override
-	{
-		const llvm::StringRef elf = obj.getData();
-		fs::file(fs::get_config_dir() + "LLVM.obj", fs::rewrite)
-			.write(elf.data(), elf.size());
+		if (--s_count == 0)
+		{
+			// Reuse the whole area
+			s_next = static_cast<u8*>(s_memory);
+		}
 	}
 };
 
-static EventListener s_listener;
 
-jit_compiler::jit_compiler(std::unique_ptr<llvm::Module>&& _module, std::unordered_map<std::string, std::uintptr_t>&& table)
+jit_compiler::jit_compiler(std::unordered_map<std::string, std::uintptr_t>&& table)
 {
 	verify(HERE), s_memory;
 
 	std::string result;
 
-	const auto module_ptr = _module.get();
-
 	// Initialization
 	llvm::InitializeNativeTarget();
 	llvm::InitializeNativeTargetAsmPrinter();
 	LLVMLinkInMCJIT();
 	const auto _cpu = llvm::sys::getHostCPUName();
 
-	m_engine.reset(llvm::EngineBuilder(std::move(_module))
+	m_cpu = _cpu == "skylake" ? "haswell" : _cpu.str();
+
+	auto mem = std::make_unique<MemoryManager>(std::move(table));
+	m_memory = mem.get();
+
+	// Objects are added later, the initial module is empty
+	m_engine.reset(llvm::EngineBuilder(std::make_unique<llvm::Module>("null", m_context))
 		.setErrorStr(&result)
-		.setMCJITMemoryManager(std::make_unique<MemoryManager>(std::move(table)))
+		.setMCJITMemoryManager(std::move(mem))
 		.setOptLevel(llvm::CodeGenOpt::Aggressive)
-		.setCodeModel((u64)s_memory <= 0x60000000 ? llvm::CodeModel::Small : llvm::CodeModel::Large) // TODO
-		.setMCPU(_cpu == "skylake" ? "haswell" : _cpu)
+		.setCodeModel(s_code_model)
+		.setMCPU(m_cpu)
 		.create());
 
 	if (!m_engine)
@@ -261,81 +344,230 @@ jit_compiler::jit_compiler(std::unique_ptr<llvm::Module>&& _module, std::unorder
 	}
 
 	m_engine->setProcessAllSections(true); // ???
-	m_engine->RegisterJITEventListener(&s_listener);
-	m_engine->finalizeObject();
+}
+
+llvm::CodeModel::Model jit_compiler::code_model() const
+{
+	return s_code_model;
+}
 
-	for (auto& func : module_ptr->functions())
+void jit_compiler::add(std::unique_ptr<llvm::Module> module, const std::string& path)
+{
+	std::string result;
+
+	// Create separate TargetMachine (not thread-safe)
+	std::unique_ptr<llvm::TargetMachine> target(llvm::EngineBuilder()
+		.setErrorStr(&result)
+		.setOptLevel(llvm::CodeGenOpt::Aggressive)
+		.setCodeModel(s_code_model)
+		.setMCPU(m_cpu)
+		.selectTarget());
+
+	if (!target)
 	{
-		if (!func.empty())
+		fmt::throw_exception("LLVM: Failed to select target: %s", result);
+	}
+
+	module->setDataLayout(target->createDataLayout());
+
+	// Emit object file
+	llvm::SmallVector<char, 0> obj;
+	llvm::raw_svector_ostream stream(obj);
+	llvm::legacy::PassManager pm;
+	llvm::MCContext* ctx;
+
+	if (target->addPassesToEmitMC(pm, ctx, stream))
+	{
+		fmt::throw_exception("LLVM: Failed to emit object file" HERE);
+	}
+
+	pm.run(*module);
+
+	// Delete IR to lower memory consumption
+	module.reset();
+
+	if (!path.empty())
+	{
+		// Write to temporary file first to avoid loading incomplete files
+		if (!fs::file(path + ".tmp", fs::rewrite).write(obj.data(), obj.size()) || !fs::rename(path + ".tmp", path))
+		{
+			LOG_ERROR(GENERAL, "LLVM: Failed to save object file %s (%s)", path, fs::g_tls_error);
+		}
+	}
+
+	if (!add_object(llvm::MemoryBuffer::getMemBufferCopy(llvm::StringRef(obj.data(), obj.size()), path)))
+	{
+		fmt::throw_exception("LLVM: Failed to load generated object file" HERE);
+	}
+}
+
+bool jit_compiler::add(const std::string& path)
+{
+	const fs::file cached(path);
+
+	if (!cached)
+	{
+		return false;
+	}
+
+	const std::string data = cached.to_string();
+
+	if (!add_object(llvm::MemoryBuffer::getMemBufferCopy(data, path)))
+	{
+		LOG_ERROR(GENERAL, "LLVM: Failed to load object file %s", path);
+		return false;
+	}
+
+	return true;
+}
+
+bool jit_compiler::add_object(std::unique_ptr<llvm::MemoryBuffer> buffer)
+{
+	auto obj = llvm::object::ObjectFile::createObjectFile(buffer->getMemBufferRef());
+
+	if (!obj)
+	{
+		llvm::consumeError(obj.takeError());
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	const char prefix = m_engine->getDataLayout().getGlobalPrefix();
+
+	// Collect defined functions
+	for (const auto& sym : obj.get()->symbols())
+	{
+		auto type = sym.getType();
+		auto name = sym.getName();
+
+		if (!type || !name)
 		{
-			const std::string& name = func.getName();
+			if (!type) llvm::consumeError(type.takeError());
+			if (!name) llvm::consumeError(name.takeError());
+			continue;
+		}
 
-			// Register compiled function
-			m_map[name] = m_engine->getFunctionAddress(name);
+		if (type.get() != llvm::object::SymbolRef::ST_Function || sym.getFlags() & llvm::object::SymbolRef::SF_Undefined)
+		{
+			continue;
 		}
 
-		// Delete IR to lower memory consumption
-		func.deleteBody();
+		std::string _name = name.get().str();
+
+		if (prefix && !_name.empty() && _name[0] == prefix)
+		{
+			_name.erase(0, 1);
+		}
+
+		if (m_map.emplace(_name, 0).second)
+		{
+			m_new.emplace_back(std::move(_name));
+		}
+	}
+
+	m_engine->addObjectFile(llvm::object::OwningBinary<llvm::object::ObjectFile>(std::move(obj.get()), std::move(buffer)));
+	return true;
+}
+
+void jit_compiler::fin()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	// Only objects loaded since the last call are relocated and protected
+	m_engine->finalizeObject();
+
+	if (m_new.empty())
+	{
+		return;
+	}
+
+	for (const auto& name : m_new)
+	{
+		// Register compiled function
+		m_map[name] = m_engine->getFunctionAddress(name);
 	}
 
 #ifdef _WIN32
 	// Register .xdata UNWIND_INFO (.pdata section is empty for some reason)
 	std::set<u64> func_set;
 
-	for (const auto& pair : m_map)
+	for (const auto& name : m_new)
 	{
-		func_set.emplace(pair.second);
+		func_set.emplace(m_map[name]);
 	}
 
 	const u64 base = (u64)s_memory;
-	const u8* bits = s_unwind_info;
 
-	s_unwind.clear();
-	s_unwind.reserve(m_map.size());
+	auto& s_code = m_memory->m_code;
+	auto& s_unwind_info = m_memory->m_unwind_info;
+
+	// New objects get their own table, registered tables are left untouched
+	m_memory->m_unwind.emplace_back();
+	auto& s_unwind = m_memory->m_unwind.back();
+	s_unwind.reserve(m_new.size());
 
-	for (const u64 addr : func_set)
+	// Every object has one code section and one .xdata section
+	std::size_t i = m_memory->m_unwind_done;
+
+	for (; i < s_code.size() && i < s_unwind_info.size(); i++)
 	{
-		// Find next function address
-		const auto _next = func_set.upper_bound(addr);
-		const u64 next = _next != func_set.end() ? *_next : (u64)s_code_addr + s_code_size;
-
-		// Generate RUNTIME_FUNCTION record
-		RUNTIME_FUNCTION uw;
-		uw.BeginAddress = static_cast<u32>(addr - base);
-		uw.EndAddress   = static_cast<u32>(next - base);
-		uw.UnwindData   = static_cast<u32>((u64)bits - base);
-		s_unwind.emplace_back(uw);
-
-		// Parse .xdata UNWIND_INFO record
-		const u8 flags = *bits++; // Version and flags
-		const u8 prolog = *bits++; // Size of prolog
-		const u8 count = *bits++; // Count of unwind codes
-		const u8 frame = *bits++; // Frame Reg + Off
-		bits += ::align(std::max<u8>(1, count), 2) * sizeof(u16); // UNWIND_CODE array
-
-		if (flags != 1) 
+		const u64 code_addr = (u64)s_code[i].first;
+		const u64 code_end = code_addr + s_code[i].second;
+		const u8* bits = s_unwind_info[i].first;
+
+		for (auto it = func_set.lower_bound(code_addr); it != func_set.end() && *it < code_end; it++)
 		{
-			// Can't happen for trivial code
-			LOG_ERROR(GENERAL, "LLVM: unsupported UNWIND_INFO version/flags (0x%02x)", flags);
-			break;
+			const u64 addr = *it;
+
+			// Find next function address
+			const auto _next = std::next(it);
+			const u64 next = _next != func_set.end() && *_next < code_end ? *_next : code_end;
+
+			// Generate RUNTIME_FUNCTION record
+			RUNTIME_FUNCTION uw;
+			uw.BeginAddress = static_cast<u32>(addr - base);
+			uw.EndAddress   = static_cast<u32>(next - base);
+			uw.UnwindData   = static_cast<u32>((u64)bits - base);
+			s_unwind.emplace_back(uw);
+
+			// Parse .xdata UNWIND_INFO record
+			const u8 flags = *bits++; // Version and flags
+			const u8 prolog = *bits++; // Size of prolog
+			const u8 count = *bits++; // Count of unwind codes
+			const u8 frame = *bits++; // Frame Reg + Off
+			bits += ::align(std::max<u8>(1, count), 2) * sizeof(u16); // UNWIND_CODE array
+
+			if (flags != 1) 
+			{
+				// Can't happen for trivial code
+				LOG_ERROR(GENERAL, "LLVM: unsupported UNWIND_INFO version/flags (0x%02x)", flags);
+				break;
+			}
+
+			LOG_TRACE(GENERAL, "LLVM: .xdata at 0x%llx: function 0x%x..0x%x: p0x%02x, c0x%02x, f0x%02x", uw.UnwindData + base, uw.BeginAddress + base, uw.EndAddress + base, prolog, count, frame);
 		}
 
-		LOG_TRACE(GENERAL, "LLVM: .xdata at 0x%llx: function 0x%x..0x%x: p0x%02x, c0x%02x, f0x%02x", uw.UnwindData + base, uw.BeginAddress + base, uw.EndAddress + base, prolog, count, frame);
+		if (s_unwind_info[i].first + s_unwind_info[i].second != bits)
+		{
+			LOG_ERROR(GENERAL, "LLVM: .xdata analysis failed! (%p != %p)", s_unwind_info[i].first + s_unwind_info[i].second, bits);
+		}
 	}
 
-	if (s_unwind_info + s_unwind_size != bits)
-	{
-		LOG_ERROR(GENERAL, "LLVM: .xdata analysis failed! (%p != %p)", s_unwind_info + s_unwind_size, bits);
-	}
-	else if (!RtlAddFunctionTable(s_unwind.data(), (DWORD)s_unwind.size(), base))
+	m_memory->m_unwind_done = i;
+
+	if (!RtlAddFunctionTable(s_unwind.data(), (DWORD)s_unwind.size(), base))
 	{
-		LOG_ERROR(GENERAL, "RtlAddFunctionTable(%p) failed! Error %u", s_unwind_info, GetLastError());
+		LOG_ERROR(GENERAL, "RtlAddFunctionTable(%p) failed! Error %u", s_unwind.data(), GetLastError());
+		m_memory->m_unwind.pop_back();
 	}
 	else
 	{
-		LOG_SUCCESS(GENERAL, "LLVM: UNWIND_INFO registered (%p, size=0x%llx)", s_unwind_info, s_unwind_size);
+		LOG_SUCCESS(GENERAL, "LLVM: UNWIND_INFO registered (%zu functions)", s_unwind.size());
 	}
 #endif
+
+	m_new.clear();
 }
 
 jit_compiler::~jit_compiler()
@@ -5,6 +5,8 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
+#include <mutex>
 
 #include "types.h"
 
@@ -20,21 +22,56 @@
 #endif
 #include "define_new_memleakdetect.h"
 
-extern llvm::LLVMContext g_llvm_ctx;
-
 // Temporary compiler interface
 class jit_compiler final
 {
+	// Context of the (empty) module owned by the execution engine
+	llvm::LLVMContext m_context;
+
 	// Execution instance
 	std::unique_ptr<llvm::ExecutionEngine> m_engine;
 
-	// Compiled functions
+	// Memory manager owned by the execution engine
+	struct MemoryManager* m_memory;
+
+	// Compiled functions (filled by fin())
 	std::unordered_map<std::string, std::uintptr_t> m_map;
 
+	// Functions loaded since the last fin()
+	std::vector<std::string> m_new;
+
+	// Target CPU name
+	std::string m_cpu;
+
+	// Protects m_engine and m_map while objects are added
+	std::mutex m_mutex;
+
+	// Load object file into the execution engine
+	bool add_object(std::unique_ptr<llvm::MemoryBuffer>);
+
 public:
-	jit_compiler(std::unique_ptr<llvm::Module>&&, std::unordered_map<std::string, std::uintptr_t>&&);
+	jit_compiler(std::unordered_map<std::string, std::uintptr_t>&&);
 	~jit_compiler();
 
+	// Compile module to an object file and load it, save the object file if path is not empty.
+	// Can be called concurrently, if every module has its own LLVMContext.
+	void add(std::unique_ptr<llvm::Module>, const std::string& path);
+
+	// Load previously saved object file, return false if it's not available
+	bool add(const std::string& path);
+
+	// Finalize objects loaded since the last call and resolve their function addresses
+	void fin();
+
+	// Get CPU name used for code generation
+	const std::string& cpu() const
+	{
+		return m_cpu;
+	}
+
+	// Get code model used for code generation
+	llvm::CodeModel::Model code_model() const;
+
 	// Get compiled function address
 	std::uintptr_t get(const std::string& name) const
 	{
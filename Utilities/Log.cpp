@@ -4,6 +4,11 @@
 
 #include "rpcs3_version.h"
 #include <string>
+#include <cstring>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 // Thread-specific log prefix provider
 thread_local std::string(*g_tls_log_prefix)() = nullptr;
@@ -31,18 +36,85 @@ void fmt_class_string<logs::level>::format(std::string& out, u64 arg)
 
 namespace logs
 {
+	// Single-producer single-consumer ring buffer owned by one thread
+	struct log_ring
+	{
+		static const u32 size = 0x40000;
+
+		// Record header (followed by the data, padded to 8 bytes)
+		struct header
+		{
+			u64 seq;
+			u64 size;
+		};
+
+		// Total amount of bytes written by the producer
+		alignas(64) atomic_t<u64> head{0};
+
+		// Total amount of bytes consumed by the drain thread
+		alignas(64) atomic_t<u64> tail{0};
+
+		// Set when the owner thread exits (the ring is released after it's drained)
+		atomic_t<bool> closed{false};
+
+		std::unique_ptr<char[]> data{new char[size]};
+
+		void put(u64 pos, const void* src, u64 count)
+		{
+			const u64 off = pos % size;
+			const u64 first = std::min<u64>(count, size - off);
+			std::memcpy(data.get() + off, src, first);
+			std::memcpy(data.get(), static_cast<const char*>(src) + first, count - first);
+		}
+
+		void get(u64 pos, void* dst, u64 count) const
+		{
+			const u64 off = pos % size;
+			const u64 first = std::min<u64>(count, size - off);
+			std::memcpy(dst, data.get() + off, first);
+			std::memcpy(static_cast<char*>(dst) + first, data.get(), count - first);
+		}
+	};
+
 	class file_writer
 	{
 		// Could be memory-mapped file
 		fs::file m_file;
 
+		// Global message order (used to merge thread-local rings)
+		atomic_t<u64> m_seq{0};
+
+		// Registered rings
+		std::vector<std::shared_ptr<log_ring>> m_rings;
+
+		// Protects m_rings
+		std::mutex m_rings_mutex;
+
+		// Serializes draining and writing to the file
+		std::mutex m_drain_mutex;
+
+		// Drain thread control
+		std::mutex m_wait_mutex;
+		std::condition_variable m_wait_cv;
+		bool m_exit = false;
+		std::thread m_thread;
+
+		// Get ring of the current thread
+		log_ring& get_ring();
+
+		// Write all buffered messages to the file (m_drain_mutex must be locked)
+		void drain();
+
 	public:
 		file_writer(const std::string& name);
 
-		virtual ~file_writer() = default;
+		virtual ~file_writer();
 
-		// Append raw data
+		// Append raw data (asynchronously)
 		void log(const char* text, std::size_t size);
+
+		// Write all buffered data immediately
+		void flush();
 	};
 
 	struct file_listener : public file_writer, public listener
@@ -94,8 +166,21 @@ void logs::listener::add(logs::listener* _new)
 
 void logs::message::broadcast(const char* fmt, const fmt_type_info* sup, const u64* args)
 {
-	std::string text; fmt::raw_append(text, fmt, sup, args);
-	std::string prefix(g_tls_log_prefix ? g_tls_log_prefix() : "");
+	// Reuse thread-local buffers (arguments may refer to temporary data, so formatting can't be deferred)
+	thread_local std::string s_text, s_prefix;
+	thread_local bool s_busy = false;
+
+	// Use new strings in (unlikely) recursive calls
+	std::string text, prefix;
+	std::string& _text = s_busy ? text : s_text;
+	std::string& _prefix = s_busy ? prefix : s_prefix;
+	const bool busy = std::exchange(s_busy, true);
+
+	_text.clear();
+	fmt::raw_append(_text, fmt, sup, args);
+
+	_prefix.clear();
+	if (g_tls_log_prefix) _prefix = g_tls_log_prefix();
 
 	// Get first (main) listener
 	listener* lis = get_logger();
@@ -103,9 +188,11 @@ void logs::message::broadcast(const char* fmt, const fmt_type_info* sup, const u
 	// Send message to all listeners
 	while (lis)
 	{
-		lis->log(*this, prefix, text);
+		lis->log(*this, _prefix, _text);
 		lis = lis->m_next;
 	}
+
+	s_busy = busy;
 }
 
 [[noreturn]] extern void catch_all_exceptions();
@@ -123,16 +210,205 @@ logs::file_writer::file_writer(const std::string& name)
 	{
 		catch_all_exceptions();
 	}
+
+	m_thread = std::thread([this]()
+	{
+		std::unique_lock<std::mutex> lock(m_wait_mutex);
+
+		while (!m_exit)
+		{
+			lock.unlock();
+			flush();
+			lock.lock();
+
+			if (!m_exit)
+			{
+				m_wait_cv.wait_for(lock, std::chrono::milliseconds(20));
+			}
+		}
+	});
+}
+
+logs::file_writer::~file_writer()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_wait_mutex);
+		m_exit = true;
+	}
+
+	m_wait_cv.notify_one();
+	m_thread.join();
+
+	flush();
+}
+
+logs::log_ring& logs::file_writer::get_ring()
+{
+	struct ring_holder
+	{
+		file_writer* owner = nullptr;
+		std::shared_ptr<log_ring> ring;
+
+		~ring_holder()
+		{
+			if (ring)
+			{
+				ring->closed = true;
+			}
+		}
+	};
+
+	thread_local ring_holder s_ring;
+
+	if (UNLIKELY(s_ring.owner != this))
+	{
+		if (s_ring.ring)
+		{
+			s_ring.ring->closed = true;
+		}
+
+		s_ring.owner = this;
+		s_ring.ring = std::make_shared<log_ring>();
+
+		std::lock_guard<std::mutex> lock(m_rings_mutex);
+		m_rings.emplace_back(s_ring.ring);
+	}
+
+	return *s_ring.ring;
+}
+
+void logs::file_writer::drain()
+{
+	struct cursor
+	{
+		log_ring* ring;
+		u64 pos;
+		u64 end;
+		log_ring::header next;
+	};
+
+	std::vector<cursor> cursors;
+	std::vector<std::shared_ptr<log_ring>> rings;
+
+	{
+		std::lock_guard<std::mutex> lock(m_rings_mutex);
+
+		// Release rings of finished threads
+		for (auto it = m_rings.begin(); it != m_rings.end();)
+		{
+			if ((*it)->closed && (*it)->tail == (*it)->head)
+			{
+				it = m_rings.erase(it);
+				continue;
+			}
+
+			it++;
+		}
+
+		rings = m_rings;
+	}
+
+	for (const auto& ring : rings)
+	{
+		const u64 pos = ring->tail;
+		const u64 end = ring->head;
+
+		if (pos != end)
+		{
+			cursors.push_back({ring.get(), pos, end});
+			ring->get(pos, &cursors.back().next, sizeof(log_ring::header));
+		}
+	}
+
+	if (cursors.empty())
+	{
+		return;
+	}
+
+	thread_local std::vector<char> s_batch;
+	s_batch.clear();
+
+	// Merge records from all rings in the original order
+	while (!cursors.empty())
+	{
+		auto min = cursors.begin();
+
+		for (auto it = cursors.begin(); it != cursors.end(); it++)
+		{
+			if (it->next.seq < min->next.seq)
+			{
+				min = it;
+			}
+		}
+
+		const u64 size = min->next.size;
+		const std::size_t old = s_batch.size();
+		s_batch.resize(old + size);
+		min->ring->get(min->pos + sizeof(log_ring::header), s_batch.data() + old, size);
+
+		min->pos += sizeof(log_ring::header) + ::align(size, 8);
+
+		if (min->pos == min->end)
+		{
+			min->ring->tail = min->pos;
+			cursors.erase(min);
+		}
+		else
+		{
+			min->ring->get(min->pos, &min->next, sizeof(log_ring::header));
+		}
+	}
+
+	m_file.write(s_batch.data(), s_batch.size());
+}
+
+void logs::file_writer::flush()
+{
+	std::lock_guard<std::mutex> lock(m_drain_mutex);
+	drain();
 }
 
 void logs::file_writer::log(const char* text, std::size_t size)
 {
-	m_file.write(text, size);
+	const u64 total = sizeof(log_ring::header) + ::align(size, 8);
+
+	if (UNLIKELY(total > log_ring::size / 2))
+	{
+		// Write huge messages directly after all buffered messages
+		std::lock_guard<std::mutex> lock(m_drain_mutex);
+		drain();
+		m_file.write(text, size);
+		return;
+	}
+
+	auto& ring = get_ring();
+
+	const u64 head = ring.head;
+
+	while (UNLIKELY(head + total - ring.tail > log_ring::size))
+	{
+		// Ring is full: drain synchronously
+		flush();
+	}
+
+	// Sequence number is taken right before publishing to keep the order of messages
+	const log_ring::header hdr{m_seq++, size};
+	ring.put(head, &hdr, sizeof(hdr));
+	ring.put(head + sizeof(hdr), text, size);
+	ring.head = head + total;
+
+	if (UNLIKELY(head + total - ring.tail > log_ring::size / 2))
+	{
+		// Wake up the drain thread early
+		m_wait_cv.notify_one();
+	}
 }
 
 void logs::file_listener::log(const logs::message& msg, const std::string& prefix, const std::string& _text)
 {
-	std::string text; text.reserve(prefix.size() + _text.size() + 200);
+	// Reuse thread-local buffer
+	thread_local std::string text;
+	text.reserve(prefix.size() + _text.size() + 200);
 
 	// Used character: U+00B7 (Middle Dot)
 	switch (msg.sev)
@@ -170,4 +446,10 @@ void logs::file_listener::log(const logs::message& msg, const std::string& prefi
 	text += '\n';
 
 	file_writer::log(text.data(), text.size());
+
+	if (msg.sev == level::fatal)
+	{
+		// Fatal errors are usually followed by the termination
+		file_writer::flush();
+	}
 }
@@ -26,6 +26,7 @@
 
 thread_local u64 g_tls_fault_rsx = 0;
 thread_local u64 g_tls_fault_spu = 0;
+thread_local u64 g_tls_fault_watch = 0;
 
 static void report_fatal_error(const std::string& msg)
 {
@@ -1016,6 +1017,12 @@ namespace rsx
 
 bool handle_access_violation(u32 addr, bool is_writing, x64_context* context)
 {
+	if (is_writing && vm::page_watch_fault(addr))
+	{
+		g_tls_fault_watch++;
+		return true;
+	}
+
 	if (rsx::g_access_violation_handler && rsx::g_access_violation_handler(addr, is_writing))
 	{
 		g_tls_fault_rsx++;
@@ -1153,450 +1160,8 @@ bool handle_access_violation(u32 addr, bool is_writing, x64_context* context)
 		return true;
 	}
 
-	// check if fault is caused by the reservation
-	return vm::reservation_query(addr, (u32)a_size, is_writing, [&]() -> bool
-	{
-		// write memory using "privileged" access to avoid breaking reservation
-		if (!d_size || !i_size)
-		{
-			LOG_ERROR(MEMORY, "Invalid or unsupported instruction (op=%d, reg=%d, d_size=%lld, a_size=0x%llx, i_size=%lld)", (u32)op, (u32)reg, d_size, a_size, i_size);
-			report_opcode();
-			return false;
-		}
-
-		switch (op)
-		{
-		case X64OP_STORE:
-		case X64OP_STORE_BE:
-		{
-			if (d_size == 16 && op == X64OP_STORE)
-			{
-				if (reg - X64R_XMM0 >= 16)
-				{
-					LOG_ERROR(MEMORY, "X64OP_STORE: d_size=16, reg=%d", (u32)reg);
-					return false;
-				}
-
-				std::memcpy(vm::base_priv(addr), XMMREG(context, reg - X64R_XMM0), 16);
-				break;
-			}
-
-			u64 reg_value;
-			if (!get_x64_reg_value(context, reg, d_size, i_size, reg_value))
-			{
-				return false;
-			}
-
-			if (op == X64OP_STORE_BE && d_size == 2)
-			{
-				reg_value = se_storage<u16>::swap((u16)reg_value);
-			}
-			else if (op == X64OP_STORE_BE && d_size == 4)
-			{
-				reg_value = se_storage<u32>::swap((u32)reg_value);
-			}
-			else if (op == X64OP_STORE_BE && d_size == 8)
-			{
-				reg_value = se_storage<u64>::swap(reg_value);
-			}
-			else if (op == X64OP_STORE_BE)
-			{
-				return false;	
-			}
-
-			if (d_size == 1)
-			{
-				*(volatile u8*)vm::base_priv(addr) = (u8)reg_value;
-			}
-			else if (d_size == 2 && addr % 2 == 0)
-			{
-				*(volatile u16*)vm::base_priv(addr) = (u16)reg_value; 
-			}
-			else if (d_size == 4 && addr % 4 == 0)
-			{
-				*(volatile u32*)vm::base_priv(addr) = (u32)reg_value;
-			}
-			else if (d_size == 8 && addr % 8 == 0)
-			{
-				*(volatile u64*)vm::base_priv(addr) = (u64)reg_value;
-			}
-			else
-			{
-				std::memcpy(vm::base_priv(addr), &reg_value, d_size);
-			}
-			
-			break;
-		}
-		case X64OP_MOVS:
-		{
-			if (d_size > 8)
-			{
-				LOG_ERROR(MEMORY, "X64OP_MOVS: d_size=%lld", d_size);
-				return false;
-			}
-
-			if (vm::base(addr) != (void*)RDI(context))
-			{
-				LOG_ERROR(MEMORY, "X64OP_MOVS: rdi=0x%llx, rsi=0x%llx, addr=0x%x", (u64)RDI(context), (u64)RSI(context), addr);
-				return false;
-			}
-
-			u32 a_addr = addr;
-
-			while (a_addr >> 12 == addr >> 12)
-			{
-				u64 value;
-
-				// copy data
-				std::memcpy(&value, (void*)RSI(context), d_size);
-				std::memcpy(vm::base_priv(a_addr), &value, d_size);
-
-				// shift pointers
-				if (EFLAGS(context) & 0x400 /* direction flag */)
-				{
-					LOG_ERROR(MEMORY, "X64OP_MOVS TODO: reversed direction");
-					return false;
-					//RSI(context) -= d_size;
-					//RDI(context) -= d_size;
-					//a_addr -= (u32)d_size;
-				}
-				else
-				{
-					RSI(context) += d_size;
-					RDI(context) += d_size;
-					a_addr += (u32)d_size;
-				}
-
-				// decrement counter
-				if (reg == X64_NOT_SET || !--RCX(context))
-				{
-					break;
-				}
-			}
-
-			if (reg == X64_NOT_SET || !RCX(context))
-			{
-				break;
-			}
-
-			// don't skip partially processed instruction
-			return true;
-		}
-		case X64OP_STOS:
-		{
-			if (d_size > 8)
-			{
-				LOG_ERROR(MEMORY, "X64OP_STOS: d_size=%lld", d_size);
-				return false;
-			}
-
-			if (vm::base(addr) != (void*)RDI(context))
-			{
-				LOG_ERROR(MEMORY, "X64OP_STOS: rdi=0x%llx, addr=0x%x", (u64)RDI(context), addr);
-				return false;
-			}
-
-			u64 value;
-			if (!get_x64_reg_value(context, X64R_RAX, d_size, i_size, value))
-			{
-				return false;
-			}
-
-			u32 a_addr = addr;
-
-			while (a_addr >> 12 == addr >> 12)
-			{
-				// fill data with value
-				std::memcpy(vm::base_priv(a_addr), &value, d_size);
-
-				// shift pointers
-				if (EFLAGS(context) & 0x400 /* direction flag */)
-				{
-					LOG_ERROR(MEMORY, "X64OP_STOS TODO: reversed direction");
-					return false;
-					//RDI(context) -= d_size;
-					//a_addr -= (u32)d_size;
-				}
-				else
-				{
-					RDI(context) += d_size;
-					a_addr += (u32)d_size;
-				}
-
-				// decrement counter
-				if (reg == X64_NOT_SET || !--RCX(context))
-				{
-					break;
-				}
-			}
-
-			if (reg == X64_NOT_SET || !RCX(context))
-			{
-				break;
-			}
-
-			// don't skip partially processed instruction
-			return true;
-		}
-		case X64OP_XCHG:
-		{
-			u64 reg_value;
-			if (!get_x64_reg_value(context, reg, d_size, i_size, reg_value))
-			{
-				return false;
-			}
-
-			switch (d_size)
-			{
-			case 1: reg_value = ((atomic_t<u8>*)vm::base_priv(addr))->exchange((u8)reg_value); break;
-			case 2: reg_value = ((atomic_t<u16>*)vm::base_priv(addr))->exchange((u16)reg_value); break;
-			case 4: reg_value = ((atomic_t<u32>*)vm::base_priv(addr))->exchange((u32)reg_value); break;
-			case 8: reg_value = ((atomic_t<u64>*)vm::base_priv(addr))->exchange((u64)reg_value); break;
-			default: return false;
-			}
-
-			if (!put_x64_reg_value(context, reg, d_size, reg_value))
-			{
-				return false;
-			}
-			break;
-		}
-		case X64OP_CMPXCHG:
-		{
-			u64 reg_value, old_value, cmp_value;
-			if (!get_x64_reg_value(context, reg, d_size, i_size, reg_value) || !get_x64_reg_value(context, X64R_RAX, d_size, i_size, cmp_value))
-			{
-				return false;
-			}
-
-			switch (d_size)
-			{
-			case 1: old_value = ((atomic_t<u8>*)vm::base_priv(addr))->compare_and_swap((u8)cmp_value, (u8)reg_value); break;
-			case 2: old_value = ((atomic_t<u16>*)vm::base_priv(addr))->compare_and_swap((u16)cmp_value, (u16)reg_value); break;
-			case 4: old_value = ((atomic_t<u32>*)vm::base_priv(addr))->compare_and_swap((u32)cmp_value, (u32)reg_value); break;
-			case 8: old_value = ((atomic_t<u64>*)vm::base_priv(addr))->compare_and_swap((u64)cmp_value, (u64)reg_value); break;
-			default: return false;
-			}
-
-			if (!put_x64_reg_value(context, X64R_RAX, d_size, old_value) || !set_x64_cmp_flags(context, d_size, cmp_value, old_value))
-			{
-				return false;
-			}
-			break;
-		}
-		case X64OP_AND:
-		{
-			u64 value;
-			if (!get_x64_reg_value(context, reg, d_size, i_size, value))
-			{
-				return false;
-			}
-
-			switch (d_size)
-			{
-			case 1: value = *(atomic_t<u8>*)vm::base_priv(addr) &= (u8)value; break;
-			case 2: value = *(atomic_t<u16>*)vm::base_priv(addr) &= (u16)value; break;
-			case 4: value = *(atomic_t<u32>*)vm::base_priv(addr) &= (u32)value; break;
-			case 8: value = *(atomic_t<u64>*)vm::base_priv(addr) &= (u64)value; break;
-			default: return false;
-			}
-
-			if (!set_x64_cmp_flags(context, d_size, value, 0))
-			{
-				return false;
-			}
-			break;
-		}
-		case X64OP_OR:
-		{
-			u64 value;
-			if (!get_x64_reg_value(context, reg, d_size, i_size, value))
-			{
-				return false;
-			}
-
-			switch (d_size)
-			{
-			case 1: value = *(atomic_t<u8>*)vm::base_priv(addr) |= (u8)value; break;
-			case 2: value = *(atomic_t<u16>*)vm::base_priv(addr) |= (u16)value; break;
-			case 4: value = *(atomic_t<u32>*)vm::base_priv(addr) |= (u32)value; break;
-			case 8: value = *(atomic_t<u64>*)vm::base_priv(addr) |= (u64)value; break;
-			default: return false;
-			}
-
-			if (!set_x64_cmp_flags(context, d_size, value, 0))
-			{
-				return false;
-			}
-			break;
-		}
-		case X64OP_XOR:
-		{
-			u64 value;
-			if (!get_x64_reg_value(context, reg, d_size, i_size, value))
-			{
-				return false;
-			}
-
-			switch (d_size)
-			{
-			case 1: value = *(atomic_t<u8>*)vm::base_priv(addr) ^= (u8)value; break;
-			case 2: value = *(atomic_t<u16>*)vm::base_priv(addr) ^= (u16)value; break;
-			case 4: value = *(atomic_t<u32>*)vm::base_priv(addr) ^= (u32)value; break;
-			case 8: value = *(atomic_t<u64>*)vm::base_priv(addr) ^= (u64)value; break;
-			default: return false;
-			}
-
-			if (!set_x64_cmp_flags(context, d_size, value, 0))
-			{
-				return false;
-			}
-			break;
-		}
-		case X64OP_INC:
-		{
-			u64 value;
-
-			switch (d_size)
-			{
-			case 1: value = ++*(atomic_t<u8>*)vm::base_priv(addr); break;
-			case 2: value = ++*(atomic_t<u16>*)vm::base_priv(addr); break;
-			case 4: value = ++*(atomic_t<u32>*)vm::base_priv(addr); break;
-			case 8: value = ++*(atomic_t<u64>*)vm::base_priv(addr); break;
-			default: return false;
-			}
-
-			if (!set_x64_cmp_flags(context, d_size, value, 1, false)) // ???
-			{
-				return false;
-			}
-			break;
-		}
-		case X64OP_DEC:
-		{
-			u64 value;
-
-			switch (d_size)
-			{
-			case 1: value = --*(atomic_t<u8>*)vm::base_priv(addr); break;
-			case 2: value = --*(atomic_t<u16>*)vm::base_priv(addr); break;
-			case 4: value = --*(atomic_t<u32>*)vm::base_priv(addr); break;
-			case 8: value = --*(atomic_t<u64>*)vm::base_priv(addr); break;
-			default: return false;
-			}
-
-			if (!set_x64_cmp_flags(context, d_size, value, -1, false)) // ???
-			{
-				return false;
-			}
-			break;
-		}
-		case X64OP_ADD:
-		{
-			u64 value, new_value;
-			if (!get_x64_reg_value(context, reg, d_size, i_size, value))
-			{
-				return false;
-			}
-
-			switch (d_size)
-			{
-			case 1: new_value = *(atomic_t<u8>*)vm::base_priv(addr) += (u8)value; break;
-			case 2: new_value = *(atomic_t<u16>*)vm::base_priv(addr) += (u16)value; break;
-			case 4: new_value = *(atomic_t<u32>*)vm::base_priv(addr) += (u32)value; break;
-			case 8: new_value = *(atomic_t<u64>*)vm::base_priv(addr) += (u64)value; break;
-			default: return false;
-			}
-
-			if (!set_x64_cmp_flags(context, d_size, new_value, value)) // ???
-			{
-				return false;
-			}
-			break;
-		}
-		case X64OP_ADC:
-		{
-			u64 value, new_value;
-			if (!get_x64_reg_value(context, reg, d_size, i_size, value))
-			{
-				return false;
-			}
-
-			switch (d_size)
-			{
-			case 1: new_value = *(atomic_t<u8>*)vm::base_priv(addr) += (u8)(value + (EFLAGS(context) & 1)); break;
-			case 2: new_value = *(atomic_t<u16>*)vm::base_priv(addr) += (u16)(value + (EFLAGS(context) & 1)); break;
-			case 4: new_value = *(atomic_t<u32>*)vm::base_priv(addr) += (u32)(value + (EFLAGS(context) & 1)); break;
-			case 8: new_value = *(atomic_t<u64>*)vm::base_priv(addr) += (u64)(value + (EFLAGS(context) & 1)); break;
-			default: return false;
-			}
-
-			if (!set_x64_cmp_flags(context, d_size, new_value, value + (EFLAGS(context) & 1))) // ???
-			{
-				return false;
-			}
-			break;
-		}
-		case X64OP_SUB:
-		{
-			u64 value, new_value;
-			if (!get_x64_reg_value(context, reg, d_size, i_size, value))
-			{
-				return false;
-			}
-
-			switch (d_size)
-			{
-			case 1: new_value = *(atomic_t<u8>*)vm::base_priv(addr) -= (u8)value; break;
-			case 2: new_value = *(atomic_t<u16>*)vm::base_priv(addr) -= (u16)value; break;
-			case 4: new_value = *(atomic_t<u32>*)vm::base_priv(addr) -= (u32)value; break;
-			case 8: new_value = *(atomic_t<u64>*)vm::base_priv(addr) -= (u64)value; break;
-			default: return false;
-			}
-
-			if (!set_x64_cmp_flags(context, d_size, new_value, 0 - value)) // ???
-			{
-				return false;
-			}
-			break;
-		}
-		case X64OP_SBB:
-		{
-			u64 value, new_value;
-			if (!get_x64_reg_value(context, reg, d_size, i_size, value))
-			{
-				return false;
-			}
-
-			switch (d_size)
-			{
-			case 1: new_value = *(atomic_t<u8>*)vm::base_priv(addr) -= (u8)(value + (EFLAGS(context) & 1)); break;
-			case 2: new_value = *(atomic_t<u16>*)vm::base_priv(addr) -= (u16)(value + (EFLAGS(context) & 1)); break;
-			case 4: new_value = *(atomic_t<u32>*)vm::base_priv(addr) -= (u32)(value + (EFLAGS(context) & 1)); break;
-			case 8: new_value = *(atomic_t<u64>*)vm::base_priv(addr) -= (u64)(value + (EFLAGS(context) & 1)); break;
-			default: return false;
-			}
-
-			if (!set_x64_cmp_flags(context, d_size, new_value, 0 - (value + (EFLAGS(context) & 1)))) // ???
-			{
-				return false;
-			}
-			break;
-		}
-		default:
-		{
-			LOG_ERROR(MEMORY, "Invalid or unsupported operation (op=%d, reg=%d, d_size=%lld, a_size=0x%llx, i_size=%lld)", (u32)op, (u32)reg, d_size, a_size, i_size);
-			report_opcode();
-			return false;
-		}
-		}
-
-		// skip processed instruction
-		RIP(context) += i_size;
-		return true;
-	});
-
 	// TODO: allow recovering from a page fault as a feature of PS3 virtual memory
+	return false;
 }
 
 #ifdef __linux__
@@ -2014,12 +1579,13 @@ void thread_ctrl::finalize(std::exception_ptr eptr) noexcept
 	const u64 time = 0;
 #endif
 
-	LOG_NOTICE(GENERAL, "Thread time: %fs (%fGc); Faults: %u [rsx:%u, spu:%u];",
+	LOG_NOTICE(GENERAL, "Thread time: %fs (%fGc); Faults: %u [rsx:%u, spu:%u, watch:%u];",
 		time / 1000000000.,
 		cycles / 1000000000.,
 		vm::g_tls_fault_count,
 		g_tls_fault_rsx,
-		g_tls_fault_spu);
+		g_tls_fault_spu,
+		g_tls_fault_watch);
 
 	--g_thread_count;
 
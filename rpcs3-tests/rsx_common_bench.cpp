@@ -0,0 +1,530 @@
+// Headless benchmark and regression suite for RSX common utilities (built with -DBUILD_RSX_BENCHMARK=ON)
+//
+// Usage: rsx_common_bench [--quick] [--baseline <file>] [--update-baseline] [--threshold <ratio>]
+// Every case is checked against a scalar reference first, then timed on fixed, seeded inputs.
+// With a baseline file, the run fails if a case drops below threshold * baseline GB/s or has no baseline entry.
+
+#include "../rpcs3/stdafx.h"
+#include "Emu/RSX/Common/BufferUtils.h"
+#include "Emu/RSX/Common/TextureUtils.h"
+#include "Emu/RSX/Common/ProgramStateCache.h"
+#include "Emu/RSX/rsx_utils.h"
+
+#include <chrono>
+#include <map>
+#include <random>
+#include <sstream>
+
+namespace
+{
+	struct bench_result
+	{
+		std::string name;
+		double gbps;
+		double calls;
+	};
+
+	template<typename T>
+	gsl::span<gsl::byte> dst_span(std::vector<T>& data)
+	{
+		return{ reinterpret_cast<gsl::byte*>(data.data()), ::narrow<int>(data.size() * sizeof(T)) };
+	}
+
+	template<typename T>
+	gsl::span<const gsl::byte> src_span(const std::vector<T>& data)
+	{
+		return{ reinterpret_cast<const gsl::byte*>(data.data()), ::narrow<int>(data.size() * sizeof(T)) };
+	}
+
+	std::vector<bench_result> g_results;
+	std::vector<std::string> g_failures;
+	double g_min_time = 0.25;
+
+	// Keeps hash results alive
+	volatile std::size_t g_sink;
+
+	void check(bool ok, const std::string& name, const std::string& what)
+	{
+		if (!ok)
+		{
+			g_failures.emplace_back(name + ": " + what);
+			std::printf("FAIL %s: %s\n", name.c_str(), what.c_str());
+		}
+	}
+
+	// Run func until g_min_time has passed, bytes is the amount of data produced by a single call
+	template<typename F>
+	void measure(const std::string& name, u64 bytes, F&& func)
+	{
+		using clock = std::chrono::steady_clock;
+
+		func();
+
+		u64 calls = 0;
+		const auto start = clock::now();
+		double elapsed = 0;
+
+		do
+		{
+			for (u32 i = 0; i < 8; i++)
+			{
+				func();
+			}
+
+			calls += 8;
+			elapsed = std::chrono::duration<double>(clock::now() - start).count();
+		}
+		while (elapsed < g_min_time);
+
+		g_results.push_back({name, bytes * calls / elapsed / 1e9, calls / elapsed});
+		std::printf("%-40s %8.2f GB/s %12.0f calls/s\n", name.c_str(), g_results.back().gbps, g_results.back().calls);
+	}
+
+	// Input corpora are generated from a fixed seed, so they are the same on every run
+	std::vector<u8> make_corpus(std::size_t size, u32 seed)
+	{
+		std::mt19937 gen(seed);
+		std::vector<u8> result(size);
+
+		for (auto& value : result)
+		{
+			value = static_cast<u8>(gen());
+		}
+
+		return result;
+	}
+
+	template<typename T>
+	T load_be(const u8* src)
+	{
+		T value{};
+
+		for (u32 i = 0; i < sizeof(T); i++)
+		{
+			value = static_cast<T>((value << 8) | src[i]);
+		}
+
+		return value;
+	}
+
+	void bench_vertex(rsx::vertex_base_type type, const char* type_name, u32 element_size, u32 vector_size, u32 src_stride)
+	{
+		const u32 count = 0x10000;
+		const u32 dst_stride = rsx::get_vertex_type_size_on_host(type, vector_size);
+		const std::string name = fmt::format("vertex %s x%u stride %u", type_name, vector_size, src_stride);
+
+		const auto src = make_corpus(src_stride * count, 1);
+		std::vector<u8> dst(dst_stride * count);
+
+		write_vertex_array_data_to_buffer(dst_span(dst), src_span(src), count, type, vector_size, src_stride, dst_stride);
+
+		bool ok = true;
+
+		if (type == rsx::vertex_base_type::cmp)
+		{
+			// Decoded vectors, against the scalar decoder
+			for (u32 i = 0; i < count && ok; i++)
+			{
+				const auto decoded = decode_cmp_vector(load_be<u32>(&src[i * src_stride]));
+				ok = std::memcmp(&dst[i * dst_stride], decoded.data(), sizeof(decoded)) == 0;
+			}
+		}
+		else
+		{
+			// Byteswapped attribute elements
+			for (u32 i = 0; i < count && ok; i++)
+			{
+				for (u32 j = 0; j < vector_size * element_size; j++)
+				{
+					const u32 swapped = j / element_size * element_size + (element_size - 1 - j % element_size);
+					ok = ok && dst[i * dst_stride + j] == src[i * src_stride + swapped];
+				}
+			}
+		}
+
+		check(ok, name, "wrong attribute data");
+
+		measure(name, u64{dst_stride} * count, [&]()
+		{
+			write_vertex_array_data_to_buffer(dst_span(dst), src_span(src), count, type, vector_size, src_stride, dst_stride);
+		});
+	}
+
+	template<typename T>
+	void bench_index(rsx::primitive_type mode, const char* mode_name, bool restart)
+	{
+		const u32 count = 0x30000;
+		const T restart_index = static_cast<T>(-1);
+		const std::string name = fmt::format("index u%u %s%s", sizeof(T) * 8, mode_name, restart ? " restart" : "");
+
+		auto src = make_corpus(count * sizeof(T), 2);
+
+		// Keep values in a realistic range, with some restart indices
+		for (u32 i = 0; i < count; i++)
+		{
+			T value = load_be<T>(&src[i * sizeof(T)]) % 50000;
+
+			if (restart && i % 97 == 0)
+			{
+				value = restart_index;
+			}
+
+			for (u32 j = 0; j < sizeof(T); j++)
+			{
+				src[i * sizeof(T) + j] = static_cast<u8>(value >> ((sizeof(T) - 1 - j) * 8));
+			}
+		}
+
+		const auto expands = [](rsx::primitive_type draw_mode) { return !is_primitive_native(draw_mode); };
+		const std::vector<std::pair<u32, u32>> ranges{{0, count}};
+		const u32 dst_count = get_index_count(mode, count);
+		const auto type = sizeof(T) == 2 ? rsx::index_array_type::u16 : rsx::index_array_type::u32;
+		std::vector<T> dst(dst_count + 8);
+
+		const auto result = write_index_array_data_to_buffer(dst_span(dst), src_span(src), type, mode, restart, restart_index, ranges, expands);
+
+		// Scalar reference
+		std::vector<T> in(count), expected;
+		T min_index = static_cast<T>(-1), max_index = 0;
+
+		for (u32 i = 0; i < count; i++)
+		{
+			in[i] = load_be<T>(&src[i * sizeof(T)]);
+
+			if (restart && in[i] == restart_index)
+			{
+				in[i] = static_cast<T>(-1);
+				continue;
+			}
+
+			if (mode != rsx::primitive_type::quads || i < count / 4 * 4)
+			{
+				min_index = std::min(min_index, in[i]);
+				max_index = std::max(max_index, in[i]);
+			}
+		}
+
+		switch (mode)
+		{
+		case rsx::primitive_type::quads:
+			for (u32 i = 0; i + 4 <= count; i += 4)
+			{
+				for (u32 k : {0, 1, 2, 2, 3, 0})
+				{
+					expected.push_back(in[i + k]);
+				}
+			}
+			break;
+		case rsx::primitive_type::triangle_fan:
+			for (u32 i = 1; i + 1 < count; i++)
+			{
+				expected.push_back(in[0]);
+				expected.push_back(in[i]);
+				expected.push_back(in[i + 1]);
+			}
+			break;
+		default:
+			expected = in;
+			break;
+		}
+
+		dst.resize(dst_count);
+		check(dst == expected, name, "wrong index data");
+		check(std::get<0>(result) == min_index && std::get<1>(result) == max_index, name, fmt::format("wrong min/max (%u, %u)", std::get<0>(result), std::get<1>(result)));
+		dst.resize(dst_count + 8);
+
+		measure(name, u64{dst_count} * sizeof(T), [&]()
+		{
+			write_index_array_data_to_buffer(dst_span(dst), src_span(src), type, mode, restart, restart_index, ranges, expands);
+		});
+	}
+
+	// Reference swizzled offset (bits of x and y interleaved up to the smaller dimension)
+	u32 morton_offset(u32 x, u32 y, u32 width, u32 height)
+	{
+		u32 result = 0, bit = 0;
+
+		for (u32 i = 0; (1u << i) < width || (1u << i) < height; i++)
+		{
+			if ((1u << i) < width) result |= ((x >> i) & 1) << bit++;
+			if ((1u << i) < height) result |= ((y >> i) & 1) << bit++;
+		}
+
+		return result;
+	}
+
+	void bench_texture(int format, const char* format_name, u32 bpp, u16 width, u16 height, bool swizzled)
+	{
+		const u32 dst_pitch = align(width * bpp, 256);
+		const std::string name = fmt::format("texture %s %ux%u%s", format_name, width, height, swizzled ? " swizzled" : "");
+
+		const auto src = make_corpus(width * height * bpp, 3);
+		std::vector<u8> dst(dst_pitch * height);
+
+		rsx_subresource_layout layout{};
+		layout.data = src_span(src);
+		layout.width_in_block = width;
+		layout.height_in_block = height;
+		layout.depth = 1;
+		layout.pitch_in_bytes = width;
+
+		upload_texture_subresource(dst_span(dst), layout, format, swizzled, 256);
+
+		// 16-bit formats are byteswapped, others are copied as is
+		bool ok = true;
+
+		for (u32 y = 0; y < height && ok; y++)
+		{
+			for (u32 x = 0; x < width; x++)
+			{
+				const u32 texel = swizzled ? morton_offset(x, y, width, height) : y * width + x;
+
+				for (u32 j = 0; j < bpp; j++)
+				{
+					ok = ok && dst[y * dst_pitch + x * bpp + j] == src[texel * bpp + (bpp == 2 ? 1 - j : j)];
+				}
+			}
+		}
+
+		check(ok, name, "wrong texel data");
+
+		measure(name, u64{width} * height * bpp, [&]()
+		{
+			upload_texture_subresource(dst_span(dst), layout, format, swizzled, 256);
+		});
+	}
+
+	// Check every texel of a linear -> swizzled -> linear round trip against the reference offsets
+	void check_swizzle(const std::string& name, u16 width, u16 height, const std::vector<u8>& linear, std::vector<u8>& swizzled)
+	{
+		rsx::convert_linear_swizzle<u32>(linear.data(), swizzled.data(), width, height, width * 4, false);
+
+		bool ok = true;
+
+		for (u32 y = 0; y < height && ok; y++)
+		{
+			for (u32 x = 0; x < width && ok; x++)
+			{
+				ok = std::memcmp(&swizzled[morton_offset(x, y, width, height) * 4], &linear[(y * width + x) * 4], 4) == 0;
+			}
+		}
+
+		check(ok, name, "wrong texel position");
+
+		std::vector<u8> back(linear.size());
+		rsx::convert_linear_swizzle<u32>(swizzled.data(), back.data(), width, height, true);
+
+		check(back == linear, name, "round trip mismatch");
+	}
+
+	// Swizzled image size in texels (larger than width * height if a dimension isn't a power of 2)
+	u32 get_swizzled_size(u16 width, u16 height)
+	{
+		u32 result = 0;
+
+		for (u32 y = 0; y < height; y++)
+		{
+			result = std::max(result, morton_offset(width - 1, y, width, height) + 1);
+		}
+
+		return result;
+	}
+
+	void bench_swizzle(u16 width, u16 height, bool timed = true)
+	{
+		const std::string name = fmt::format("swizzle u32 %ux%u", width, height);
+
+		const auto linear = make_corpus(width * height * 4, 4);
+		std::vector<u8> swizzled(get_swizzled_size(width, height) * 4);
+
+		check_swizzle(name, width, height, linear, swizzled);
+
+		// Tiny images are only checked, their timings are too noisy for the baseline
+		if (!timed)
+		{
+			return;
+		}
+
+		measure(name, u64{width} * height * 4, [&]()
+		{
+			rsx::convert_linear_swizzle<u32>(linear.data(), swizzled.data(), width, height, width * 4, false);
+		});
+	}
+
+	void bench_program_hash()
+	{
+		const std::string name = "program hash";
+
+		// Vertex program: 512 instructions
+		RSXVertexProgram vp{};
+		const auto vp_data = make_corpus(512 * 16, 5);
+		vp.data.resize(vp_data.size() / 4);
+		std::memcpy(vp.data.data(), vp_data.data(), vp_data.size());
+
+		RSXVertexProgram vp2 = vp;
+		vp2.data[100] ^= 1;
+
+		// Fragment program: 256 instructions without constants, the last one has the end flag
+		auto fp_data = make_corpus(256 * 16, 6);
+
+		for (u32 i = 0; i < 256; i++)
+		{
+			u32 word[4];
+			std::memcpy(word, &fp_data[i * 16], 16);
+			word[0] = (word[0] & ~0x100u) | (i == 255 ? 0x100u : 0);
+
+			for (u32 j = 1; j < 4; j++)
+			{
+				word[j] &= ~0x300u;
+			}
+
+			std::memcpy(&fp_data[i * 16], word, 16);
+		}
+
+		RSXFragmentProgram fp{};
+		fp.addr = fp_data.data();
+
+		check(program_hash_util::fragment_program_utils::get_fragment_program_ucode_size(fp.addr) == fp_data.size(), name, "wrong fragment program size");
+		check(program_hash_util::vertex_program_hash()(vp) == program_hash_util::vertex_program_hash()(RSXVertexProgram(vp)), name, "unstable vertex program hash");
+		check(program_hash_util::vertex_program_compare()(vp, RSXVertexProgram(vp)) && !program_hash_util::vertex_program_compare()(vp, vp2), name, "wrong vertex program comparison");
+		check(program_hash_util::fragment_program_compare()(fp, fp), name, "wrong fragment program comparison");
+
+		measure("vertex program hash", vp_data.size(), [&]()
+		{
+			g_sink = program_hash_util::vertex_program_hash()(vp);
+		});
+
+		measure("fragment program hash", fp_data.size(), [&]()
+		{
+			g_sink = program_hash_util::fragment_program_hash()(fp);
+		});
+	}
+
+	std::map<std::string, double> load_baseline(const std::string& path)
+	{
+		std::map<std::string, double> result;
+
+		if (const fs::file file{path})
+		{
+			std::istringstream stream(file.to_string());
+
+			for (std::string line; std::getline(stream, line);)
+			{
+				const auto pos = line.rfind(' ');
+
+				if (pos != std::string::npos && !line.empty() && line[0] != '#')
+				{
+					result[line.substr(0, pos)] = std::stod(line.substr(pos + 1));
+				}
+			}
+		}
+
+		return result;
+	}
+
+	void save_baseline(const std::string& path)
+	{
+		std::string data = "# rsx_common_bench baseline: case name, GB/s\n";
+
+		for (const auto& result : g_results)
+		{
+			data += fmt::format("%s %.3f\n", result.name, result.gbps);
+		}
+
+		if (!fs::file(path, fs::rewrite).write(data))
+		{
+			std::printf("Failed to write baseline %s\n", path.c_str());
+		}
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::string baseline_path;
+	bool update_baseline = false;
+	double threshold = 0.75;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const std::string arg = argv[i];
+
+		if (arg == "--quick")
+			g_min_time = 0.05;
+		else if (arg == "--baseline" && i + 1 < argc)
+			baseline_path = argv[++i];
+		else if (arg == "--update-baseline")
+			update_baseline = true;
+		else if (arg == "--threshold" && i + 1 < argc)
+			threshold = std::stod(argv[++i]);
+		else
+		{
+			std::printf("Usage: %s [--quick] [--baseline <file>] [--update-baseline] [--threshold <ratio>]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	bench_vertex(rsx::vertex_base_type::f, "f", 4, 3, 12);
+	bench_vertex(rsx::vertex_base_type::f, "f", 4, 4, 16);
+	bench_vertex(rsx::vertex_base_type::f, "f", 4, 3, 32);
+	bench_vertex(rsx::vertex_base_type::sf, "sf", 2, 2, 32);
+	bench_vertex(rsx::vertex_base_type::s1, "s1", 2, 4, 8);
+	bench_vertex(rsx::vertex_base_type::ub, "ub", 1, 4, 32);
+	bench_vertex(rsx::vertex_base_type::cmp, "cmp", 4, 1, 4);
+	bench_vertex(rsx::vertex_base_type::cmp, "cmp", 4, 1, 12);
+
+	bench_index<u16>(rsx::primitive_type::triangles, "triangles", false);
+	bench_index<u16>(rsx::primitive_type::triangles, "triangles", true);
+	bench_index<u32>(rsx::primitive_type::triangles, "triangles", true);
+	bench_index<u16>(rsx::primitive_type::quads, "quads", false);
+	bench_index<u32>(rsx::primitive_type::quads, "quads", true);
+	bench_index<u16>(rsx::primitive_type::triangle_fan, "triangle_fan", false);
+	bench_index<u32>(rsx::primitive_type::triangle_fan, "triangle_fan", true);
+
+	bench_texture(CELL_GCM_TEXTURE_A8R8G8B8, "A8R8G8B8", 4, 1024, 1024, false);
+	bench_texture(CELL_GCM_TEXTURE_A8R8G8B8, "A8R8G8B8", 4, 1024, 1024, true);
+	bench_texture(CELL_GCM_TEXTURE_A8R8G8B8, "A8R8G8B8", 4, 256, 64, true);
+	bench_texture(CELL_GCM_TEXTURE_R5G6B5, "R5G6B5", 2, 512, 512, true);
+	bench_texture(CELL_GCM_TEXTURE_B8, "B8", 1, 512, 512, true);
+
+	bench_swizzle(1024, 1024);
+	bench_swizzle(512, 128);
+	bench_swizzle(16, 1024);
+	bench_swizzle(640, 480);
+	bench_swizzle(100, 37);
+	bench_swizzle(1, 1, false);
+	bench_swizzle(2, 2, false);
+	bench_swizzle(3, 2, false);
+	bench_swizzle(1, 4, false);
+	bench_swizzle(4, 1, false);
+	bench_swizzle(2, 64, false);
+
+	bench_program_hash();
+
+	if (!baseline_path.empty())
+	{
+		const auto baseline = load_baseline(baseline_path);
+
+		for (const auto& result : g_results)
+		{
+			const auto found = baseline.find(result.name);
+
+			if (found == baseline.end())
+			{
+				// A missing or incomplete baseline must not pass silently
+				check(update_baseline, result.name, "no baseline entry");
+			}
+			else if (result.gbps < found->second * threshold)
+			{
+				check(false, result.name, fmt::format("regressed to %.2f GB/s (baseline %.2f GB/s)", result.gbps, found->second));
+			}
+		}
+
+		if (update_baseline)
+		{
+			save_baseline(baseline_path);
+		}
+	}
+
+	std::printf("%zu cases, %zu failures\n", g_results.size(), g_failures.size());
+	return g_failures.empty() ? 0 : 1;
+}
@@ -31,6 +31,18 @@
 
 #include "aes.h"
 
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#include <wmmintrin.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define AESNI_TARGET
+#else
+#include <cpuid.h>
+#define AESNI_TARGET __attribute__((target("aes")))
+#endif
+
 /*
  * 32-bit integer manipulation macros (little endian)
  */
@@ -932,6 +944,126 @@ void padding (unsigned char *lastb, unsigned char *pad, int length)
 	}
 }
 
+/*
+ * AES-NI availability (checked once)
+ */
+int aes_aesni_supported( void )
+{
+    static const int supported = []
+    {
+#if defined(_MSC_VER)
+        int regs[4];
+        __cpuid( regs, 1 );
+        return ( regs[2] >> 25 ) & 1;
+#else
+        unsigned int a, b, c, d;
+        return __get_cpuid( 1, &a, &b, &c, &d ) ? ( c >> 25 ) & 1 : 0;
+#endif
+    }();
+
+    return( supported );
+}
+
+/*
+ * AES-CTR in-place encryption/decryption using AES-NI (4 blocks interleaved)
+ */
+AESNI_TARGET static void aesni_ctr_xor_blocks( aes_context *ctx,
+                                               size_t blocks,
+                                               unsigned long long hi,
+                                               unsigned long long lo,
+                                               unsigned char *data )
+{
+    const __m128i bswap = _mm_set_epi8( 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 );
+    const int nr = ctx->nr;
+    __m128i rk[15];
+    int r;
+
+    for( r = 0; r <= nr; r++ )
+        rk[r] = _mm_loadu_si128( (const __m128i *) ( ctx->rk + r * 4 ) );
+
+#define AESNI_NEXT_CTR( b )                                                     \
+    b = _mm_xor_si128( _mm_shuffle_epi8( _mm_set_epi64x( hi, lo ), bswap ), rk[0] ); \
+    hi += ( ++lo == 0 );
+
+    for( ; blocks >= 4; blocks -= 4, data += 64 )
+    {
+        __m128i b0, b1, b2, b3;
+        AESNI_NEXT_CTR( b0 );
+        AESNI_NEXT_CTR( b1 );
+        AESNI_NEXT_CTR( b2 );
+        AESNI_NEXT_CTR( b3 );
+
+        for( r = 1; r < nr; r++ )
+        {
+            b0 = _mm_aesenc_si128( b0, rk[r] );
+            b1 = _mm_aesenc_si128( b1, rk[r] );
+            b2 = _mm_aesenc_si128( b2, rk[r] );
+            b3 = _mm_aesenc_si128( b3, rk[r] );
+        }
+
+        __m128i *out = (__m128i *) data;
+        _mm_storeu_si128( out + 0, _mm_xor_si128( _mm_loadu_si128( out + 0 ), _mm_aesenclast_si128( b0, rk[nr] ) ) );
+        _mm_storeu_si128( out + 1, _mm_xor_si128( _mm_loadu_si128( out + 1 ), _mm_aesenclast_si128( b1, rk[nr] ) ) );
+        _mm_storeu_si128( out + 2, _mm_xor_si128( _mm_loadu_si128( out + 2 ), _mm_aesenclast_si128( b2, rk[nr] ) ) );
+        _mm_storeu_si128( out + 3, _mm_xor_si128( _mm_loadu_si128( out + 3 ), _mm_aesenclast_si128( b3, rk[nr] ) ) );
+    }
+
+    for( ; blocks; blocks--, data += 16 )
+    {
+        __m128i b0;
+        AESNI_NEXT_CTR( b0 );
+
+        for( r = 1; r < nr; r++ )
+            b0 = _mm_aesenc_si128( b0, rk[r] );
+
+        __m128i *out = (__m128i *) data;
+        _mm_storeu_si128( out, _mm_xor_si128( _mm_loadu_si128( out ), _mm_aesenclast_si128( b0, rk[nr] ) ) );
+    }
+
+#undef AESNI_NEXT_CTR
+}
+
+/*
+ * AES-CTR in-place encryption/decryption of whole blocks (128-bit big-endian counter)
+ */
+void aes_ctr_xor_blocks( aes_context *ctx,
+                         size_t blocks,
+                         const unsigned char counter[16],
+                         unsigned char *data )
+{
+    unsigned long long hi = 0, lo = 0;
+    unsigned char block[16], stream[16];
+    int i;
+
+    for( i = 0; i < 8; i++ )
+    {
+        hi = ( hi << 8 ) | counter[i];
+        lo = ( lo << 8 ) | counter[i + 8];
+    }
+
+    if( aes_aesni_supported() )
+    {
+        aesni_ctr_xor_blocks( ctx, blocks, hi, lo, data );
+        return;
+    }
+
+    for( ; blocks; blocks--, data += 16 )
+    {
+        for( i = 0; i < 8; i++ )
+        {
+            block[i]     = (unsigned char) ( hi >> ( 56 - i * 8 ) );
+            block[i + 8] = (unsigned char) ( lo >> ( 56 - i * 8 ) );
+        }
+
+        hi += ( ++lo == 0 );
+
+        aes_crypt_ecb( ctx, AES_ENCRYPT, block, stream );
+
+        for( i = 0; i < 16; i++ )
+            data[i] ^= stream[i];
+    }
+}
+
 void aes_cmac(aes_context *ctx, int length, unsigned char *input, unsigned char *output)
 {
     unsigned char X[16], Y[16], M_last[16], padded[16];
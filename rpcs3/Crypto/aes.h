@@ -172,6 +172,27 @@ int aes_crypt_ctr( aes_context *ctx,
                        const unsigned char *input,
                        unsigned char *output );
 
+/**
+ * \brief          Check whether AES-NI instructions are available
+ *
+ * \return         1 if supported, 0 otherwise
+ */
+int aes_aesni_supported( void );
+
+/**
+ * \brief          AES-CTR in-place encryption/decryption of whole blocks
+ *                 (uses AES-NI if available)
+ *
+ * \param ctx      AES context initialized with aes_setkey_enc()
+ * \param blocks   number of 16-byte blocks
+ * \param counter  128-bit big-endian counter of the first block
+ * \param data     buffer holding the data
+ */
+void aes_ctr_xor_blocks( aes_context *ctx,
+                         size_t blocks,
+                         const unsigned char counter[16],
+                         unsigned char *data );
+
 void aes_cmac(aes_context *ctx, int length, unsigned char *input, unsigned char *output);
 
 #ifdef __cplusplus
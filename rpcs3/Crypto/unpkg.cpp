@@ -1,13 +1,19 @@
 #include "stdafx.h"
+#include "Utilities/Thread.h"
 #include "utils.h"
 #include "aes.h"
 #include "sha1.h"
 #include "key_vault.h"
 #include "unpkg.h"
 
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+
 bool pkg_install(const fs::file& pkg_f, const std::string& dir, atomic_t<double>& sync)
 {
-	const std::size_t BUF_SIZE = 8192 * 1024; // 8 MB
+	const std::size_t BUF_SIZE = 1024 * 1024; // 1 MB (chunk size, one buffer per worker)
 
 	// Save current file offset (probably zero)
 	const u64 start_offset = pkg_f.pos();
@@ -67,16 +73,16 @@ bool pkg_install(const fs::file& pkg_f, const std::string& dir, atomic_t<double>
 		return false;
 	}
 
-	// Allocate buffer with BUF_SIZE size or more if required
-	const std::unique_ptr<u128[]> buf(new u128[std::max<u64>(BUF_SIZE, sizeof(PKGEntry) * header.file_count) / sizeof(u128)]);
+	// AES contexts for release packages (set up once, read-only afterwards)
+	aes_context ctx_ps3, ctx_psp;
+	aes_setkey_enc(&ctx_ps3, PKG_AES_KEY, 128);
+	aes_setkey_enc(&ctx_psp, PKG_AES_KEY2, 128);
 
-	// Define decryption subfunction (`psp` arg selects the key for specific block)
-	auto decrypt = [&](u64 offset, u64 size, bool psp) -> u64
+	// Define decryption subfunction (`psp` arg selects the key for specific block), thread-safe
+	auto decrypt = [&](u64 offset, u64 size, bool psp, u128* buf) -> u64
 	{
-		pkg_f.seek(start_offset + header.data_offset + offset);
-
 		// Read the data and set available size
-		const u64 read = pkg_f.read(buf.get(), size);
+		const u64 read = pkg_f.read_at(start_offset + header.data_offset + offset, buf, size);
 
 		// Get block count
 		const u64 blocks = (read + 15) / 16;
@@ -111,37 +117,131 @@ bool pkg_install(const fs::file& pkg_f, const std::string& dir, atomic_t<double>
 
 		if (header.pkg_type == PKG_RELEASE_TYPE_RELEASE)
 		{
-			aes_context ctx;
+			// Initialize stream cipher for start position
+			const be_t<u128> input = header.klicensee.value() + offset / 16;
 
-			// Set encryption key for stream cipher
-			aes_setkey_enc(&ctx, psp ? PKG_AES_KEY2 : PKG_AES_KEY, 128);
+			aes_ctr_xor_blocks(psp ? &ctx_psp : &ctx_ps3, blocks, reinterpret_cast<const u8*>(&input), reinterpret_cast<u8*>(buf));
+		}
 
-			// Initialize stream cipher for start position
-			be_t<u128> input = header.klicensee.value() + offset / 16;
+		// Return the amount of data written in buf
+		return read;
+	};
 
-			// Increment stream position for every block
-			for (u64 i = 0; i < blocks; i++, input++)
-			{
-				u128 key;
+	std::vector<PKGEntry> entries(header.file_count);
 
-				aes_crypt_ecb(&ctx, AES_ENCRYPT, reinterpret_cast<const u8*>(&input), reinterpret_cast<u8*>(&key));
+	// Allocate buffer for the entry table (padded to the block size)
+	const std::unique_ptr<u128[]> table(new u128[(sizeof(PKGEntry) * header.file_count + 15) / 16]);
 
-				buf[i] ^= key;
-			}
+	decrypt(0, header.file_count * sizeof(PKGEntry), header.pkg_platform == PKG_PLATFORM_TYPE_PSP, table.get());
+
+	std::memcpy(entries.data(), table.get(), entries.size() * sizeof(PKGEntry));
+
+	// Output file shared by its chunks (closed after the last one is written)
+	struct file_job
+	{
+		fs::file out;
+		std::string path;
+		atomic_t<bool> failed{false};
+	};
+
+	struct chunk_job
+	{
+		std::shared_ptr<file_job> file;
+		u64 offset; // Data offset in PKG
+		u64 size;
+		u64 pos; // Position in output file
+		bool psp;
+	};
+
+	// Bounded chunk queue: entries are parsed in order, while the workers overlap reading, decryption and writing
+	const std::size_t worker_count = std::max<std::size_t>(std::min<std::size_t>(std::thread::hardware_concurrency(), 8), 2);
+	const std::size_t queue_max = worker_count * 2;
+
+	std::mutex queue_mutex;
+	std::condition_variable queue_cv;
+	std::deque<chunk_job> queue;
+	bool queue_done = false;
+	atomic_t<bool> cancelled{false};
+
+	auto pop_chunk = [&](chunk_job& chunk) -> bool
+	{
+		std::unique_lock<std::mutex> lock(queue_mutex);
+
+		queue_cv.wait(lock, [&] { return !queue.empty() || queue_done; });
+
+		if (queue.empty())
+		{
+			return false;
 		}
 
-		// Return the amount of data written in buf
-		return read;
+		chunk = std::move(queue.front());
+		queue.pop_front();
+		queue_cv.notify_all();
+		return true;
 	};
 
-	decrypt(0, header.file_count * sizeof(PKGEntry), header.pkg_platform == PKG_PLATFORM_TYPE_PSP);
+	std::vector<std::shared_ptr<thread_ctrl>> workers(worker_count);
 
-	std::vector<PKGEntry> entries(header.file_count);
+	for (std::size_t i = 0; i < workers.size(); i++)
+	{
+		thread_ctrl::spawn(workers[i], fmt::format("PKG Worker %u", i), [&]()
+		{
+			const std::unique_ptr<u128[]> buf(new u128[BUF_SIZE / sizeof(u128)]);
+
+			for (chunk_job chunk; pop_chunk(chunk); chunk.file.reset())
+			{
+				auto& file = *chunk.file;
+
+				if (cancelled || file.failed)
+				{
+					continue;
+				}
+
+				if (decrypt(chunk.offset, chunk.size, chunk.psp, buf.get()) != chunk.size)
+				{
+					if (!file.failed.exchange(true))
+					{
+						LOG_ERROR(LOADER, "Failed to extract file %s", file.path);
+					}
+
+					continue;
+				}
+
+				if (file.out.write_at(chunk.pos, buf.get(), chunk.size) != chunk.size)
+				{
+					if (!file.failed.exchange(true))
+					{
+						LOG_ERROR(LOADER, "Failed to write file %s", file.path);
+					}
 
-	std::memcpy(entries.data(), buf.get(), entries.size() * sizeof(PKGEntry));
+					continue;
+				}
+
+				if (sync.fetch_add((chunk.size + 0.0) / header.data_size) < 0.)
+				{
+					cancelled = true;
+				}
+			}
+		});
+	}
+
+	auto push_chunk = [&](chunk_job&& chunk)
+	{
+		std::unique_lock<std::mutex> lock(queue_mutex);
+
+		queue_cv.wait(lock, [&] { return queue.size() < queue_max; });
+
+		queue.emplace_back(std::move(chunk));
+		queue_cv.notify_all();
+	};
 
 	for (const auto& entry : entries)
 	{
+		if (cancelled)
+		{
+			break;
+		}
+
 		const bool is_psp = (entry.type & PKG_FILE_ENTRY_PSP) != 0;
 
 		if (entry.name_size > 256)
@@ -150,9 +250,11 @@ bool pkg_install(const fs::file& pkg_f, const std::string& dir, atomic_t<double>
 			continue;
 		}
 
-		decrypt(entry.name_offset, entry.name_size, is_psp);
+		u128 name_buf[256 / sizeof(u128)];
 
-		const std::string name(reinterpret_cast<char*>(buf.get()), entry.name_size);
+		decrypt(entry.name_offset, entry.name_size, is_psp, name_buf);
+
+		const std::string name(reinterpret_cast<char*>(name_buf), entry.name_size);
 
 		switch (entry.type & 0xff)
 		{
@@ -168,29 +270,6 @@ bool pkg_install(const fs::file& pkg_f, const std::string& dir, atomic_t<double>
 
 			if (fs::file out{ path, fs::rewrite })
 			{
-				for (u64 pos = 0; pos < entry.file_size; pos += BUF_SIZE)
-				{
-					const u64 block_size = std::min<u64>(BUF_SIZE, entry.file_size - pos);
-
-					if (decrypt(entry.file_offset + pos, block_size, is_psp) != block_size)
-					{
-						LOG_ERROR(LOADER, "Failed to extract file %s", path);
-						break;
-					}
-
-					if (out.write(buf.get(), block_size) != block_size)
-					{
-						LOG_ERROR(LOADER, "Failed to write file %s", path);
-						break;
-					}
-
-					if (sync.fetch_add((block_size + 0.0) / header.data_size) < 0.)
-					{
-						LOG_ERROR(LOADER, "Package installation cancelled: %s", dir);
-						return false;
-					}
-				}
-
 				if (did_overwrite)
 				{
 					LOG_WARNING(LOADER, "Overwritten file %s", name);
@@ -199,6 +278,17 @@ bool pkg_install(const fs::file& pkg_f, const std::string& dir, atomic_t<double>
 				{
 					LOG_NOTICE(LOADER, "Created file %s", name);
 				}
+
+				const auto file = std::make_shared<file_job>();
+				file->out = std::move(out);
+				file->path = path;
+
+				for (u64 pos = 0; pos < entry.file_size && !cancelled; pos += BUF_SIZE)
+				{
+					const u64 block_size = std::min<u64>(BUF_SIZE, entry.file_size - pos);
+
+					push_chunk({file, entry.file_offset + pos, block_size, pos, is_psp});
+				}
 			}
 			else
 			{
@@ -235,6 +325,24 @@ bool pkg_install(const fs::file& pkg_f, const std::string& dir, atomic_t<double>
 		}
 	}
 
+	// Let the workers finish the remaining chunks
+	{
+		std::lock_guard<std::mutex> lock(queue_mutex);
+		queue_done = true;
+		queue_cv.notify_all();
+	}
+
+	for (const auto& worker : workers)
+	{
+		worker->join();
+	}
+
+	if (cancelled)
+	{
+		LOG_ERROR(LOADER, "Package installation cancelled: %s", dir);
+		return false;
+	}
+
 	LOG_SUCCESS(LOADER, "Package successfully installed to %s", dir);
 	return true;
 }
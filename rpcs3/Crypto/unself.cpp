@@ -3,10 +3,55 @@
 #include "sha1.h"
 #include "utils.h"
 #include "unself.h"
+#include "Utilities/Thread.h"
 
 // TODO: Still reliant on wxWidgets for zlib functions. Alternative solutions?
 #include <zlib.h>
 
+#include <thread>
+#include <chrono>
+
+// Run func(0 .. count - 1) on several threads if the total work size is big enough
+static void self_parallel_for(u32 count, u64 work_size, const std::function<void(u32)>& func)
+{
+	const u32 threads = work_size < 0x40000 ? 1 : std::min<u32>(count, std::max<u32>(std::thread::hardware_concurrency(), 1));
+
+	if (threads <= 1)
+	{
+		for (u32 i = 0; i < count; i++)
+		{
+			func(i);
+		}
+
+		return;
+	}
+
+	atomic_t<u32> index{0};
+
+	auto work = [&]()
+	{
+		for (u32 i; (i = index++) < count;)
+		{
+			func(i);
+		}
+	};
+
+	// The calling thread takes part in the work
+	std::vector<std::shared_ptr<thread_ctrl>> workers(threads - 1);
+
+	for (std::size_t i = 0; i < workers.size(); i++)
+	{
+		thread_ctrl::spawn(workers[i], fmt::format("SELF Worker %u", i), work);
+	}
+
+	work();
+
+	for (const auto& worker : workers)
+	{
+		worker->join();
+	}
+}
+
 inline u8 Read8(const fs::file& f)
 {
 	u8 ret;
@@ -976,64 +1021,63 @@ bool SELFDecrypter::LoadMetadata()
 
 bool SELFDecrypter::DecryptData()
 {
-	aes_context aes;
+	// Encrypted sections and their offsets in the data buffer.
+	std::vector<std::pair<u32, u32>> sections;
 
 	// Calculate the total data size.
 	for (unsigned int i = 0; i < meta_hdr.section_count; i++)
 	{
 		if (meta_shdr[i].encrypted == 3)
 		{
+			// Make sure the key and iv are not out of boundaries.
 			if ((meta_shdr[i].key_idx <= meta_hdr.key_count - 1) && (meta_shdr[i].iv_idx <= meta_hdr.key_count))
+			{
+				sections.emplace_back(i, data_buf_length);
 				data_buf_length += meta_shdr[i].data_size;
+			}
 		}
 	}
 
 	// Allocate a buffer to store decrypted data.
 	data_buf = std::make_unique<u8[]>(data_buf_length);
 
-	// Set initial offset.
-	u32 data_buf_offset = 0;
-
-	// Parse the metadata section headers to find the offsets of encrypted data.
-	for (unsigned int i = 0; i < meta_hdr.section_count; i++)
+	// Read the encrypted data (sequentially, the file may be a memory stream).
+	for (const auto& section : sections)
 	{
-		size_t ctr_nc_off = 0;
-		u8 ctr_stream_block[0x10];
-		u8 data_key[0x10];
-		u8 data_iv[0x10];
-
-		// Check if this is an encrypted section.
-		if (meta_shdr[i].encrypted == 3)
-		{
-			// Make sure the key and iv are not out of boundaries.
-			if((meta_shdr[i].key_idx <= meta_hdr.key_count - 1) && (meta_shdr[i].iv_idx <= meta_hdr.key_count))
-			{
-				// Get the key and iv from the previously stored key buffer.
-				memcpy(data_key, data_keys.get() + meta_shdr[i].key_idx * 0x10, 0x10);
-				memcpy(data_iv, data_keys.get() + meta_shdr[i].iv_idx * 0x10, 0x10);
+		self_f.seek(meta_shdr[section.first].data_offset);
+		self_f.read(data_buf.get() + section.second, meta_shdr[section.first].data_size);
+	}
 
-				// Allocate a buffer to hold the data.
-				auto buf = std::make_unique<u8[]>(meta_shdr[i].data_size);
+	// Decrypt the sections in place.
+	self_parallel_for(::size32(sections), data_buf_length, [&](u32 index)
+	{
+		const auto& shdr = meta_shdr[sections[index].first];
+		u8* const data = data_buf.get() + sections[index].second;
+		const u32 size = shdr.data_size;
 
-				// Seek to the section data offset and read the encrypted data.
-				self_f.seek(meta_shdr[i].data_offset);
-				self_f.read(buf.get(), meta_shdr[i].data_size);
+		// Get the key and iv from the previously stored key buffer.
+		be_t<u128> data_iv;
+		std::memcpy(&data_iv, data_keys.get() + shdr.iv_idx * 0x10, 0x10);
 
-				// Zero out our ctr nonce.
-				memset(ctr_stream_block, 0, sizeof(ctr_stream_block));
+		// Perform AES-CTR encryption on the data blocks.
+		aes_context aes;
+		aes_setkey_enc(&aes, data_keys.get() + shdr.key_idx * 0x10, 128);
+		aes_ctr_xor_blocks(&aes, size / 16, reinterpret_cast<const u8*>(&data_iv), data);
 
-				// Perform AES-CTR encryption on the data blocks.
-				aes_setkey_enc(&aes, data_key, 128);
-				aes_crypt_ctr(&aes, meta_shdr[i].data_size, &ctr_nc_off, data_iv, ctr_stream_block, buf.get(), buf.get());
+		// Process the last partial block.
+		if (const u32 tail = size % 16)
+		{
+			const be_t<u128> ctr = data_iv.value() + size / 16;
 
-				// Copy the decrypted data.
-				memcpy(data_buf.get() + data_buf_offset, buf.get(), meta_shdr[i].data_size);
+			u8 stream[0x10];
+			aes_crypt_ecb(&aes, AES_ENCRYPT, reinterpret_cast<const u8*>(&ctr), stream);
 
-				// Advance the buffer's offset.
-				data_buf_offset += meta_shdr[i].data_size;
+			for (u32 i = 0; i < tail; i++)
+			{
+				data[size - tail + i] ^= stream[i];
 			}
 		}
-	}
+	});
 
 	return true;
 }
@@ -1093,50 +1137,66 @@ fs::file SELFDecrypter::MakeElf(bool isElf32)
 			WritePhdr(e, phdr64_arr[i]);
 		}
 
-		// Write data.
+		// Compressed sections: data offset and decompressed data.
+		std::vector<std::pair<u32, std::unique_ptr<u8[]>>> decomp(meta_hdr.section_count);
+
 		for (unsigned int i = 0; i < meta_hdr.section_count; i++)
 		{
 			// PHDR type.
 			if (meta_shdr[i].type == 2)
 			{
-				// Decompress if necessary.
 				if (meta_shdr[i].compressed == 2)
 				{
-					/// Removed all wxWidget dependent code. Replaced with zlib functions.
-					/// Also changed local mallocs to unique_ptrs.
-
-					// Store the length in writeable memory space.
-					std::unique_ptr<uLongf> decomp_buf_length(new uLongf);
-					memcpy(decomp_buf_length.get(), &phdr64_arr[meta_shdr[i].program_idx].p_filesz, sizeof(uLongf));
-
-					/// Create a pointer to a buffer for decompression.
-					std::unique_ptr<u8[]> decomp_buf(new u8[phdr64_arr[meta_shdr[i].program_idx].p_filesz]);
-
-					// Create a buffer separate from data_buf to uncompress.
-					std::unique_ptr<u8[]> zlib_buf(new u8[data_buf_length]);
-					memcpy(zlib_buf.get(), data_buf.get(), data_buf_length);
-
-					// Use zlib uncompress on the new buffer.
-					// decomp_buf_length changes inside the call to uncompress, so it must be a pointer to correct type (in writeable mem space).
-					int rv = uncompress(decomp_buf.get(), decomp_buf_length.get(), zlib_buf.get() + data_buf_offset, data_buf_length);
-
-					// Check for errors (TODO: Probably safe to remove this once these changes have passed testing.)
-					switch (rv)
-					{
-					case Z_MEM_ERROR:	LOG_ERROR(LOADER, "MakeELF encountered a Z_MEM_ERROR!"); break;
-					case Z_BUF_ERROR:	LOG_ERROR(LOADER, "MakeELF encountered a Z_BUF_ERROR!"); break;
-					case Z_DATA_ERROR:	LOG_ERROR(LOADER, "MakeELF encountered a Z_DATA_ERROR!"); break;
-					default: break;
-					}
-
-					// Seek to the program header data offset and write the data.
-					e.seek(phdr64_arr[meta_shdr[i].program_idx].p_offset);
-					e.write(decomp_buf.get(), phdr64_arr[meta_shdr[i].program_idx].p_filesz);
+					decomp[i].first = data_buf_offset;
+					decomp[i].second.reset(new u8[phdr64_arr[meta_shdr[i].program_idx].p_filesz]);
+				}
+
+				// Advance the data buffer offset by data size.
+				data_buf_offset += meta_shdr[i].data_size;
+			}
+		}
+
+		// Decompress the sections.
+		self_parallel_for(meta_hdr.section_count, data_buf_length, [&](u32 i)
+		{
+			if (!decomp[i].second)
+			{
+				return;
+			}
+
+			// decomp_buf_length changes inside the call to uncompress.
+			uLongf decomp_buf_length = static_cast<uLongf>(phdr64_arr[meta_shdr[i].program_idx].p_filesz);
+
+			// Use zlib uncompress directly on the data buffer.
+			const int rv = uncompress(decomp[i].second.get(), &decomp_buf_length, data_buf.get() + decomp[i].first, data_buf_length - decomp[i].first);
+
+			// Check for errors (TODO: Probably safe to remove this once these changes have passed testing.)
+			switch (rv)
+			{
+			case Z_MEM_ERROR:	LOG_ERROR(LOADER, "MakeELF encountered a Z_MEM_ERROR!"); break;
+			case Z_BUF_ERROR:	LOG_ERROR(LOADER, "MakeELF encountered a Z_BUF_ERROR!"); break;
+			case Z_DATA_ERROR:	LOG_ERROR(LOADER, "MakeELF encountered a Z_DATA_ERROR!"); break;
+			default: break;
+			}
+		});
+
+		data_buf_offset = 0;
+
+		// Write data.
+		for (unsigned int i = 0; i < meta_hdr.section_count; i++)
+		{
+			// PHDR type.
+			if (meta_shdr[i].type == 2)
+			{
+				// Seek to the program header data offset and write the data.
+				e.seek(phdr64_arr[meta_shdr[i].program_idx].p_offset);
+
+				if (decomp[i].second)
+				{
+					e.write(decomp[i].second.get(), phdr64_arr[meta_shdr[i].program_idx].p_filesz);
 				}
 				else
 				{
-					// Seek to the program header data offset and write the data.
-					e.seek(phdr64_arr[meta_shdr[i].program_idx].p_offset);
 					e.write(data_buf.get() + data_buf_offset, meta_shdr[i].data_size);
 				}
 
@@ -1257,13 +1317,73 @@ static bool CheckDebugSelf(fs::file& s)
 	return false;
 }
 
-extern fs::file decrypt_self(fs::file elf_or_self)
+// Get cache path of the decrypted SELF (keyed by SHA-1 of the whole file)
+static std::string get_self_cache_path(const fs::file& self)
+{
+	sha1_context ctx;
+	sha1_starts(&ctx);
+
+	self.seek(0);
+
+	std::vector<u8> buf(0x10000);
+
+	while (const u64 size = self.read(buf.data(), buf.size()))
+	{
+		sha1_update(&ctx, buf.data(), size);
+	}
+
+	u8 hash[20];
+	sha1_finish(&ctx, hash);
+
+	return fmt::format("%sdata/cache/self/%016llx%016llx%08x.elf", fs::get_config_dir(),
+		reinterpret_cast<be_t<u64>&>(hash[0]), reinterpret_cast<be_t<u64>&>(hash[8]), reinterpret_cast<be_t<u32>&>(hash[16]));
+}
+
+// Save decrypted SELF in the cache (write to temporary file first, other processes may read the cache concurrently)
+static void save_self_cache(const std::string& path, const fs::file& elf)
+{
+	const std::string dir = path.substr(0, path.find_last_of('/') + 1);
+
+	if (!fs::is_dir(dir) && !fs::create_path(dir))
+	{
+		LOG_ERROR(LOADER, "SELF: Failed to create cache directory %s (%s)", dir, fs::g_tls_error);
+		return;
+	}
+
+	const std::string tmp = fmt::format("%s.%x.tmp", path, std::hash<std::thread::id>()(std::this_thread::get_id()) ^ std::chrono::steady_clock::now().time_since_epoch().count());
+
+	const auto data = elf.to_vector<u8>();
+
+	if (fs::file(tmp, fs::rewrite).write(data.data(), data.size()) != data.size() || !fs::rename(tmp, path))
+	{
+		LOG_ERROR(LOADER, "SELF: Failed to save cache file %s (%s)", path, fs::g_tls_error);
+		fs::remove_file(tmp);
+		return;
+	}
+
+	LOG_NOTICE(LOADER, "SELF: Saved decrypted image to cache: %s", path);
+}
+
+extern fs::file decrypt_self(fs::file elf_or_self, bool use_cache)
 {
 	elf_or_self.seek(0);
 
 	// Check SELF header first. Check for a debug SELF.
 	if (elf_or_self.size() >= 4 && elf_or_self.read<u32>() == "SCE\0"_u32 && !CheckDebugSelf(elf_or_self))
 	{
+		std::string cache_path;
+
+		if (use_cache)
+		{
+			cache_path = get_self_cache_path(elf_or_self);
+
+			if (fs::file cached{cache_path})
+			{
+				LOG_NOTICE(LOADER, "SELF: Loaded decrypted image from cache: %s", cache_path);
+				return cached;
+			}
+		}
+
 		// Check the ELF file class (32 or 64 bit).
 		bool isElf32 = IsSelfElf32(elf_or_self);
 
@@ -1292,7 +1412,14 @@ extern fs::file decrypt_self(fs::file elf_or_self)
 		}
 		
 		// Make a new ELF file from this SELF.
-		return self_dec.MakeElf(isElf32);
+		fs::file elf = self_dec.MakeElf(isElf32);
+
+		if (!cache_path.empty())
+		{
+			save_self_cache(cache_path, elf);
+		}
+
+		return elf;
 	}
 
 	return elf_or_self;
@@ -388,4 +388,6 @@ public:
 	bool GetKeyFromRap(u8 *content_id, u8 *npdrm_key);
 };
 
-extern fs::file decrypt_self(fs::file elf_or_self);
+// Decrypt SELF file (other files are returned unmodified). Set use_cache for immutable files (firmware modules),
+// their decrypted images are saved on disk and loaded on next calls.
+extern fs::file decrypt_self(fs::file elf_or_self, bool use_cache = false);
@@ -41,6 +41,19 @@ public:
 	// Object associated with sleep state, possibly synchronization primitive (mutex, semaphore, etc.)
 	atomic_t<void*> owner{};
 
+	// Intrusive links of the sleep queue containing the thread (protected by the queue owner)
+	struct sleep_link
+	{
+		const void* queue; // Current queue (nullptr if not queued)
+		cpu_thread* prev; // Insertion order
+		cpu_thread* next;
+		cpu_thread* child; // Priority heap: first child
+		cpu_thread* left; // Priority heap: previous sibling or parent
+		cpu_thread* right; // Priority heap: next sibling
+		u64 key; // Priority heap: priority and insertion sequence
+		bool in_heap;
+	} sq_link{};
+
 	// Process thread state, return true if the checker must return
 	bool check_state();
 
@@ -1 +1,41 @@
+#ifdef LLVM_AVAILABLE
+
 #include "CPUTranslator.h"
+
+using namespace llvm;
+
+cpu_translator::cpu_translator(LLVMContext& context, Module* module, bool is_be)
+	: m_context(context)
+	, m_module(module)
+	, m_is_be(is_be)
+	, m_ir(nullptr)
+{
+}
+
+Value* cpu_translator::shuffle(Value* left, Value* right, ArrayRef<u32> indices)
+{
+	if (!right)
+	{
+		right = UndefValue::get(left->getType());
+	}
+
+	return m_ir->CreateShuffleVector(left, right, ConstantDataVector::get(m_context, indices));
+}
+
+Value* cpu_translator::byteswap(Value* value)
+{
+	const auto type = value->getType();
+	const u32 size = type->getPrimitiveSizeInBits() / 8;
+
+	std::vector<u32> indices(size);
+
+	for (u32 i = 0; i < size; i++)
+	{
+		indices[i] = size - 1 - i;
+	}
+
+	const auto bytes = m_ir->CreateBitCast(value, VectorType::get(get_type<u8>(), size));
+	return m_ir->CreateBitCast(shuffle(bytes, nullptr, indices), type);
+}
+
+#endif
@@ -1 +1,149 @@
 #pragma once
+
+#ifdef LLVM_AVAILABLE
+
+#include "restore_new.h"
+#ifdef _MSC_VER
+#pragma warning(push, 0)
+#endif
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Module.h"
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+#include "define_new_memleakdetect.h"
+
+#include "../Utilities/types.h"
+
+template<typename T, typename = void>
+struct TypeGen
+{
+	static_assert(!sizeof(T), "GetType<>() error: unknown type");
+};
+
+template<typename T>
+struct TypeGen<T, std::enable_if_t<std::is_void<T>::value>>
+{
+	static llvm::Type* get(llvm::LLVMContext& context) { return llvm::Type::getVoidTy(context); }
+};
+
+template<typename T>
+struct TypeGen<T, std::enable_if_t<std::is_same<T, s64>::value || std::is_same<T, u64>::value>>
+{
+	static llvm::Type* get(llvm::LLVMContext& context) { return llvm::Type::getInt64Ty(context); }
+};
+
+template<typename T>
+struct TypeGen<T, std::enable_if_t<std::is_same<T, s32>::value || std::is_same<T, u32>::value>>
+{
+	static llvm::Type* get(llvm::LLVMContext& context) { return llvm::Type::getInt32Ty(context); }
+};
+
+template<typename T>
+struct TypeGen<T, std::enable_if_t<std::is_same<T, s16>::value || std::is_same<T, u16>::value>>
+{
+	static llvm::Type* get(llvm::LLVMContext& context) { return llvm::Type::getInt16Ty(context); }
+};
+
+template<typename T>
+struct TypeGen<T, std::enable_if_t<std::is_same<T, s8>::value || std::is_same<T, u8>::value || std::is_same<T, char>::value>>
+{
+	static llvm::Type* get(llvm::LLVMContext& context) { return llvm::Type::getInt8Ty(context); }
+};
+
+template<>
+struct TypeGen<f32, void>
+{
+	static llvm::Type* get(llvm::LLVMContext& context) { return llvm::Type::getFloatTy(context); }
+};
+
+template<>
+struct TypeGen<f64, void>
+{
+	static llvm::Type* get(llvm::LLVMContext& context) { return llvm::Type::getDoubleTy(context); }
+};
+
+template<>
+struct TypeGen<bool, void>
+{
+	static llvm::Type* get(llvm::LLVMContext& context) { return llvm::Type::getInt1Ty(context); }
+};
+
+template<>
+struct TypeGen<u128, void>
+{
+	static llvm::Type* get(llvm::LLVMContext& context) { return llvm::Type::getIntNTy(context, 128); }
+};
+
+// Pointer type
+template<typename T>
+struct TypeGen<T*, void>
+{
+	static llvm::Type* get(llvm::LLVMContext& context) { return TypeGen<T>::get(context)->getPointerTo(); }
+};
+
+// Vector type
+template<typename T, int N>
+struct TypeGen<T[N], void>
+{
+	static llvm::Type* get(llvm::LLVMContext& context) { return llvm::VectorType::get(TypeGen<T>::get(context), N); }
+};
+
+// Common helpers for LLVM-based CPU translators
+class cpu_translator
+{
+protected:
+	cpu_translator(llvm::LLVMContext& context, llvm::Module* module, bool is_be);
+
+	// LLVM context
+	llvm::LLVMContext& m_context;
+
+	// Module to which all generated code is output to
+	llvm::Module* m_module;
+
+	// Endianness, affects vector element numbering
+	const bool m_is_be;
+
+	// IR builder
+	llvm::IRBuilder<>* m_ir;
+
+public:
+	// Convert a C++ type to an LLVM type
+	template<typename T>
+	llvm::Type* get_type()
+	{
+		return TypeGen<T>::get(m_context);
+	}
+
+	// Call a function (or an intrinsic) by name
+	template<typename... Args>
+	llvm::Value* call(llvm::Type* ret, llvm::StringRef name, Args... args)
+	{
+		return m_ir->CreateCall(m_module->getOrInsertFunction(name, llvm::FunctionType::get(ret, {args->getType()...}, false)), {args...});
+	}
+
+	// Call a host function by its address (never linked by name, argument types are taken from the values)
+	template<typename R, typename... FArgs, typename... Args>
+	llvm::Value* call(R(*func)(FArgs...), Args... args)
+	{
+		static_assert(sizeof...(FArgs) == sizeof...(Args), "call(): invalid number of arguments");
+		const auto type = llvm::FunctionType::get(get_type<R>(), {args->getType()...}, false);
+		return m_ir->CreateCall(m_ir->CreateIntToPtr(m_ir->getInt64((u64)func), type->getPointerTo()), {args...});
+	}
+
+	// Splat scalar constant to a vector of N elements
+	template<typename T, uint N>
+	llvm::Constant* splat(u64 value)
+	{
+		return llvm::ConstantVector::getSplat(N, llvm::ConstantInt::get(get_type<T>(), value));
+	}
+
+	// Create shuffle with constant indices (element 0 is the first element in the native order)
+	llvm::Value* shuffle(llvm::Value* left, llvm::Value* right, llvm::ArrayRef<u32> indices);
+
+	// Reverse byte order of all bytes in a vector (keeping its type)
+	llvm::Value* byteswap(llvm::Value* value);
+};
+
+#endif
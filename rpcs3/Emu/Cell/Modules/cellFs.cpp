@@ -7,8 +7,12 @@
 #include "cellFs.h"
 
 #include "Utilities/StrUtil.h"
+#include "Utilities/Config.h"
 
 #include <mutex>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace vm { using namespace ps3; }
 
@@ -698,12 +702,10 @@ s32 cellFsSdataOpenByFd(u32 mself_fd, s32 flags, vm::ptr<u32> sdata_fd, u64 offs
 
 using fs_aio_cb_t = vm::ptr<void(vm::ptr<CellFsAio> xaio, s32 error, s32 xid, u64 size)>;
 
-// temporarily
-struct lv2_fs_mount_point
-{
-	std::mutex mutex;
-};
+cfg::int_entry<1, 16> g_cfg_fs_aio_threads(cfg::root.vfs, "AIO worker threads", 2);
+cfg::int_entry<0, 0x1000000> g_cfg_fs_aio_readahead(cfg::root.vfs, "AIO read-ahead size", 0x40000);
 
+// Delivers AIO completion callbacks (guest code must be called from the PPU thread)
 struct fs_aio_thread : ppu_thread
 {
 	using ppu_thread::ppu_thread;
@@ -712,43 +714,374 @@ struct fs_aio_thread : ppu_thread
 	{
 		while (cmd64 cmd = cmd_wait())
 		{
-			const u32 type = cmd.arg1<u32>();
-			const s32 xid = cmd.arg2<s32>();
+			const auto aio = cmd.arg1<vm::ptr<CellFsAio>>();
+			const auto func = cmd.arg2<fs_aio_cb_t>();
 			const cmd64 cmd2 = cmd_get(1);
-			const auto aio = cmd2.arg1<vm::ptr<CellFsAio>>();
-			const auto func = cmd2.arg2<fs_aio_cb_t>();
-			cmd_pop(1);
+			const s32 xid = cmd2.arg1<s32>();
+			const s32 error = cmd2.arg2<s32>();
+			const u64 result = cmd_get(2).as<u64>();
+			cmd_pop(2);
+
+			func(*this, aio, error, xid, result);
+		}
+	}
+};
+
+struct fs_aio_request
+{
+	u32 type; // 1: read, 2: write
+	s32 xid;
+	vm::ptr<CellFsAio> aio;
+	fs_aio_cb_t func;
+
+	// Copied from CellFsAio at submission
+	u32 fd;
+	u64 offset;
+	vm::ptr<void> buf;
+	u64 size;
+};
+
+// Sequential access tracking and read-ahead buffer for a single fd
+struct fs_aio_stream
+{
+	std::weak_ptr<lv2_file> file;
+	u64 next = 0; // Expected offset of the next sequential read
+	u64 pos = 0; // File offset of the buffered data
+	std::vector<u8> data;
+	u64 write_gen = 0; // Write counter of the file when the data was read
+	bool eof = false; // Buffered data ends at the end of file
+};
+
+class fs_aio_manager
+{
+	// Max amount of data processed with a single native call
+	static constexpr u64 max_merge_size = 0x100000;
+
+	std::mutex m_mutex;
+	std::deque<fs_aio_request> m_queue;
+	std::unordered_set<u32> m_active; // Fds with requests being processed
+	std::unordered_map<u32, fs_aio_stream> m_streams;
+	std::vector<std::shared_ptr<thread_ctrl>> m_workers;
+	atomic_t<bool> m_exit{false};
+
+	// Take the next request on an fd which is not being processed, and the following requests on the fd which continue it (same operation)
+	std::vector<fs_aio_request> pop_batch()
+	{
+		std::vector<fs_aio_request> batch;
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		// Requests on the same fd are processed in submission order, by one worker at a time
+		auto it = std::find_if(m_queue.begin(), m_queue.end(), [&](const fs_aio_request& r)
+		{
+			return m_active.count(r.fd) == 0;
+		});
+
+		if (it == m_queue.end())
+		{
+			return batch;
+		}
+
+		batch.emplace_back(*it);
+		it = m_queue.erase(it);
+		m_active.emplace(batch[0].fd);
+
+		u64 end = batch[0].offset + batch[0].size;
+		u64 total = batch[0].size;
+
+		while (it != m_queue.end() && total < max_merge_size)
+		{
+			if (it->fd != batch[0].fd)
+			{
+				it++;
+				continue;
+			}
+
+			// Stop at the first request on the fd which can't be merged
+			if (it->type != batch[0].type || it->offset != end || total + it->size > max_merge_size)
+			{
+				break;
+			}
+
+			end += it->size;
+			total += it->size;
+			batch.emplace_back(*it);
+			it = m_queue.erase(it);
+		}
+
+		return batch;
+	}
+
+	// Allow processing of the next requests on the fd
+	void release(u32 fd)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_active.erase(fd);
+
+			if (m_queue.empty())
+			{
+				return;
+			}
+		}
+
+		for (const auto& worker : m_workers)
+		{
+			worker->notify();
+		}
+	}
+
+	// Try to complete read requests from the read-ahead buffer
+	bool read_buffered(const std::shared_ptr<lv2_file>& file, const std::vector<fs_aio_request>& batch, std::vector<u64>& results)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		const auto found = m_streams.find(batch[0].fd);
+
+		if (found == m_streams.end() || found->second.file.lock() != file)
+		{
+			return false;
+		}
+
+		auto& s = found->second;
+
+		if (s.write_gen != file->write_gen)
+		{
+			// The file was written (possibly through another fd)
+			s.data.clear();
+			s.eof = false;
+			return false;
+		}
+
+		const u64 begin = batch[0].offset;
+		const u64 end = batch.back().offset + batch.back().size;
+
+		if (begin < s.pos || begin > s.pos + s.data.size() || (end > s.pos + s.data.size() && !s.eof))
+		{
+			return false;
+		}
+
+		for (std::size_t i = 0; i < batch.size(); i++)
+		{
+			const u64 off = batch[i].offset - s.pos;
+			results[i] = off < s.data.size() ? std::min<u64>(batch[i].size, s.data.size() - off) : 0;
+			std::memcpy(batch[i].buf.get_ptr(), s.data.data() + off, results[i]);
+		}
+
+		return true;
+	}
+
+	// Track sequential reading and refill the read-ahead buffer when it runs low
+	void read_ahead(const std::shared_ptr<lv2_file>& file, u32 fd, u64 begin, u64 end)
+	{
+		const u64 size = g_cfg_fs_aio_readahead;
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+
+		auto& s = m_streams[fd];
+
+		if (s.file.lock() != file)
+		{
+			s = {};
+			s.file = file;
+		}
+
+		// Get the write counter before reading, so that a concurrent write invalidates the data
+		const u64 write_gen = file->write_gen;
+
+		if (s.write_gen != write_gen)
+		{
+			s.data.clear();
+			s.eof = false;
+		}
+
+		const bool sequential = std::exchange(s.next, end) == begin;
+
+		const u64 cached_end = s.pos + s.data.size();
+
+		if (!size || !sequential || (s.eof && end <= cached_end) || (end >= s.pos && cached_end >= end + size / 2))
+		{
+			return;
+		}
+
+		// Keep unread data, read the rest of the window
+		std::vector<u8> data;
+
+		if (end >= s.pos && end < cached_end)
+		{
+			data.assign(s.data.begin() + (end - s.pos), s.data.end());
+		}
+
+		const u64 read_pos = end + data.size();
+		const u64 keep = data.size();
+
+		// The stream is only used by the worker processing the fd
+		lock.unlock();
+
+		data.resize(std::max<u64>(size, keep));
+		const u64 count = data.size() > keep ? file->file.read_at(read_pos, data.data() + keep, data.size() - keep) : 0;
+		const bool eof = keep + count < data.size();
+		data.resize(keep + count);
+
+		lock.lock();
+
+		auto& s2 = m_streams[fd];
+
+		if (s2.file.lock() == file)
+		{
+			s2.pos = end;
+			s2.data = std::move(data);
+			s2.write_gen = write_gen;
+			s2.eof = eof;
+		}
+	}
 
-			s32 error = CELL_OK;
-			u64 result = 0;
+	void process(fs_aio_thread& ppu, const std::vector<fs_aio_request>& batch)
+	{
+		const auto& first = batch[0];
+		const auto file = idm::get<lv2_fs_object, lv2_file>(first.fd);
 
-			const auto file = idm::get<lv2_fs_object, lv2_file>(aio->fd);
+		s32 error = CELL_OK;
+		std::vector<u64> results(batch.size());
 
-			if (!file || (type == 1 && file->flags & CELL_FS_O_WRONLY) || (type == 2 && !(file->flags & CELL_FS_O_ACCMODE)))
+		if (!file || (first.type == 1 && file->flags & CELL_FS_O_WRONLY) || (first.type == 2 && !(file->flags & CELL_FS_O_ACCMODE)))
+		{
+			error = CELL_EBADF;
+		}
+		else if (first.type == 1 && (file->flags & CELL_FS_O_ACCMODE) == CELL_FS_O_RDONLY && read_buffered(file, batch, results))
+		{
+		}
+		else if (batch.size() == 1)
+		{
+			results[0] = first.type == 2
+				? file->op_write_at(first.offset, first.buf, first.size)
+				: file->op_read_at(first.offset, first.buf, first.size);
+		}
+		else
+		{
+			bool contiguous = true;
+
+			for (std::size_t i = 1; i < batch.size(); i++)
 			{
-				error = CELL_EBADF;
+				contiguous = contiguous && batch[i].buf.addr() == batch[i - 1].buf.addr() + batch[i - 1].size;
+			}
+
+			const u64 total = batch.back().offset + batch.back().size - first.offset;
+			u64 count;
+
+			if (contiguous)
+			{
+				// Single native call on the whole guest memory range
+				count = first.type == 2
+					? file->op_write_at(first.offset, first.buf, total)
+					: file->op_read_at(first.offset, first.buf, total);
+			}
+			else if (first.type == 2)
+			{
+				// Gather data and write it at once
+				std::unique_ptr<u8[]> data(new u8[total]);
+
+				for (const auto& r : batch)
+				{
+					std::memcpy(data.get() + (r.offset - first.offset), r.buf.get_ptr(), r.size);
+				}
+
+				count = file->file.write_at(first.offset, data.get(), total);
+				file->write_gen++;
 			}
 			else
 			{
-				std::lock_guard<std::mutex> lock(file->mp->mutex);
+				// Read data at once and scatter it
+				std::unique_ptr<u8[]> data(new u8[total]);
 
-				const auto old_pos = file->file.pos(); file->file.seek(aio->offset);
+				count = file->file.read_at(first.offset, data.get(), total);
 
-				result = type == 2
-					? file->op_write(aio->buf, aio->size)
-					: file->op_read(aio->buf, aio->size);
+				for (const auto& r : batch)
+				{
+					const u64 off = r.offset - first.offset;
+					std::memcpy(r.buf.get_ptr(), data.get() + off, off < count ? std::min<u64>(r.size, count - off) : 0);
+				}
+			}
 
-				file->file.seek(old_pos);
+			for (std::size_t i = 0; i < batch.size(); i++)
+			{
+				const u64 off = batch[i].offset - first.offset;
+				results[i] = off < count ? std::min<u64>(batch[i].size, count - off) : 0;
 			}
+		}
 
-			func(*this, aio, error, xid, result);
+		for (std::size_t i = 0; i < batch.size(); i++)
+		{
+			ppu.cmd_list
+			({
+				{ batch[i].aio, batch[i].func },
+				{ batch[i].xid, error },
+				{ results[i] },
+			});
+		}
+
+		ppu.notify();
+
+		if (!error && first.type == 1 && (file->flags & CELL_FS_O_ACCMODE) == CELL_FS_O_RDONLY)
+		{
+			read_ahead(file, first.fd, first.offset, batch.back().offset + batch.back().size);
 		}
 	}
-};
 
-struct fs_aio_manager
-{
+public:
 	std::shared_ptr<fs_aio_thread> thread;
+
+	void start()
+	{
+		thread = idm::make_ptr<ppu_thread, fs_aio_thread>("FS AIO Thread", 500);
+		thread->run();
+
+		m_workers.resize(g_cfg_fs_aio_threads);
+
+		for (u32 i = 0; i < m_workers.size(); i++)
+		{
+			thread_ctrl::spawn(m_workers[i], fmt::format("FS AIO Worker %u", i), [this]()
+			{
+				while (!m_exit && !Emu.IsStopped())
+				{
+					const auto batch = pop_batch();
+
+					if (batch.empty())
+					{
+						thread_ctrl::wait();
+						continue;
+					}
+
+					process(*thread, batch);
+					release(batch[0].fd);
+				}
+			});
+		}
+	}
+
+	void push(const fs_aio_request& request)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_queue.emplace_back(request);
+		}
+
+		for (const auto& worker : m_workers)
+		{
+			worker->notify();
+		}
+	}
+
+	~fs_aio_manager()
+	{
+		m_exit = true;
+
+		for (const auto& worker : m_workers)
+		{
+			worker->notify();
+			worker->join();
+		}
+	}
 };
 
 s32 cellFsAioInit(vm::cptr<char> mount_point)
@@ -760,8 +1093,7 @@ s32 cellFsAioInit(vm::cptr<char> mount_point)
 
 	if (m)
 	{
-		m->thread = idm::make_ptr<ppu_thread, fs_aio_thread>("FS AIO Thread", 500);
-		m->thread->run();
+		m->start();
 	}
 
 	return CELL_OK;
@@ -778,10 +1110,8 @@ s32 cellFsAioFinish(vm::cptr<char> mount_point)
 
 atomic_t<s32> g_fs_aio_id;
 
-s32 cellFsAioRead(vm::ptr<CellFsAio> aio, vm::ptr<s32> id, fs_aio_cb_t func)
+static s32 fs_aio_submit(u32 type, vm::ptr<CellFsAio> aio, vm::ptr<s32> id, fs_aio_cb_t func)
 {
-	cellFs.warning("cellFsAioRead(aio=*0x%x, id=*0x%x, func=*0x%x)", aio, id, func);
-
 	// TODO: detect mount point and send AIO request to the AIO thread of this mount point
 
 	const auto m = fxm::get<fs_aio_manager>();
@@ -793,41 +1123,23 @@ s32 cellFsAioRead(vm::ptr<CellFsAio> aio, vm::ptr<s32> id, fs_aio_cb_t func)
 
 	const s32 xid = (*id = ++g_fs_aio_id);
 
-	m->thread->cmd_list
-	({
-		{ 1, xid },
-		{ aio, func },
-	});
-
-	m->thread->notify();
+	m->push({ type, xid, aio, func, aio->fd, aio->offset, vm::cast(aio->buf.addr()), aio->size });
 
 	return CELL_OK;
 }
 
-s32 cellFsAioWrite(vm::ptr<CellFsAio> aio, vm::ptr<s32> id, fs_aio_cb_t func)
+s32 cellFsAioRead(vm::ptr<CellFsAio> aio, vm::ptr<s32> id, fs_aio_cb_t func)
 {
-	cellFs.warning("cellFsAioWrite(aio=*0x%x, id=*0x%x, func=*0x%x)", aio, id, func);
-
-	// TODO: detect mount point and send AIO request to the AIO thread of this mount point
-
-	const auto m = fxm::get<fs_aio_manager>();
-
-	if (!m)
-	{
-		return CELL_ENXIO;
-	}
-
-	const s32 xid = (*id = ++g_fs_aio_id);
+	cellFs.warning("cellFsAioRead(aio=*0x%x, id=*0x%x, func=*0x%x)", aio, id, func);
 
-	m->thread->cmd_list
-	({
-		{ 2, xid },
-		{ aio, func },
-	});
+	return fs_aio_submit(1, aio, id, func);
+}
 
-	m->thread->notify();
+s32 cellFsAioWrite(vm::ptr<CellFsAio> aio, vm::ptr<s32> id, fs_aio_cb_t func)
+{
+	cellFs.warning("cellFsAioWrite(aio=*0x%x, id=*0x%x, func=*0x%x)", aio, id, func);
 
-	return CELL_OK;
+	return fs_aio_submit(2, aio, id, func);
 }
 
 s32 cellFsAioCancel(s32 id)
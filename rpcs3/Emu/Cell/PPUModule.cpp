@@ -1121,7 +1121,7 @@ void ppu_load_exec(const ppu_exec_object& elf)
 
 	if (g_cfg_load_liblv2)
 	{
-		const ppu_prx_object obj = decrypt_self(fs::file(lle_dir + "/liblv2.sprx"));
+		const ppu_prx_object obj = decrypt_self(fs::file(lle_dir + "/liblv2.sprx"), true);
 
 		if (obj == elf_error::ok)
 		{
@@ -1136,7 +1136,7 @@ void ppu_load_exec(const ppu_exec_object& elf)
 	{
 		for (const auto& name : g_cfg_load_libs.get_set())
 		{
-			const ppu_prx_object obj = decrypt_self(fs::file(lle_dir + '/' + name));
+			const ppu_prx_object obj = decrypt_self(fs::file(lle_dir + '/' + name), true);
 
 			if (obj == elf_error::ok)
 			{
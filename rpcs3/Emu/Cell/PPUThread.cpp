@@ -41,9 +41,11 @@
 #include "Utilities/JIT.h"
 #include "PPUTranslator.h"
 #include "Modules/cellMsgDialog.h"
+#include "Crypto/sha1.h"
 #endif
 
 #include <cfenv>
+#include <thread>
 #include "Utilities/GSL.h"
 
 extern u64 get_system_time();
@@ -68,6 +70,16 @@ const ppu_decoder<ppu_interpreter_precise> s_ppu_interpreter_precise;
 const ppu_decoder<ppu_interpreter_fast> s_ppu_interpreter_fast;
 
 static void ppu_initialize();
+
+#ifdef LLVM_AVAILABLE
+// Translator version (must be increased after changes affecting generated code, invalidates object cache)
+static const u32 s_ppu_llvm_version = 1;
+
+// Amount of separately compiled and cached shards
+static const u32 s_ppu_llvm_shards = 16;
+
+static bool ppu_initialize2(jit_compiler& jit, const std::vector<ppu_function>& funcs, std::size_t start, std::size_t end, const std::string& obj_path, const std::function<void(std::size_t)>& progress);
+#endif
 extern void ppu_execute_syscall(ppu_thread& ppu, u64 code);
 extern void ppu_execute_function(ppu_thread& ppu, u32 index);
 
@@ -694,21 +706,257 @@ static void ppu_initialize()
 #ifdef LLVM_AVAILABLE
 	using namespace llvm;
 
+	// Link all known syscalls and HLE functions (cached object files may refer to any of them)
+	for (u32 i = 0; i < 1024; i++)
+	{
+		if (const auto ptr = ppu_get_syscall(i))
+		{
+			link_table.emplace(ppu_get_syscall_name(i), reinterpret_cast<std::uintptr_t>(ptr));
+		}
+	}
+
+	for (u32 i = 0, max = ::size32(ppu_function_manager::get()); i < max; i++)
+	{
+		if (const auto ptr = ppu_get_function(i))
+		{
+			link_table.emplace(ppu_get_module_function_name(i), reinterpret_cast<std::uintptr_t>(ptr));
+		}
+	}
+
+	const auto jit = fxm::make<jit_compiler>(std::move(link_table));
+
+	if (!jit)
+	{
+		LOG_FATAL(PPU, "LLVM: Multiple modules are not yet supported");
+		return;
+	}
+
+	// Calculate cache key: translator version, target CPU and code model, HLE function names and all executable code.
+	// The memory base address isn't embedded (it's loaded from __mptr), so it isn't a part of the key.
+	u8 hash[20];
+	{
+		sha1_context ctx;
+		sha1_starts(&ctx);
+
+		const std::string version = fmt::format("PPU LLVM v%u (%s, code model %d)", s_ppu_llvm_version, jit->cpu(), static_cast<int>(jit->code_model()));
+		sha1_update(&ctx, reinterpret_cast<const u8*>(version.data()), version.size() + 1);
+
+		for (u32 i = 0, max = ::size32(ppu_function_manager::get()); i < max; i++)
+		{
+			const std::string name = ppu_get_module_function_name(i);
+			sha1_update(&ctx, reinterpret_cast<const u8*>(name.data()), name.size() + 1);
+		}
+
+		for (const auto& info : *_funcs)
+		{
+			const u32 header[3]{info.addr, info.size, info.toc};
+			sha1_update(&ctx, reinterpret_cast<const u8*>(header), sizeof(header));
+
+			for (const auto& b : info.blocks)
+			{
+				const u32 block[2]{b.first, b.second};
+				sha1_update(&ctx, reinterpret_cast<const u8*>(block), sizeof(block));
+			}
+
+			sha1_update(&ctx, vm::_ptr<const u8>(info.addr), info.size);
+		}
+
+		sha1_finish(&ctx, hash);
+	}
+
+	const std::string cache_path = fmt::format("%sdata/cache/ppu-%016llx%08x/", fs::get_config_dir(), reinterpret_cast<be_t<u64>&>(hash[0]), reinterpret_cast<be_t<u32>&>(hash[8]));
+
+	if (!fs::is_dir(cache_path) && !fs::create_path(cache_path))
+	{
+		LOG_ERROR(PPU, "LLVM: Failed to create cache directory %s (%s)", cache_path, fs::g_tls_error);
+	}
+
+	// Split function list into shards of similar code size (must be deterministic for the cache)
+	std::vector<std::pair<std::size_t, std::size_t>> shards;
+	{
+		u64 total = 0;
+
+		for (const auto& info : *_funcs)
+		{
+			total += info.size;
+		}
+
+		u64 part = 0;
+
+		for (std::size_t i = 0, start = 0; i < _funcs->size(); i++)
+		{
+			part += _funcs->at(i).size;
+
+			if (part * s_ppu_llvm_shards >= total || i + 1 == _funcs->size())
+			{
+				shards.emplace_back(start, i + 1);
+				start = i + 1;
+				part = 0;
+			}
+		}
+	}
+
+	// Show message dialog only if some shard isn't cached
+	std::shared_ptr<MsgDialogBase> dlg;
+
+	for (std::size_t si = 0; si < shards.size(); si++)
+	{
+		if (!fs::is_file(fmt::format("%s%02u.obj", cache_path, si)))
+		{
+			dlg = Emu.GetCallbacks().get_msg_dialog();
+			break;
+		}
+	}
+
+	if (dlg)
+	{
+		dlg->type.se_normal = true;
+		dlg->type.bg_invisible = true;
+		dlg->type.progress_bar_count = 1;
+		dlg->on_close = [](s32 status)
+		{
+			Emu.CallAfter([]()
+			{
+				// Abort everything
+				Emu.Stop();
+			});
+		};
+
+		Emu.CallAfter([=]()
+		{
+			dlg->Create("Recompiling PPU executable.\nPlease wait...");
+		});
+	}
+
+	atomic_t<std::size_t> shard_index{0};
+	atomic_t<std::size_t> fdone{0};
+	atomic_t<bool> failed{false};
+
+	// Update dialog after processing some functions
+	const auto progress = [&, max = _funcs->size()](std::size_t count)
+	{
+		const std::size_t fi = fdone.fetch_add(count);
+
+		if (!dlg)
+		{
+			return;
+		}
+
+		Emu.CallAfter([=]()
+		{
+			dlg->ProgressBarSetMsg(0, fmt::format("Compiling %u of %u", fi + count, max));
+
+			if (fi * 100 / max != (fi + count) * 100 / max)
+				dlg->ProgressBarInc(0, ::narrow<u32>((fi + count) * 100 / max - fi * 100 / max));
+		});
+	};
+
+	// Worker pool (one LLVMContext per shard)
+	std::vector<std::shared_ptr<thread_ctrl>> workers(std::max<std::size_t>(std::min<std::size_t>(std::thread::hardware_concurrency(), shards.size()), 1));
+
+	for (std::size_t i = 0; i < workers.size(); i++)
+	{
+		thread_ctrl::spawn(workers[i], fmt::format("PPU LLVM Worker %u", i), [&]()
+		{
+			for (std::size_t si; (si = shard_index++) < shards.size();)
+			{
+				if (Emu.IsStopped() || failed)
+				{
+					return;
+				}
+
+				const std::string obj_path = fmt::format("%s%02u.obj", cache_path, si);
+
+				if (jit->add(obj_path))
+				{
+					LOG_NOTICE(PPU, "LLVM: Loaded cached shard %s", obj_path);
+					progress(shards[si].second - shards[si].first);
+					continue;
+				}
+
+				if (!ppu_initialize2(*jit, *_funcs, shards[si].first, shards[si].second, obj_path, progress))
+				{
+					// Other shards would refer to missing functions
+					failed = true;
+					return;
+				}
+			}
+		});
+	}
+
+	for (const auto& worker : workers)
+	{
+		worker->join();
+	}
+
+	if (failed)
+	{
+		LOG_FATAL(PPU, "LLVM: Compilation failed, emulation stopped");
+
+		Emu.CallAfter([]()
+		{
+			Emu.Stop();
+		});
+
+		return;
+	}
+
+	if (Emu.IsStopped())
+	{
+		LOG_SUCCESS(PPU, "LLVM: Translation cancelled");
+		return;
+	}
+
+	// Update dialog
+	if (dlg)
+	{
+		Emu.CallAfter([=]()
+		{
+			dlg->ProgressBarSetMsg(0, "Linking...");
+		});
+	}
+
+	jit->fin();
+
+	// Get and install function addresses
+	for (const auto& info : *_funcs)
+	{
+		if (info.size)
+		{
+			const std::uintptr_t link = jit->get(fmt::format("__0x%x", info.addr));
+			s_ppu_compiled[info.addr / 4] = ::narrow<u32>(link);
+
+			LOG_TRACE(PPU, "** Function __0x%x -> 0x%llx (size=0x%x, toc=0x%x, attr %#x)", info.addr, link, info.size, info.toc, info.attr);
+		}
+	}
+
+	LOG_SUCCESS(PPU, "LLVM: Compilation finished (%s, %zu shards)", jit->cpu(), shards.size());
+#endif
+}
+
+#ifdef LLVM_AVAILABLE
+static bool ppu_initialize2(jit_compiler& jit, const std::vector<ppu_function>& funcs, std::size_t start, std::size_t end, const std::string& obj_path, const std::function<void(std::size_t)>& progress)
+{
+	using namespace llvm;
+
+	// Every shard has its own context, so it can be compiled concurrently
+	LLVMContext context;
+
 	// Create LLVM module
-	std::unique_ptr<Module> module = std::make_unique<Module>("", g_llvm_ctx);
+	std::unique_ptr<Module> module = std::make_unique<Module>(obj_path, context);
 
 	// Initialize target
 	module->setTargetTriple(Triple::normalize(sys::getProcessTriple()));
 	
 	// Initialize translator
-	std::unique_ptr<PPUTranslator> translator = std::make_unique<PPUTranslator>(g_llvm_ctx, module.get(), 0);
+	std::unique_ptr<PPUTranslator> translator = std::make_unique<PPUTranslator>(context, module.get(), 0);
 
 	// Define some types
-	const auto _void = Type::getVoidTy(g_llvm_ctx);
+	const auto _void = Type::getVoidTy(context);
 	const auto _func = FunctionType::get(_void, { translator->GetContextType()->getPointerTo() }, false);
 
-	// Initialize function list
-	for (const auto& info : *_funcs)
+	// Initialize function list (functions from other shards are linked by name)
+	for (const auto& info : funcs)
 	{
 		if (info.size)
 		{
@@ -748,47 +996,18 @@ static void ppu_initialize()
 	pm.add(createCFGSimplificationPass());
 	//pm.add(createLintPass()); // Check
 
-	// Initialize message dialog
-	const auto dlg = Emu.GetCallbacks().get_msg_dialog();
-	dlg->type.se_normal = true;
-	dlg->type.bg_invisible = true;
-	dlg->type.progress_bar_count = 1;
-	dlg->on_close = [](s32 status)
-	{
-		Emu.CallAfter([]()
-		{
-			// Abort everything
-			Emu.Stop();
-		});
-	};
-
-	Emu.CallAfter([=]()
-	{
-		dlg->Create("Recompiling PPU executable.\nPlease wait...");
-	});
-
 	// Translate functions
-	for (size_t fi = 0; fi < _funcs->size(); fi++)
+	for (std::size_t fi = start; fi < end; fi++)
 	{
 		if (Emu.IsStopped())
 		{
-			LOG_SUCCESS(PPU, "LLVM: Translation cancelled");
-			return;
+			return true;
 		}
 
-		auto& info = _funcs->at(fi);
+		const auto& info = funcs[fi];
 
 		if (info.size)
 		{
-			// Update dialog
-			Emu.CallAfter([=, max = _funcs->size()]()
-			{
-				dlg->ProgressBarSetMsg(0, fmt::format("Compiling %u of %u", fi + 1, max));
-
-				if (fi * 100 / max != (fi + 1) * 100 / max)
-					dlg->ProgressBarInc(0, 1);
-			});
-
 			// Translate
 			const auto func = translator->TranslateToIR(info, vm::_ptr<u32>(info.addr));
 
@@ -812,11 +1031,10 @@ static void ppu_initialize()
 						// Try to determine syscall using the value from r11 (requires constant propagation)
 						const u64 index = cast<ConstantInt>(op1)->getZExtValue();
 
-						if (const auto ptr = ppu_get_syscall(index))
+						if (ppu_get_syscall(index))
 						{
 							const auto n = ppu_get_syscall_name(index);
 							const auto f = cast<Function>(module->getOrInsertFunction(n, _func));
-							link_table.emplace(n, reinterpret_cast<std::uintptr_t>(ptr));
 
 							// Call the syscall directly
 							ReplaceInstWithInst(ci, CallInst::Create(f, {ci->getArgOperand(0)}));
@@ -827,11 +1045,10 @@ static void ppu_initialize()
 					{
 						const u32 index = static_cast<u32>(cast<ConstantInt>(op1)->getZExtValue());
 
-						if (const auto ptr = ppu_get_function(index))
+						if (ppu_get_function(index))
 						{
 							const auto n = ppu_get_module_function_name(index);
 							const auto f = cast<Function>(module->getOrInsertFunction(n, _func));
-							link_table.emplace(n, reinterpret_cast<std::uintptr_t>(ptr));
 
 							// Call the function directly
 							ReplaceInstWithInst(ci, CallInst::Create(f, {ci->getArgOperand(0)}));
@@ -876,53 +1093,24 @@ static void ppu_initialize()
 	mpm.add(createDeadInstEliminationPass());
 	mpm.run(*module);
 
-	// Update dialog
-	Emu.CallAfter([=]()
-	{
-		dlg->ProgressBarSetMsg(0, "Generating code...");
-		dlg->ProgressBarInc(0, 100);
-	});
-
 	std::string result;
 	raw_string_ostream out(result);
 
-	out << *module; // print IR
-	fs::file(fs::get_config_dir() + "LLVM.log", fs::rewrite)
-		.write(out.str());
-
-	result.clear();
-
 	if (verifyModule(*module, &out))
 	{
 		out.flush();
-		LOG_ERROR(PPU, "LLVM: Translation failed:\n%s", result);
-		return;
+		LOG_ERROR(PPU, "LLVM: Translation failed (%s):\n%s", obj_path, result);
+		return false;
 	}
 
-	LOG_SUCCESS(PPU, "LLVM: %zu functions generated", module->getFunctionList().size());
+	LOG_NOTICE(PPU, "LLVM: %zu functions generated (%s)", module->getFunctionList().size(), obj_path);
 
-	Module* module_ptr = module.get();
+	// Free translator data before generating code
+	translator.reset();
 
-	const auto jit = fxm::make<jit_compiler>(std::move(module), std::move(link_table));
-
-	if (!jit)
-	{
-		LOG_FATAL(PPU, "LLVM: Multiple modules are not yet supported");
-		return;
-	}
+	jit.add(std::move(module), obj_path);
 
-	// Get and install function addresses
-	for (const auto& info : *_funcs)
-	{
-		if (info.size)
-		{
-			const std::uintptr_t link = jit->get(fmt::format("__0x%x", info.addr));
-			s_ppu_compiled[info.addr / 4] = ::narrow<u32>(link);
-
-			LOG_TRACE(PPU, "** Function __0x%x -> 0x%llx (size=0x%x, toc=0x%x, attr %#x)", info.addr, link, info.size, info.toc, info.attr);
-		}
-	}
-
-	LOG_SUCCESS(PPU, "LLVM: Compilation finished (%s)", sys::getHostCPUName().data());
-#endif
+	progress(end - start);
+	return true;
 }
+#endif
@@ -8,6 +8,7 @@
 #include <set>
 #include <array>
 
+#include "../rpcs3/Emu/CPU/CPUTranslator.h"
 #include "../rpcs3/Emu/Cell/PPUOpcodes.h"
 #include "../rpcs3/Emu/Cell/PPUAnalyser.h"
 
@@ -27,80 +28,6 @@
 #include "../Utilities/StrFmt.h"
 #include "../Utilities/BEType.h"
 
-template<typename T, typename = void>
-struct TypeGen
-{
-	static_assert(!sizeof(T), "GetType<>() error: unknown type");
-};
-
-template<typename T>
-struct TypeGen<T, std::enable_if_t<std::is_void<T>::value>>
-{
-	static llvm::Type* get(llvm::LLVMContext& context) { return llvm::Type::getVoidTy(context); }
-};
-
-template<typename T>
-struct TypeGen<T, std::enable_if_t<std::is_same<T, s64>::value || std::is_same<T, u64>::value>>
-{
-	static llvm::Type* get(llvm::LLVMContext& context) { return llvm::Type::getInt64Ty(context); }
-};
-
-template<typename T>
-struct TypeGen<T, std::enable_if_t<std::is_same<T, s32>::value || std::is_same<T, u32>::value>>
-{
-	static llvm::Type* get(llvm::LLVMContext& context) { return llvm::Type::getInt32Ty(context); }
-};
-
-template<typename T>
-struct TypeGen<T, std::enable_if_t<std::is_same<T, s16>::value || std::is_same<T, u16>::value>>
-{
-	static llvm::Type* get(llvm::LLVMContext& context) { return llvm::Type::getInt16Ty(context); }
-};
-
-template<typename T>
-struct TypeGen<T, std::enable_if_t<std::is_same<T, s8>::value || std::is_same<T, u8>::value || std::is_same<T, char>::value>>
-{
-	static llvm::Type* get(llvm::LLVMContext& context) { return llvm::Type::getInt8Ty(context); }
-};
-
-template<>
-struct TypeGen<f32, void>
-{
-	static llvm::Type* get(llvm::LLVMContext& context) { return llvm::Type::getFloatTy(context); }
-};
-
-template<>
-struct TypeGen<f64, void>
-{
-	static llvm::Type* get(llvm::LLVMContext& context) { return llvm::Type::getDoubleTy(context); }
-};
-
-template<>
-struct TypeGen<bool, void>
-{
-	static llvm::Type* get(llvm::LLVMContext& context) { return llvm::Type::getInt1Ty(context); }
-};
-
-template<>
-struct TypeGen<u128, void>
-{
-	static llvm::Type* get(llvm::LLVMContext& context) { return llvm::Type::getIntNTy(context, 128); }
-};
-
-// Pointer type
-template<typename T>
-struct TypeGen<T*, void>
-{
-	static llvm::Type* get(llvm::LLVMContext& context) { return TypeGen<T>::get(context)->getPointerTo(); }
-};
-
-// Vector type
-template<typename T, int N>
-struct TypeGen<T[N], void>
-{
-	static llvm::Type* get(llvm::LLVMContext& context) { return llvm::VectorType::get(TypeGen<T>::get(context), N); }
-};
-
 class PPUTranslator final //: public CPUTranslator
 {
 	// LLVM context
@@ -88,6 +88,8 @@ bool RawSPUThread::write_reg(const u32 addr, const u32 value)
 	{
 		if (!status.test_and_set(SPU_STATUS_RUNNING))
 		{
+			// LS may have been written directly by PPU
+			mark_ls_dirty(0, 0x40000);
 			run();
 		}
 	};
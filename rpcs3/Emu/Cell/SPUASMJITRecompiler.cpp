@@ -261,39 +261,8 @@ inline asmjit::X86Mem spu_recompiler::XmmConst(__m128i data)
 
 void spu_recompiler::InterpreterCall(spu_opcode_t op)
 {
-	auto gate = [](SPUThread* _spu, u32 opcode, spu_inter_func_t _func) noexcept -> u32
-	{
-		try
-		{
-			// TODO: check correctness
-
-			const u32 old_pc = _spu->pc;
-
-			if (test(_spu->state) && _spu->check_state())
-			{
-				return 0x2000000 | _spu->pc;
-			}
-
-			_func(*_spu, { opcode });
-
-			if (old_pc != _spu->pc)
-			{
-				_spu->pc += 4;
-				return 0x2000000 | _spu->pc;
-			}
-
-			_spu->pc += 4;
-			return 0;
-		}
-		catch (...)
-		{
-			_spu->pending_exception = std::current_exception();
-			return 0x1000000 | _spu->pc;
-		}
-	};
-
 	c->mov(SPU_OFF_32(pc), m_pos);
-	asmjit::X86CallNode* call = c->call(asmjit::imm_ptr(asmjit_cast<void*, u32(SPUThread*, u32, spu_inter_func_t)>(gate)), asmjit::kFuncConvHost, asmjit::FuncBuilder3<u32, void*, u32, void*>());
+	asmjit::X86CallNode* call = c->call(asmjit::imm_ptr(asmjit_cast<void*>(&spu_recompiler_base::interpreter_gate)), asmjit::kFuncConvHost, asmjit::FuncBuilder3<u32, void*, u32, void*>());
 	call->setArg(0, *cpu);
 	call->setArg(1, asmjit::imm_u(op.opcode));
 	call->setArg(2, asmjit::imm_ptr(asmjit_cast<void*>(s_spu_interpreter.decode(op.opcode))));
@@ -307,69 +276,7 @@ void spu_recompiler::InterpreterCall(spu_opcode_t op)
 
 void spu_recompiler::FunctionCall()
 {
-	auto gate = [](SPUThread* _spu, u32 link) noexcept -> u32
-	{
-		_spu->recursion_level++;
-
-		try
-		{
-			// TODO: check correctness
-
-			if (_spu->pc & 0x4000000)
-			{
-				if (_spu->pc & 0x8000000)
-				{
-					fmt::throw_exception("Undefined behaviour" HERE);
-				}
-
-				_spu->set_interrupt_status(true);
-				_spu->pc &= ~0x4000000;
-			}
-			else if (_spu->pc & 0x8000000)
-			{
-				_spu->set_interrupt_status(false);
-				_spu->pc &= ~0x8000000;
-			}
-
-			if (_spu->pc == link)
-			{
-				LOG_ERROR(SPU, "Branch-to-next");
-			}
-			else if (_spu->pc == link - 4)
-			{
-				LOG_ERROR(SPU, "Branch-to-self");
-			}
-
-			while (!test(_spu->state) || !_spu->check_state())
-			{
-				// Proceed recursively
-				spu_recompiler_base::enter(*_spu);
-
-				if (test(_spu->state & cpu_flag::ret))
-				{
-					break;
-				}
-
-				if (_spu->pc == link)
-				{
-					_spu->recursion_level--;
-					return 0; // Successfully returned 
-				}
-			}
-
-			_spu->recursion_level--;
-			return 0x2000000 | _spu->pc;
-		}
-		catch (...)
-		{
-			_spu->pending_exception = std::current_exception();
-
-			_spu->recursion_level--;
-			return 0x1000000 | _spu->pc;
-		}
-	};
-
-	asmjit::X86CallNode* call = c->call(asmjit::imm_ptr(asmjit_cast<void*, u32(SPUThread*, u32)>(gate)), asmjit::kFuncConvHost, asmjit::FuncBuilder2<u32, SPUThread*, u32>());
+	asmjit::X86CallNode* call = c->call(asmjit::imm_ptr(asmjit_cast<void*>(&spu_recompiler_base::function_gate)), asmjit::kFuncConvHost, asmjit::FuncBuilder2<u32, SPUThread*, u32>());
 	call->setArg(0, *cpu);
 	call->setArg(1, asmjit::imm_u(spu_branch_target(m_pos + 4)));
 	call->setRet(0, *addr);
@@ -392,7 +299,7 @@ void spu_recompiler::LNOP(spu_opcode_t op)
 void spu_recompiler::SYNC(spu_opcode_t op)
 {
 	// This instruction must be used following a store instruction that modifies the instruction stream.
-	c->mfence();
+	InterpreterCall(op);
 }
 
 void spu_recompiler::DSYNC(spu_opcode_t op)
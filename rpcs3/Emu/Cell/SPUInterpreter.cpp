@@ -67,7 +67,10 @@ void spu_interpreter::LNOP(SPUThread& spu, spu_opcode_t op)
 // This instruction must be used following a store instruction that modifies the instruction stream.
 void spu_interpreter::SYNC(SPUThread& spu, spu_opcode_t op)
 {
-	_mm_mfence(); 
+	_mm_mfence();
+
+	// Code may have been modified by preceding stores
+	spu.ls_dirty = ~0ull;
 }
 
 // This instruction forces all earlier load, store, and channel instructions to complete before proceeding.
@@ -0,0 +1,1800 @@
+#ifdef LLVM_AVAILABLE
+
+#include "stdafx.h"
+#include "Emu/Memory/Memory.h"
+#include "Emu/System.h"
+
+#include "restore_new.h"
+#ifdef _MSC_VER
+#pragma warning(push, 0)
+#endif
+#include "llvm/Support/Host.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/Transforms/Scalar.h"
+#include "llvm/Transforms/Vectorize.h"
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+#include "define_new_memleakdetect.h"
+
+#include "Utilities/JIT.h"
+#include "SPUThread.h"
+#include "SPUInterpreter.h"
+#include "SPULLVMRecompiler.h"
+
+#include <cstring>
+
+using namespace llvm;
+
+const spu_decoder<spu_itype> s_spu_itype;
+const spu_decoder<spu_interpreter_fast> s_spu_interpreter;
+const spu_decoder<spu_llvm_recompiler> s_spu_decoder;
+
+spu_llvm_recompiler::spu_llvm_recompiler()
+	: cpu_translator(m_llvm, nullptr, false)
+	, m_jit(std::make_unique<jit_compiler>(std::unordered_map<std::string, std::uintptr_t>{}))
+{
+	LOG_SUCCESS(SPU, "SPU Recompiler (LLVM) created...");
+}
+
+spu_llvm_recompiler::~spu_llvm_recompiler()
+{
+}
+
+void spu_llvm_recompiler::compile(spu_function_t& f)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (f.compiled)
+	{
+		// return if function already compiled
+		return;
+	}
+
+	if (f.addr >= 0x40000 || f.addr % 4 || f.size == 0 || f.size > 0x40000 - f.addr || f.size % 4)
+	{
+		fmt::throw_exception("Invalid SPU function (addr=0x%05x, size=0x%x)" HERE, f.addr, f.size);
+	}
+
+	for (const u32 addr : f.blocks)
+	{
+		if (addr < f.addr || addr >= f.addr + f.size || addr % 4)
+		{
+			fmt::throw_exception("Invalid function block entry (0x%05x)" HERE, addr);
+		}
+	}
+
+	for (const u32 addr : f.jtable)
+	{
+		if (addr < f.addr || addr >= f.addr + f.size || addr % 4)
+		{
+			fmt::throw_exception("Invalid jump table entry (0x%05x)" HERE, addr);
+		}
+	}
+
+	this->m_func = &f;
+
+	// Collect registers referenced by the function (bits of other fields may be included, it's harmless)
+	m_regs_used.reset();
+	m_regs_mod.reset();
+
+	for (const u32 op : f.data)
+	{
+		const spu_opcode_t _op{ op };
+		const auto type = s_spu_itype.decode(op);
+
+		m_regs_used.set(_op.rt);
+		m_regs_used.set(_op.ra);
+		m_regs_used.set(_op.rb);
+		m_regs_used.set(_op.rt4);
+		m_regs_mod.set(type & spu_itype::_quadrop ? _op.rt4 : _op.rt);
+	}
+
+	const std::string name = fmt::format("spu_%05x_%u", f.addr, m_count++);
+
+	auto module = std::make_unique<Module>(name, m_context);
+	module->setTargetTriple(Triple::normalize(sys::getProcessTriple()));
+	m_module = module.get();
+
+	// Function type: u32(SPUThread*, LS base)
+	m_function = cast<Function>(m_module->getOrInsertFunction(name, FunctionType::get(get_type<u32>(), {get_type<u8*>(), get_type<u8*>()}, false)));
+	m_function->setLinkage(GlobalValue::ExternalLinkage);
+
+	// LS may be accessed by the gates through another pointer, so only the thread pointer is marked noalias
+	m_function->addAttribute(1, Attribute::NoAlias);
+
+	auto arg = m_function->arg_begin();
+	m_thread = &*arg++;
+	m_lsptr = &*arg;
+
+	IRBuilder<> irb(BasicBlock::Create(m_context, "__entry", m_function));
+	m_ir = &irb;
+
+	// Create register variables and load initial values
+	m_gpr.fill(nullptr);
+	m_cache.fill(nullptr);
+	m_addr = m_ir->CreateAlloca(get_type<u32>(), nullptr, "addr");
+
+	for (u32 i = 0; i < 128; i++)
+	{
+		if (m_regs_used[i])
+		{
+			m_gpr[i] = m_ir->CreateAlloca(get_type<u32[4]>(), nullptr, fmt::format("$%u", i));
+		}
+	}
+
+	reload(m_regs_used);
+
+	// Create blocks for block entries
+	m_blocks.clear();
+
+	for (const u32 addr : f.blocks)
+	{
+		m_blocks.emplace(addr, BasicBlock::Create(m_context, fmt::format("b%05x", addr), m_function));
+	}
+
+	m_jt = BasicBlock::Create(m_context, "__jt", m_function);
+	m_end = BasicBlock::Create(m_context, "__end", m_function);
+
+	// Start compilation
+	m_pos = f.addr;
+
+	for (const u32 op : f.data)
+	{
+		const auto found = m_blocks.find(m_pos);
+
+		if (found != m_blocks.end())
+		{
+			enter_block(found->second);
+		}
+		else if (m_ir->GetInsertBlock()->getTerminator())
+		{
+			// Unreachable code (not registered as a block)
+			enter_block(BasicBlock::Create(m_context, "", m_function));
+		}
+
+		// Recompiler function
+		(this->*s_spu_decoder.decode(op))({ op });
+
+		// Set next position
+		m_pos += 4;
+	}
+
+	// Generate default function end (go to the next address)
+	if (!m_ir->GetInsertBlock()->getTerminator())
+	{
+		ret_addr(m_ir->getInt32(spu_branch_target(m_pos)));
+	}
+
+	// Generate jump table resolver (uses m_addr)
+	m_ir->SetInsertPoint(m_jt);
+	const auto jt_addr = m_ir->CreateLoad(m_addr);
+	const auto jt_next = BasicBlock::Create(m_context, "", m_function);
+	m_ir->CreateBr(check_state(nullptr, jt_next));
+	m_ir->SetInsertPoint(jt_next);
+	const auto sw = m_ir->CreateSwitch(jt_addr, m_end, ::size32(f.jtable));
+
+	for (const u32 addr : f.jtable)
+	{
+		const auto found = m_blocks.find(addr);
+
+		if (found != m_blocks.end())
+		{
+			sw->addCase(m_ir->getInt32(addr), found->second);
+		}
+		else
+		{
+			LOG_ERROR(SPU, "Unable to add jump table entry (0x%05x)", addr);
+		}
+	}
+
+	// Generate function end (returns m_addr)
+	m_ir->SetInsertPoint(m_end);
+	m_cache.fill(nullptr);
+	const auto result = m_ir->CreateLoad(m_addr);
+	spill(m_regs_mod);
+	m_ir->CreateRet(result);
+
+	// Optimize: register variables are promoted and constants are propagated across blocks
+	legacy::FunctionPassManager pm(m_module);
+	pm.add(createPromoteMemoryToRegisterPass());
+	pm.add(createCFGSimplificationPass());
+	pm.add(createEarlyCSEPass());
+	pm.add(createReassociatePass());
+	pm.add(createInstructionCombiningPass());
+	pm.add(createLICMPass());
+	pm.add(createGVNPass());
+	pm.add(createDeadStoreEliminationPass());
+	pm.add(createSCCPPass());
+	pm.add(createSLPVectorizerPass());
+	pm.add(createInstructionCombiningPass());
+	pm.add(createAggressiveDCEPass());
+	pm.add(createCFGSimplificationPass());
+	pm.run(*m_function);
+
+	std::string log;
+	raw_string_ostream out(log);
+
+	if (verifyFunction(*m_function, &out))
+	{
+		out.flush();
+		m_module = nullptr;
+		fmt::throw_exception("LLVM: SPU function verification failed (0x%05x):\n%s" HERE, f.addr, log);
+	}
+
+	m_module = nullptr;
+	m_ir = nullptr;
+
+	// Compile and store function address
+	m_jit->add(std::move(module), "");
+	m_jit->fin();
+
+	f.compiled = reinterpret_cast<decltype(f.compiled)>(m_jit->get(name));
+
+	if (!f.compiled)
+	{
+		fmt::throw_exception("LLVM: SPU function not found (0x%05x)" HERE, f.addr);
+	}
+}
+
+Value* spu_llvm_recompiler::spu_gpr_ptr(u32 index)
+{
+	return spu_ptr<u32[4]>(OFFSET_32(SPUThread, gpr) + index * 16);
+}
+
+Value* spu_llvm_recompiler::get_vr_raw(u32 index)
+{
+	if (!m_cache[index])
+	{
+		m_cache[index] = m_ir->CreateAlignedLoad(m_gpr[index], 16);
+	}
+
+	return m_cache[index];
+}
+
+Value* spu_llvm_recompiler::get_pref32(u32 index)
+{
+	return m_ir->CreateExtractElement(get_vr<u32[4]>(index), m_ir->getInt32(3));
+}
+
+void spu_llvm_recompiler::set_vr(u32 index, Value* value)
+{
+	value = bitcast(value, get_type<u32[4]>());
+	m_ir->CreateAlignedStore(value, m_gpr[index], 16);
+	m_cache[index] = value;
+}
+
+void spu_llvm_recompiler::spill(const std::bitset<128>& regs)
+{
+	for (u32 i = 0; i < 128; i++)
+	{
+		if (regs[i] && m_gpr[i])
+		{
+			m_ir->CreateAlignedStore(get_vr_raw(i), spu_gpr_ptr(i), 16);
+		}
+	}
+}
+
+void spu_llvm_recompiler::reload(const std::bitset<128>& regs)
+{
+	for (u32 i = 0; i < 128; i++)
+	{
+		if (regs[i] && m_gpr[i])
+		{
+			const auto value = m_ir->CreateAlignedLoad(spu_gpr_ptr(i), 16);
+			m_ir->CreateAlignedStore(value, m_gpr[i], 16);
+			m_cache[i] = value;
+		}
+	}
+}
+
+void spu_llvm_recompiler::enter_block(BasicBlock* block)
+{
+	if (!m_ir->GetInsertBlock()->getTerminator())
+	{
+		m_ir->CreateBr(block);
+	}
+
+	m_ir->SetInsertPoint(block);
+	m_cache.fill(nullptr);
+}
+
+void spu_llvm_recompiler::ret_addr(Value* addr)
+{
+	m_ir->CreateStore(addr, m_addr);
+	m_ir->CreateBr(m_end);
+}
+
+BasicBlock* spu_llvm_recompiler::get_target(u32 target, const char* hint)
+{
+	const auto found = m_blocks.find(target);
+
+	if (found != m_blocks.end())
+	{
+		// Loops must be interruptible
+		return target <= m_pos ? check_state(m_ir->getInt32(target), found->second) : found->second;
+	}
+
+	if (target >= m_func->addr && target < m_func->addr + m_func->size)
+	{
+		LOG_ERROR(SPU, "Local block not registered (%s 0x%x)", hint, target);
+	}
+
+	// Create stub which leaves the function
+	const auto cblock = m_ir->GetInsertBlock();
+	const auto stub = BasicBlock::Create(m_context, "", m_function);
+	m_ir->SetInsertPoint(stub);
+	ret_addr(m_ir->getInt32(target));
+	m_ir->SetInsertPoint(cblock);
+	return stub;
+}
+
+BasicBlock* spu_llvm_recompiler::check_state(Value* target, BasicBlock* next)
+{
+	const auto cblock = m_ir->GetInsertBlock();
+	const auto block = BasicBlock::Create(m_context, "", m_function);
+	const auto stop = BasicBlock::Create(m_context, "", m_function);
+	m_ir->SetInsertPoint(block);
+
+	// Acquire load also prevents LS loads from being hoisted out of the loop (LS may be written by DMA)
+	const auto state = m_ir->CreateAlignedLoad(spu_ptr<u32>(OFFSET_32(SPUThread, state)), 4);
+	state->setAtomic(AtomicOrdering::Acquire);
+	m_ir->CreateCondBr(m_ir->CreateICmpNE(state, m_ir->getInt32(0)), stop, next);
+
+	// Leave the function, the thread will continue from the target address
+	m_ir->SetInsertPoint(stop);
+
+	if (target)
+	{
+		ret_addr(target);
+	}
+	else
+	{
+		m_ir->CreateBr(m_end);
+	}
+
+	m_ir->SetInsertPoint(cblock);
+	return block;
+}
+
+void spu_llvm_recompiler::branch_if(Value* cond, u32 target, const char* hint)
+{
+	const auto next = BasicBlock::Create(m_context, "", m_function);
+	m_ir->CreateCondBr(cond, get_target(target, hint), next);
+	m_ir->SetInsertPoint(next);
+}
+
+void spu_llvm_recompiler::branch_indirect(Value* cond, spu_opcode_t op)
+{
+	Value* addr = m_ir->CreateAnd(get_pref32(op.ra), 0x3fffc);
+
+	if (op.d || op.e)
+	{
+		// Interrupt flags neutralize jump table
+		addr = m_ir->CreateOr(addr, op.e << 26 | op.d << 27);
+	}
+
+	if (cond)
+	{
+		const auto jump = BasicBlock::Create(m_context, "", m_function);
+		const auto next = BasicBlock::Create(m_context, "", m_function);
+		m_ir->CreateCondBr(cond, jump, next);
+		m_ir->SetInsertPoint(jump);
+		m_ir->CreateStore(addr, m_addr);
+		m_ir->CreateBr(m_jt);
+		m_ir->SetInsertPoint(next);
+		return;
+	}
+
+	m_ir->CreateStore(addr, m_addr);
+	m_ir->CreateBr(m_jt);
+}
+
+void spu_llvm_recompiler::check_result(Value* result)
+{
+	const auto next = BasicBlock::Create(m_context, "", m_function);
+	const auto stop = BasicBlock::Create(m_context, "", m_function);
+	m_ir->CreateCondBr(m_ir->CreateICmpNE(result, m_ir->getInt32(0)), stop, next);
+	m_ir->SetInsertPoint(stop);
+	ret_addr(result);
+	m_ir->SetInsertPoint(next);
+}
+
+Value* spu_llvm_recompiler::ext16(Value* value, bool is_signed)
+{
+	if (is_signed)
+	{
+		return m_ir->CreateAShr(m_ir->CreateShl(value, 16), 16);
+	}
+
+	return m_ir->CreateAnd(value, 0xffff);
+}
+
+Value* spu_llvm_recompiler::shufb(Value* a, Value* b, Value* c)
+{
+	v128 mask;
+
+	if (get_const(c, mask))
+	{
+		// Translate constant control vector (big-endian byte indices) to shufflevector indices
+		std::vector<u32> idx(16), sel(16);
+		v128 fill = v128::from64(0);
+		bool special = false;
+
+		for (u32 i = 0; i < 16; i++)
+		{
+			const u8 x = mask._u8[i];
+
+			if (x & 0x80)
+			{
+				fill._u8[i] = x & 0x40 ? (x & 0x20 ? 0x80 : 0xff) : 0x00;
+				idx[i] = 0;
+				sel[i] = 16 + i;
+				special = true;
+			}
+			else
+			{
+				idx[i] = x & 0x10 ? 47 - (x & 0x1f) : 15 - (x & 0xf);
+				sel[i] = i;
+			}
+		}
+
+		const auto result = shuffle(a, b, idx);
+
+		if (special)
+		{
+			return shuffle(result, make_const(fill, get_type<u8[16]>()), sel);
+		}
+
+		return result;
+	}
+
+	// Generic path (similar to the interpreter)
+	const auto x = m_ir->CreateXor(c, splat<u8, 16>(0x0f));
+	const auto ra = call(get_type<u8[16]>(), "llvm.x86.ssse3.pshuf.b.128", a, x);
+	const auto rb = call(get_type<u8[16]>(), "llvm.x86.ssse3.pshuf.b.128", b, x);
+	const auto k1 = m_ir->CreateICmpNE(m_ir->CreateAnd(x, splat<u8, 16>(0x10)), splat<u8, 16>(0));
+	const auto k2 = m_ir->CreateICmpEQ(m_ir->CreateAnd(x, splat<u8, 16>(0xc0)), splat<u8, 16>(0xc0));
+	const auto k3 = m_ir->CreateICmpEQ(m_ir->CreateAnd(x, splat<u8, 16>(0xe0)), splat<u8, 16>(0xe0));
+	const auto r1 = m_ir->CreateSelect(k1, rb, ra);
+	const auto r2 = m_ir->CreateSelect(k2, splat<u8, 16>(0xff), r1);
+	return m_ir->CreateSelect(k3, splat<u8, 16>(0x80), r2);
+}
+
+Value* spu_llvm_recompiler::vshl(Value* a, Value* n)
+{
+	const auto type = a->getType();
+	const u64 bits = type->getScalarSizeInBits();
+	return m_ir->CreateSelect(m_ir->CreateICmpUGE(n, ConstantInt::get(type, bits)), Constant::getNullValue(type), m_ir->CreateShl(a, m_ir->CreateAnd(n, ConstantInt::get(type, bits - 1))));
+}
+
+Value* spu_llvm_recompiler::vlshr(Value* a, Value* n)
+{
+	const auto type = a->getType();
+	const u64 bits = type->getScalarSizeInBits();
+	return m_ir->CreateSelect(m_ir->CreateICmpUGE(n, ConstantInt::get(type, bits)), Constant::getNullValue(type), m_ir->CreateLShr(a, m_ir->CreateAnd(n, ConstantInt::get(type, bits - 1))));
+}
+
+Value* spu_llvm_recompiler::vashr(Value* a, Value* n)
+{
+	const auto type = a->getType();
+	const auto max = ConstantInt::get(type, type->getScalarSizeInBits() - 1);
+	return m_ir->CreateAShr(a, m_ir->CreateSelect(m_ir->CreateICmpUGT(n, max), max, n));
+}
+
+Value* spu_llvm_recompiler::vrotl(Value* a, Value* n)
+{
+	const auto type = a->getType();
+	const u64 bits = type->getScalarSizeInBits();
+	const auto mask = ConstantInt::get(type, bits - 1);
+	const auto l = m_ir->CreateAnd(n, mask);
+	const auto r = m_ir->CreateAnd(m_ir->CreateSub(ConstantInt::get(type, bits), l), mask);
+	return m_ir->CreateOr(m_ir->CreateShl(a, l), m_ir->CreateLShr(a, r));
+}
+
+bool spu_llvm_recompiler::get_const(Value* value, v128& data)
+{
+	auto c = dyn_cast<Constant>(value);
+
+	// Look through bitcasts
+	while (const auto ce = dyn_cast_or_null<ConstantExpr>(c))
+	{
+		if (ce->getOpcode() != Instruction::BitCast)
+		{
+			return false;
+		}
+
+		c = ce->getOperand(0);
+	}
+
+	if (!c || c->getType()->getPrimitiveSizeInBits() != 128)
+	{
+		return false;
+	}
+
+	if (c->getType()->isIntegerTy())
+	{
+		if (const auto ci = dyn_cast<ConstantInt>(c))
+		{
+			data._u64[0] = ci->getValue().getLoBits(64).getZExtValue();
+			data._u64[1] = ci->getValue().lshr(64).getZExtValue();
+			return true;
+		}
+
+		return false;
+	}
+
+	if (!c->getType()->isVectorTy())
+	{
+		return false;
+	}
+
+	const u32 count = c->getType()->getVectorNumElements();
+	const u32 size = 16 / count;
+
+	for (u32 i = 0; i < count; i++)
+	{
+		const auto e = c->getAggregateElement(i);
+		u64 v = 0;
+
+		if (const auto ci = dyn_cast_or_null<ConstantInt>(e))
+		{
+			v = ci->getZExtValue();
+		}
+		else if (const auto cf = dyn_cast_or_null<ConstantFP>(e))
+		{
+			v = cf->getValueAPF().bitcastToAPInt().getZExtValue();
+		}
+		else if (!e || !isa<UndefValue>(e))
+		{
+			return false;
+		}
+
+		std::memcpy(reinterpret_cast<u8*>(&data) + i * size, &v, size);
+	}
+
+	return true;
+}
+
+Constant* spu_llvm_recompiler::make_const(const v128& data, Type* type)
+{
+	if (type->isIntegerTy(128))
+	{
+		return ConstantInt::get(m_context, APInt(128, {data._u64[0], data._u64[1]}));
+	}
+
+	const auto etype = type->getVectorElementType();
+
+	if (etype->isFloatTy())
+	{
+		return ConstantDataVector::get(m_context, makeArrayRef(reinterpret_cast<const f32*>(&data), 4));
+	}
+
+	if (etype->isDoubleTy())
+	{
+		return ConstantDataVector::get(m_context, makeArrayRef(reinterpret_cast<const f64*>(&data), 2));
+	}
+
+	switch (etype->getIntegerBitWidth())
+	{
+	case 8: return ConstantDataVector::get(m_context, makeArrayRef(reinterpret_cast<const u8*>(&data), 16));
+	case 16: return ConstantDataVector::get(m_context, makeArrayRef(reinterpret_cast<const u16*>(&data), 8));
+	case 32: return ConstantDataVector::get(m_context, makeArrayRef(reinterpret_cast<const u32*>(&data), 4));
+	case 64: return ConstantDataVector::get(m_context, makeArrayRef(reinterpret_cast<const u64*>(&data), 2));
+	}
+
+	fmt::throw_exception("Invalid constant type" HERE);
+}
+
+Value* spu_llvm_recompiler::bitcast(Value* value, Type* type)
+{
+	v128 data;
+
+	if (value->getType() == type)
+	{
+		return value;
+	}
+
+	if (get_const(value, data))
+	{
+		return make_const(data, type);
+	}
+
+	return m_ir->CreateBitCast(value, type);
+}
+
+Value* spu_llvm_recompiler::ls_ptr(Value* addr)
+{
+	const auto offset = m_ir->CreateZExt(m_ir->CreateAnd(addr, 0x3fff0), get_type<u64>());
+	return m_ir->CreateBitCast(m_ir->CreateGEP(m_lsptr, offset), get_type<u8[16]>()->getPointerTo());
+}
+
+void spu_llvm_recompiler::InterpreterCall(spu_opcode_t op)
+{
+	std::bitset<128> regs;
+	regs.set(op.rt);
+	regs.set(op.ra);
+	regs.set(op.rb);
+	regs.set(op.rt4);
+
+	m_ir->CreateStore(m_ir->getInt32(m_pos), spu_ptr<u32>(OFFSET_32(SPUThread, pc)));
+	spill(regs);
+	const auto result = call(&spu_recompiler_base::interpreter_gate, m_thread, m_ir->getInt32(op.opcode), m_ir->getInt64((u64)s_spu_interpreter.decode(op.opcode)));
+	reload(regs);
+
+	// Return immediately if an error occured
+	check_result(result);
+}
+
+void spu_llvm_recompiler::FunctionCall(Value* target, spu_opcode_t op)
+{
+	const u32 link = spu_branch_target(m_pos + 4);
+	set_vr(op.rt, make_const(v128::from32r(link), get_type<u32[4]>()));
+
+	m_ir->CreateStore(target, spu_ptr<u32>(OFFSET_32(SPUThread, pc)));
+	spill(m_regs_mod);
+	const auto result = call(&spu_recompiler_base::function_gate, m_thread, m_ir->getInt32(link));
+	reload(m_regs_used);
+
+	// Return immediately if an error occured
+	check_result(result);
+}
+
+void spu_llvm_recompiler::STOP(spu_opcode_t op)
+{
+	InterpreterCall(op);
+}
+
+void spu_llvm_recompiler::LNOP(spu_opcode_t op)
+{
+}
+
+void spu_llvm_recompiler::SYNC(spu_opcode_t op)
+{
+	// This instruction must be used following a store instruction that modifies the instruction stream.
+	InterpreterCall(op);
+}
+
+void spu_llvm_recompiler::DSYNC(spu_opcode_t op)
+{
+	// This instruction forces all earlier load, store, and channel instructions to complete before proceeding.
+	m_ir->CreateFence(AtomicOrdering::SequentiallyConsistent);
+}
+
+void spu_llvm_recompiler::MFSPR(spu_opcode_t op)
+{
+	InterpreterCall(op);
+}
+
+void spu_llvm_recompiler::RDCH(spu_opcode_t op)
+{
+	InterpreterCall(op);
+}
+
+void spu_llvm_recompiler::RCHCNT(spu_opcode_t op)
+{
+	InterpreterCall(op);
+}
+
+void spu_llvm_recompiler::SF(spu_opcode_t op)
+{
+	set_vr(op.rt, m_ir->CreateSub(get_vr<u32[4]>(op.rb), get_vr<u32[4]>(op.ra)));
+}
+
+void spu_llvm_recompiler::OR(spu_opcode_t op)
+{
+	set_vr(op.rt, m_ir->CreateOr(get_vr<u32[4]>(op.ra), get_vr<u32[4]>(op.rb)));
+}
+
+void spu_llvm_recompiler::BG(spu_opcode_t op)
+{
+	const auto a = get_vr<u32[4]>(op.ra);
+	const auto b = get_vr<u32[4]>(op.rb);
+	set_vr(op.rt, m_ir->CreateZExt(m_ir->CreateICmpULE(a, b), get_type<u32[4]>()));
+}
+
+void spu_llvm_recompiler::SFH(spu_opcode_t op)
+{
+	set_vr(op.rt, m_ir->CreateSub(get_vr<u16[8]>(op.rb), get_vr<u16[8]>(op.ra)));
+}
+
+void spu_llvm_recompiler::NOR(spu_opcode_t op)
+{
+	set_vr(op.rt, m_ir->CreateNot(m_ir->CreateOr(get_vr<u32[4]>(op.ra), get_vr<u32[4]>(op.rb))));
+}
+
+void spu_llvm_recompiler::ABSDB(spu_opcode_t op)
+{
+	const auto a = get_vr<u8[16]>(op.ra);
+	const auto b = get_vr<u8[16]>(op.rb);
+	set_vr(op.rt, m_ir->CreateSelect(m_ir->CreateICmpUGT(a, b), m_ir->CreateSub(a, b), m_ir->CreateSub(b, a)));
+}
+
+void spu_llvm_recompiler::ROT(spu_opcode_t op)
+{
+	set_vr(op.rt, vrotl(get_vr<u32[4]>(op.ra), get_vr<u32[4]>(op.rb)));
+}
+
+void spu_llvm_recompiler::ROTM(spu_opcode_t op)
+{
+	const auto n = m_ir->CreateAnd(m_ir->CreateNeg(get_vr<u32[4]>(op.rb)), 0x3f);
+	set_vr(op.rt, vlshr(get_vr<u32[4]>(op.ra), n));
+}
+
+void spu_llvm_recompiler::ROTMA(spu_opcode_t op)
+{
+	const auto n = m_ir->CreateAnd(m_ir->CreateNeg(get_vr<u32[4]>(op.rb)), 0x3f);
+	set_vr(op.rt, vashr(get_vr<u32[4]>(op.ra), n));
+}
+
+void spu_llvm_recompiler::SHL(spu_opcode_t op)
+{
+	const auto n = m_ir->CreateAnd(get_vr<u32[4]>(op.rb), 0x3f);
+	set_vr(op.rt, vshl(get_vr<u32[4]>(op.ra), n));
+}
+
+void spu_llvm_recompiler::ROTH(spu_opcode_t op)
+{
+	set_vr(op.rt, vrotl(get_vr<u16[8]>(op.ra), get_vr<u16[8]>(op.rb)));
+}
+
+void spu_llvm_recompiler::ROTHM(spu_opcode_t op)
+{
+	const auto n = m_ir->CreateAnd(m_ir->CreateNeg(get_vr<u16[8]>(op.rb)), 0x1f);
+	set_vr(op.rt, vlshr(get_vr<u16[8]>(op.ra), n));
+}
+
+void spu_llvm_recompiler::ROTMAH(spu_opcode_t op)
+{
+	const auto n = m_ir->CreateAnd(m_ir->CreateNeg(get_vr<u16[8]>(op.rb)), 0x1f);
+	set_vr(op.rt, vashr(get_vr<u16[8]>(op.ra), n));
+}
+
+void spu_llvm_recompiler::SHLH(spu_opcode_t op)
+{
+	const auto n = m_ir->CreateAnd(get_vr<u16[8]>(op.rb), 0x1f);
+	set_vr(op.rt, vshl(get_vr<u16[8]>(op.ra), n));
+}
+
+void spu_llvm_recompiler::ROTI(spu_opcode_t op)
+{
+	set_vr(op.rt, vrotl(get_vr<u32[4]>(op.ra), splat<u32, 4>(op.i7 & 0x1f)));
+}
+
+void spu_llvm_recompiler::ROTMI(spu_opcode_t op)
+{
+	set_vr(op.rt, vlshr(get_vr<u32[4]>(op.ra), splat<u32, 4>(0 - op.i7 & 0x3f)));
+}
+
+void spu_llvm_recompiler::ROTMAI(spu_opcode_t op)
+{
+	set_vr(op.rt, vashr(get_vr<u32[4]>(op.ra), splat<u32, 4>(0 - op.i7 & 0x3f)));
+}
+
+void spu_llvm_recompiler::SHLI(spu_opcode_t op)
+{
+	set_vr(op.rt, vshl(get_vr<u32[4]>(op.ra), splat<u32, 4>(op.i7 & 0x3f)));
+}
+
+void spu_llvm_recompiler::ROTHI(spu_opcode_t op)
+{
+	set_vr(op.rt, vrotl(get_vr<u16[8]>(op.ra), splat<u16, 8>(op.i7 & 0xf)));
+}
+
+void spu_llvm_recompiler::ROTHMI(spu_opcode_t op)
+{
+	set_vr(op.rt, vlshr(get_vr<u16[8]>(op.ra), splat<u16, 8>(0 - op.i7 & 0x1f)));
+}
+
+void spu_llvm_recompiler::ROTMAHI(spu_opcode_t op)
+{
+	set_vr(op.rt, vashr(get_vr<u16[8]>(op.ra), splat<u16, 8>(0 - op.i7 & 0x1f)));
+}
+
+void spu_llvm_recompiler::SHLHI(spu_opcode_t op)
+{
+	set_vr(op.rt, vshl(get_vr<u16[8]>(op.ra), splat<u16, 8>(op.i7 & 0x1f)));
+}
+
+void spu_llvm_recompiler::A(spu_opcode_t op)
+{
+	set_vr(op.rt, m_ir->CreateAdd(get_vr<u32[4]>(op.ra), get_vr<u32[4]>(op.rb)));
+}
+
+void spu_llvm_recompiler::AND(spu_opcode_t op)
+{
+	set_vr(op.rt, m_ir->CreateAnd(get_vr<u32[4]>(op.ra), get_vr<u32[4]>(op.rb)));
+}
+
+void spu_llvm_recompiler::CG(spu_opcode_t op)
+{
+	const auto a = get_vr<u32[4]>(op.ra);
+	const auto b = get_vr<u32[4]>(op.rb);
+	set_vr(op.rt, m_ir->CreateZExt(m_ir->CreateICmpULT(m_ir->CreateAdd(a, b), a), get_type<u32[4]>()));
+}
+
+void spu_llvm_recompiler::AH(spu_opcode_t op)
+{
+	set_vr(op.rt, m_ir->CreateAdd(get_vr<u16[8]>(op.ra), get_vr<u16[8]>(op.rb)));
+}
+
+void spu_llvm_recompiler::NAND(spu_opcode_t op)
+{
+	set_vr(op.rt, m_ir->CreateNot(m_ir->CreateAnd(get_vr<u32[4]>(op.ra), get_vr<u32[4]>(op.rb))));
+}
+
+void spu_llvm_recompiler::AVGB(spu_opcode_t op)
+{
+	const auto a = m_ir->CreateZExt(get_vr<u8[16]>(op.ra), get_type<u16[16]>());
+	const auto b = m_ir->CreateZExt(get_vr<u8[16]>(op.rb), get_type<u16[16]>());
+	const auto sum = m_ir->CreateAdd(m_ir->CreateAdd(a, b), splat<u16, 16>(1));
+	set_vr(op.rt, m_ir->CreateTrunc(m_ir->CreateLShr(sum, 1), get_type<u8[16]>()));
+}
+
+void spu_llvm_recompiler::MTSPR(spu_opcode_t op)
+{
+	InterpreterCall(op);
+}
+
+void spu_llvm_recompiler::WRCH(spu_opcode_t op)
+{
+	InterpreterCall(op);
+}
+
+void spu_llvm_recompiler::BIZ(spu_opcode_t op)
+{
+	branch_indirect(m_ir->CreateICmpEQ(get_pref32(op.rt), m_ir->getInt32(0)), op);
+}
+
+void spu_llvm_recompiler::BINZ(spu_opcode_t op)
+{
+	branch_indirect(m_ir->CreateICmpNE(get_pref32(op.rt), m_ir->getInt32(0)), op);
+}
+
+void spu_llvm_recompiler::BIHZ(spu_opcode_t op)
+{
+	const auto value = m_ir->CreateExtractElement(get_vr<u16[8]>(op.rt), m_ir->getInt32(6));
+	branch_indirect(m_ir->CreateICmpEQ(value, m_ir->getInt16(0)), op);
+}
+
+void spu_llvm_recompiler::BIHNZ(spu_opcode_t op)
+{
+	const auto value = m_ir->CreateExtractElement(get_vr<u16[8]>(op.rt), m_ir->getInt32(6));
+	branch_indirect(m_ir->CreateICmpNE(value, m_ir->getInt16(0)), op);
+}
+
+void spu_llvm_recompiler::STOPD(spu_opcode_t op)
+{
+	InterpreterCall(op);
+}
+
+void spu_llvm_recompiler::STQX(spu_opcode_t op)
+{
+	const auto addr = m_ir->CreateAdd(get_pref32(op.ra), get_pref32(op.rb));
+	m_ir->CreateAlignedStore(byteswap(get_vr<u8[16]>(op.rt)), ls_ptr(addr), 16);
+}
+
+void spu_llvm_recompiler::BI(spu_opcode_t op)
+{
+	branch_indirect(nullptr, op);
+}
+
+void spu_llvm_recompiler::BISL(spu_opcode_t op)
+{
+	Value* addr = m_ir->CreateAnd(get_pref32(op.ra), 0x3fffc);
+
+	if (op.d || op.e)
+	{
+		// Interrupt flags stored to PC
+		addr = m_ir->CreateOr(addr, op.e << 26 | op.d << 27);
+	}
+
+	FunctionCall(addr, op);
+}
+
+void spu_llvm_recompiler::IRET(spu_opcode_t op)
+{
+	InterpreterCall(op);
+}
+
+void spu_llvm_recompiler::BISLED(spu_opcode_t op)
+{
+	InterpreterCall(op);
+}
+
+void spu_llvm_recompiler::HBR(spu_opcode_t op)
+{
+}
+
+void spu_llvm_recompiler::GB(spu_opcode_t op)
+{
+	InterpreterCall(op);
+}
+
+void spu_llvm_recompiler::GBH(spu_opcode_t op)
+{
+	InterpreterCall(op);
+}
+
+void spu_llvm_recompiler::GBB(spu_opcode_t op)
+{
+	InterpreterCall(op);
+}
+
+void spu_llvm_recompiler::FSM(spu_opcode_t op)
+{
+	// Load from the table used by the interpreter
+	const auto index = m_ir->CreateZExt(m_ir->CreateAnd(get_pref32(op.ra), 0xf), get_type<u64>());
+	const auto addr = m_ir->CreateAdd(m_ir->getInt64((u64)g_spu_imm.fsm), m_ir->CreateShl(index, 4));
+	set_vr(op.rt, m_ir->CreateAlignedLoad(m_ir->CreateIntToPtr(addr, get_type<u32[4]>()->getPointerTo()), 16));
+}
+
+void spu_llvm_recompiler::FSMH(spu_opcode_t op)
+{
+	const auto index = m_ir->CreateZExt(m_ir->CreateAnd(get_pref32(op.ra), 0xff), get_type<u64>());
+	const auto addr = m_ir->CreateAdd(m_ir->getInt64((u64)g_spu_imm.fsmh), m_ir->CreateShl(index, 4));
+	set_vr(op.rt, m_ir->CreateAlignedLoad(m_ir->CreateIntToPtr(addr, get_type<u32[4]>()->getPointerTo()), 16));
+}
+
+void spu_llvm_recompiler::FSMB(spu_opcode_t op)
+{
+	const auto index = m_ir->CreateZExt(m_ir->CreateAnd(get_pref32(op.ra), 0xffff), get_type<u64>());
+	const auto addr = m_ir->CreateAdd(m_ir->getInt64((u64)g_spu_imm.fsmb), m_ir->CreateShl(index, 4));
+	set_vr(op.rt, m_ir->CreateAlignedLoad(m_ir->CreateIntToPtr(addr, get_type<u32[4]>()->getPointerTo()), 16));
+}
+
+void spu_llvm_recompiler::FREST(spu_opcode_t op)
+{
+	InterpreterCall(op);
+}
+
+void spu_llvm_recompiler::FRSQEST(spu_opcode_t op)
+{
+	InterpreterCall(op);
+}
+
+void spu_llvm_recompiler::LQX(spu_opcode_t op)
+{
+	const auto addr = m_ir->CreateAdd(get_pref32(op.ra), get_pref32(op.rb));
+	set_vr(op.rt, byteswap(m_ir->CreateAlignedLoad(ls_ptr(addr), 16)));
+}
+
+void spu_llvm_recompiler::ROTQBYBI(spu_opcode_t op)
+{
+	const auto n = m_ir->CreateShl(m_ir->CreateAnd(m_ir->CreateLShr(get_pref32(op.rb), 3), 0xf), 3);
+	set_vr(op.rt, vrotl(get_vr<u128>(op.ra), m_ir->CreateZExt(n, get_type<u128>())));
+}
+
+void spu_llvm_recompiler::ROTQMBYBI(spu_opcode_t op)
+{
+	const auto n = m_ir->CreateShl(m_ir->CreateAnd(m_ir->CreateNeg(m_ir->CreateAShr(get_pref32(op.rb), 3)), 0x1f), 3);
+	set_vr(op.rt, vlshr(get_vr<u128>(op.ra), m_ir->CreateZExt(n, get_type<u128>())));
+}
+
+void spu_llvm_recompiler::SHLQBYBI(spu_opcode_t op)
+{
+	const auto n = m_ir->CreateShl(m_ir->CreateAnd(m_ir->CreateLShr(get_pref32(op.rb), 3), 0x1f), 3);
+	set_vr(op.rt, vshl(get_vr<u128>(op.ra), m_ir->CreateZExt(n, get_type<u128>())));
+}
+
+// Control pattern for CBX, CHX, CWX, CDX, CBD, CHD, CWD, CDD instructions
+static const v128 s_spu_insert_mask = v128::from64(0x18191A1B1C1D1E1Full, 0x1011121314151617ull);
+
+void spu_llvm_recompiler::CBX(spu_opcode_t op)
+{
+	const auto t = m_ir->CreateAnd(m_ir->CreateNot(m_ir->CreateAdd(get_pref32(op.rb), get_pref32(op.ra))), 0xf);
+	set_vr(op.rt, m_ir->CreateInsertElement(make_const(s_spu_insert_mask, get_type<u8[16]>()), m_ir->getInt8(0x03), t));
+}
+
+void spu_llvm_recompiler::CHX(spu_opcode_t op)
+{
+	const auto t = m_ir->CreateLShr(m_ir->CreateAnd(m_ir->CreateNot(m_ir->CreateAdd(get_pref32(op.rb), get_pref32(op.ra))), 0xe), 1);
+	set_vr(op.rt, m_ir->CreateInsertElement(make_const(s_spu_insert_mask, get_type<u16[8]>()), m_ir->getInt16(0x0203), t));
+}
+
+void spu_llvm_recompiler::CWX(spu_opcode_t op)
+{
+	const auto t = m_ir->CreateLShr(m_ir->CreateAnd(m_ir->CreateNot(m_ir->CreateAdd(get_pref32(op.rb), get_pref32(op.ra))), 0xc), 2);
+	set_vr(op.rt, m_ir->CreateInsertElement(make_const(s_spu_insert_mask, get_type<u32[4]>()), m_ir->getInt32(0x00010203), t));
+}
+
+void spu_llvm_recompiler::CDX(spu_opcode_t op)
+{
+	const auto t = m_ir->CreateLShr(m_ir->CreateAnd(m_ir->CreateNot(m_ir->CreateAdd(get_pref32(op.rb), get_pref32(op.ra))), 0x8), 3);
+	set_vr(op.rt, m_ir->CreateInsertElement(make_const(s_spu_insert_mask, get_type<u64[2]>()), m_ir->getInt64(0x0001020304050607ull), t));
+}
+
+void spu_llvm_recompiler::ROTQBI(spu_opcode_t op)
+{
+	const auto n = m_ir->CreateAnd(get_pref32(op.rb), 0x7);
+	set_vr(op.rt, vrotl(get_vr<u128>(op.ra), m_ir->CreateZExt(n, get_type<u128>())));
+}
+
+void spu_llvm_recompiler::ROTQMBI(spu_opcode_t op)
+{
+	const auto n = m_ir->CreateAnd(m_ir->CreateNeg(get_pref32(op.rb)), 0x7);
+	set_vr(op.rt, vlshr(get_vr<u128>(op.ra), m_ir->CreateZExt(n, get_type<u128>())));
+}
+
+void spu_llvm_recompiler::SHLQBI(spu_opcode_t op)
+{
+	const auto n = m_ir->CreateAnd(get_pref32(op.rb), 0x7);
+	set_vr(op.rt, vshl(get_vr<u128>(op.ra), m_ir->CreateZExt(n, get_type<u128>())));
+}
+
+void spu_llvm_recompiler::ROTQBY(spu_opcode_t op)
+{
+	const auto n = m_ir->CreateShl(m_ir->CreateAnd(get_pref32(op.rb), 0xf), 3);
+	set_vr(op.rt, vrotl(get_vr<u128>(op.ra), m_ir->CreateZExt(n, get_type<u128>())));
+}
+
+void spu_llvm_recompiler::ROTQMBY(spu_opcode_t op)
+{
+	const auto n = m_ir->CreateShl(m_ir->CreateAnd(m_ir->CreateNeg(get_pref32(op.rb)), 0x1f), 3);
+	set_vr(op.rt, vlshr(get_vr<u128>(op.ra), m_ir->CreateZExt(n, get_type<u128>())));
+}
+
+void spu_llvm_recompiler::SHLQBY(spu_opcode_t op)
+{
+	const auto n = m_ir->CreateShl(m_ir->CreateAnd(get_pref32(op.rb), 0x1f), 3);
+	set_vr(op.rt, vshl(get_vr<u128>(op.ra), m_ir->CreateZExt(n, get_type<u128>())));
+}
+
+void spu_llvm_recompiler::ORX(spu_opcode_t op)
+{
+	const auto a = get_vr<u32[4]>(op.ra);
+	const auto x = m_ir->CreateOr(m_ir->CreateExtractElement(a, m_ir->getInt32(0)), m_ir->CreateExtractElement(a, m_ir->getInt32(1)));
+	const auto y = m_ir->CreateOr(m_ir->CreateExtractElement(a, m_ir->getInt32(2)), m_ir->CreateExtractElement(a, m_ir->getInt32(3)));
+	set_vr(op.rt, m_ir->CreateInsertElement(splat<u32, 4>(0), m_ir->CreateOr(x, y), m_ir->getInt32(3)));
+}
+
+void spu_llvm_recompiler::CBD(spu_opcode_t op)
+{
+	const auto t = m_ir->CreateAnd(m_ir->CreateNot(m_ir->CreateAdd(get_pref32(op.ra), m_ir->getInt32(op.i7))), 0xf);
+	set_vr(op.rt, m_ir->CreateInsertElement(make_const(s_spu_insert_mask, get_type<u8[16]>()), m_ir->getInt8(0x03), t));
+}
+
+void spu_llvm_recompiler::CHD(spu_opcode_t op)
+{
+	const auto t = m_ir->CreateLShr(m_ir->CreateAnd(m_ir->CreateNot(m_ir->CreateAdd(get_pref32(op.ra), m_ir->getInt32(op.i7))), 0xe), 1);
+	set_vr(op.rt, m_ir->CreateInsertElement(make_const(s_spu_insert_mask, get_type<u16[8]>()), m_ir->getInt16(0x0203), t));
+}
+
+void spu_llvm_recompiler::CWD(spu_opcode_t op)
+{
+	const auto t = m_ir->CreateLShr(m_ir->CreateAnd(m_ir->CreateNot(m_ir->CreateAdd(get_pref32(op.ra), m_ir->getInt32(op.i7))), 0xc), 2);
+	set_vr(op.rt, m_ir->CreateInsertElement(make_const(s_spu_insert_mask, get_type<u32[4]>()), m_ir->getInt32(0x00010203), t));
+}
+
+void spu_llvm_recompiler::CDD(spu_opcode_t op)
+{
+	const auto t = m_ir->CreateLShr(m_ir->CreateAnd(m_ir->CreateNot(m_ir->CreateAdd(get_pref32(op.ra), m_ir->getInt32(op.i7))), 0x8), 3);
+	set_vr(op.rt, m_ir->CreateInsertElement(make_const(s_spu_insert_mask, get_type<u64[2]>()), m_ir->getInt64(0x0001020304050607ull), t));
+}
+
+void spu_llvm_recompiler::ROTQBII(spu_opcode_t op)
+{
+	set_vr(op.rt, vrotl(get_vr<u128>(op.ra), ConstantInt::get(get_type<u128>(), op.i7 & 0x7)));
+}
+
+void spu_llvm_recompiler::ROTQMBII(spu_opcode_t op)
+{
+	set_vr(op.rt, vlshr(get_vr<u128>(op.ra), ConstantInt::get(get_type<u128>(), 0 - op.i7 & 0x7)));
+}
+
+void spu_llvm_recompiler::SHLQBII(spu_opcode_t op)
+{
+	set_vr(op.rt, vshl(get_vr<u128>(op.ra), ConstantInt::get(get_type<u128>(), op.i7 & 0x7)));
+}
+
+void spu_llvm_recompiler::ROTQBYI(spu_opcode_t op)
+{
+	const u32 n = op.i7 & 0xf;
+	std::vector<u32> idx(16);
+
+	for (u32 i = 0; i < 16; i++)
+	{
+		idx[i] = (i - n) & 0xf;
+	}
+
+	set_vr(op.rt, shuffle(get_vr<u8[16]>(op.ra), nullptr, idx));
+}
+
+void spu_llvm_recompiler::ROTQMBYI(spu_opcode_t op)
+{
+	const u32 n = 0 - op.i7 & 0x1f;
+	std::vector<u32> idx(16);
+
+	for (u32 i = 0; i < 16; i++)
+	{
+		idx[i] = i + n < 16 ? i + n : 16;
+	}
+
+	set_vr(op.rt, shuffle(get_vr<u8[16]>(op.ra), splat<u8, 16>(0), idx));
+}
+
+void spu_llvm_recompiler::SHLQBYI(spu_opcode_t op)
+{
+	const u32 n = op.i7 & 0x1f;
+	std::vector<u32> idx(16);
+
+	for (u32 i = 0; i < 16; i++)
+	{
+		idx[i] = i >= n ? i - n : 16;
+	}
+
+	set_vr(op.rt, shuffle(get_vr<u8[16]>(op.ra), splat<u8, 16>(0), idx));
+}
+
+void spu_llvm_recompiler::NOP(spu_opcode_t op)
+{
+}
+
+void spu_llvm_recompiler::CGT(spu_opcode_t op)
+{
+	set_cmp<u32[4]>(op.rt, ICmpInst::ICMP_SGT, get_vr<u32[4]>(op.ra), get_vr<u32[4]>(op.rb));
+}
+
+void spu_llvm_recompiler::XOR(spu_opcode_t op)
+{
+	set_vr(op.rt, m_ir->CreateXor(get_vr<u32[4]>(op.ra), get_vr<u32[4]>(op.rb)));
+}
+
+void spu_llvm_recompiler::CGTH(spu_opcode_t op)
+{
+	set_cmp<u16[8]>(op.rt, ICmpInst::ICMP_SGT, get_vr<u16[8]>(op.ra), get_vr<u16[8]>(op.rb));
+}
+
+void spu_llvm_recompiler::EQV(spu_opcode_t op)
+{
+	set_vr(op.rt, m_ir->CreateNot(m_ir->CreateXor(get_vr<u32[4]>(op.ra), get_vr<u32[4]>(op.rb))));
+}
+
+void spu_llvm_recompiler::CGTB(spu_opcode_t op)
+{
+	set_cmp<u8[16]>(op.rt, ICmpInst::ICMP_SGT, get_vr<u8[16]>(op.ra), get_vr<u8[16]>(op.rb));
+}
+
+void spu_llvm_recompiler::SUMB(spu_opcode_t op)
+{
+	InterpreterCall(op);
+}
+
+void spu_llvm_recompiler::HGT(spu_opcode_t op)
+{
+	InterpreterCall(op);
+}
+
+void spu_llvm_recompiler::CLZ(spu_opcode_t op)
+{
+	set_vr(op.rt, call(get_type<u32[4]>(), "llvm.ctlz.v4i32", get_vr<u32[4]>(op.ra), m_ir->getFalse()));
+}
+
+void spu_llvm_recompiler::XSWD(spu_opcode_t op)
+{
+	set_vr(op.rt, m_ir->CreateAShr(m_ir->CreateShl(get_vr<u64[2]>(op.ra), 32), 32));
+}
+
+void spu_llvm_recompiler::XSHW(spu_opcode_t op)
+{
+	set_vr(op.rt, m_ir->CreateAShr(m_ir->CreateShl(get_vr<u32[4]>(op.ra), 16), 16));
+}
+
+void spu_llvm_recompiler::CNTB(spu_opcode_t op)
+{
+	set_vr(op.rt, call(get_type<u8[16]>(), "llvm.ctpop.v16i8", get_vr<u8[16]>(op.ra)));
+}
+
+void spu_llvm_recompiler::XSBH(spu_opcode_t op)
+{
+	set_vr(op.rt, m_ir->CreateAShr(m_ir->CreateShl(get_vr<u16[8]>(op.ra), 8), 8));
+}
+
+void spu_llvm_recompiler::CLGT(spu_opcode_t op)
+{
+	set_cmp<u32[4]>(op.rt, ICmpInst::ICMP_UGT, get_vr<u32[4]>(op.ra), get_vr<u32[4]>(op.rb));
+}
+
+void spu_llvm_recompiler::ANDC(spu_opcode_t op)
+{
+	set_vr(op.rt, m_ir->CreateAnd(get_vr<u32[4]>(op.ra), m_ir->CreateNot(get_vr<u32[4]>(op.rb))));
+}
+
+void spu_llvm_recompiler::FCGT(spu_opcode_t op)
+{
+	set_vr(op.rt, m_ir->CreateSExt(m_ir->CreateFCmpOGT(get_vr<f32[4]>(op.ra), get_vr<f32[4]>(op.rb)), get_type<u32[4]>()));
+}
+
+void spu_llvm_recompiler::DFCGT(spu_opcode_t op)
+{
+	InterpreterCall(op);
+}
+
+void spu_llvm_recompiler::FA(spu_opcode_t op)
+{
+	set_vr(op.rt, m_ir->CreateFAdd(get_vr<f32[4]>(op.ra), get_vr<f32[4]>(op.rb)));
+}
+
+void spu_llvm_recompiler::FS(spu_opcode_t op)
+{
+	set_vr(op.rt, m_ir->CreateFSub(get_vr<f32[4]>(op.ra), get_vr<f32[4]>(op.rb)));
+}
+
+void spu_llvm_recompiler::FM(spu_opcode_t op)
+{
+	set_vr(op.rt, m_ir->CreateFMul(get_vr<f32[4]>(op.ra), get_vr<f32[4]>(op.rb)));
+}
+
+void spu_llvm_recompiler::CLGTH(spu_opcode_t op)
+{
+	set_cmp<u16[8]>(op.rt, ICmpInst::ICMP_UGT, get_vr<u16[8]>(op.ra), get_vr<u16[8]>(op.rb));
+}
+
+void spu_llvm_recompiler::ORC(spu_opcode_t op)
+{
+	set_vr(op.rt, m_ir->CreateOr(get_vr<u32[4]>(op.ra), m_ir->CreateNot(get_vr<u32[4]>(op.rb))));
+}
+
+void spu_llvm_recompiler::FCMGT(spu_opcode_t op)
+{
+	// Compare absolute values
+	const auto a = bitcast(m_ir->CreateAnd(get_vr<u32[4]>(op.ra), 0x7fffffff), get_type<f32[4]>());
+	const auto b = bitcast(m_ir->CreateAnd(get_vr<u32[4]>(op.rb), 0x7fffffff), get_type<f32[4]>());
+	set_vr(op.rt, m_ir->CreateSExt(m_ir->CreateFCmpOGT(a, b), get_type<u32[4]>()));
+}
+
+void spu_llvm_recompiler::DFCMGT(spu_opcode_t op)
+{
+	InterpreterCall(op);
+}
+
+void spu_llvm_recompiler::DFA(spu_opcode_t op)
+{
+	set_vr(op.rt, m_ir->CreateFAdd(get_vr<f64[2]>(op.ra), get_vr<f64[2]>(op.rb)));
+}
+
+void spu_llvm_recompiler::DFS(spu_opcode_t op)
+{
+	set_vr(op.rt, m_ir->CreateFSub(get_vr<f64[2]>(op.ra), get_vr<f64[2]>(op.rb)));
+}
+
+void spu_llvm_recompiler::DFM(spu_opcode_t op)
+{
+	set_vr(op.rt, m_ir->CreateFMul(get_vr<f64[2]>(op.ra), get_vr<f64[2]>(op.rb)));
+}
+
+void spu_llvm_recompiler::CLGTB(spu_opcode_t op)
+{
+	set_cmp<u8[16]>(op.rt, ICmpInst::ICMP_UGT, get_vr<u8[16]>(op.ra), get_vr<u8[16]>(op.rb));
+}
+
+void spu_llvm_recompiler::HLGT(spu_opcode_t op)
+{
+	InterpreterCall(op);
+}
+
+void spu_llvm_recompiler::DFMA(spu_opcode_t op)
+{
+	const auto mul = m_ir->CreateFMul(get_vr<f64[2]>(op.ra), get_vr<f64[2]>(op.rb));
+	set_vr(op.rt, m_ir->CreateFAdd(mul, get_vr<f64[2]>(op.rt)));
+}
+
+void spu_llvm_recompiler::DFMS(spu_opcode_t op)
+{
+	const auto mul = m_ir->CreateFMul(get_vr<f64[2]>(op.ra), get_vr<f64[2]>(op.rb));
+	set_vr(op.rt, m_ir->CreateFSub(mul, get_vr<f64[2]>(op.rt)));
+}
+
+void spu_llvm_recompiler::DFNMS(spu_opcode_t op)
+{
+	const auto mul = m_ir->CreateFMul(get_vr<f64[2]>(op.ra), get_vr<f64[2]>(op.rb));
+	set_vr(op.rt, m_ir->CreateFSub(get_vr<f64[2]>(op.rt), mul));
+}
+
+void spu_llvm_recompiler::DFNMA(spu_opcode_t op)
+{
+	const auto mul = m_ir->CreateFMul(get_vr<f64[2]>(op.ra), get_vr<f64[2]>(op.rb));
+	set_vr(op.rt, m_ir->CreateFSub(ConstantFP::get(get_type<f64[2]>(), 0.0), m_ir->CreateFAdd(mul, get_vr<f64[2]>(op.rt))));
+}
+
+void spu_llvm_recompiler::CEQ(spu_opcode_t op)
+{
+	set_cmp<u32[4]>(op.rt, ICmpInst::ICMP_EQ, get_vr<u32[4]>(op.ra), get_vr<u32[4]>(op.rb));
+}
+
+void spu_llvm_recompiler::MPYHHU(spu_opcode_t op)
+{
+	set_vr(op.rt, m_ir->CreateMul(m_ir->CreateLShr(get_vr<u32[4]>(op.ra), 16), m_ir->CreateLShr(get_vr<u32[4]>(op.rb), 16)));
+}
+
+void spu_llvm_recompiler::ADDX(spu_opcode_t op)
+{
+	const auto carry = m_ir->CreateAnd(get_vr<u32[4]>(op.rt), 1);
+	set_vr(op.rt, m_ir->CreateAdd(m_ir->CreateAdd(get_vr<u32[4]>(op.ra), get_vr<u32[4]>(op.rb)), carry));
+}
+
+void spu_llvm_recompiler::SFX(spu_opcode_t op)
+{
+	const auto borrow = m_ir->CreateAnd(m_ir->CreateNot(get_vr<u32[4]>(op.rt)), 1);
+	set_vr(op.rt, m_ir->CreateSub(m_ir->CreateSub(get_vr<u32[4]>(op.rb), get_vr<u32[4]>(op.ra)), borrow));
+}
+
+void spu_llvm_recompiler::CGX(spu_opcode_t op)
+{
+	InterpreterCall(op);
+}
+
+void spu_llvm_recompiler::BGX(spu_opcode_t op)
+{
+	InterpreterCall(op);
+}
+
+void spu_llvm_recompiler::MPYHHA(spu_opcode_t op)
+{
+	const auto mul = m_ir->CreateMul(m_ir->CreateAShr(get_vr<u32[4]>(op.ra), 16), m_ir->CreateAShr(get_vr<u32[4]>(op.rb), 16));
+	set_vr(op.rt, m_ir->CreateAdd(get_vr<u32[4]>(op.rt), mul));
+}
+
+void spu_llvm_recompiler::MPYHHAU(spu_opcode_t op)
+{
+	const auto mul = m_ir->CreateMul(m_ir->CreateLShr(get_vr<u32[4]>(op.ra), 16), m_ir->CreateLShr(get_vr<u32[4]>(op.rb), 16));
+	set_vr(op.rt, m_ir->CreateAdd(get_vr<u32[4]>(op.rt), mul));
+}
+
+void spu_llvm_recompiler::FSCRRD(spu_opcode_t op)
+{
+	InterpreterCall(op);
+}
+
+void spu_llvm_recompiler::FESD(spu_opcode_t op)
+{
+	InterpreterCall(op);
+}
+
+void spu_llvm_recompiler::FRDS(spu_opcode_t op)
+{
+	InterpreterCall(op);
+}
+
+void spu_llvm_recompiler::FSCRWR(spu_opcode_t op)
+{
+	InterpreterCall(op);
+}
+
+void spu_llvm_recompiler::DFTSV(spu_opcode_t op)
+{
+	InterpreterCall(op);
+}
+
+void spu_llvm_recompiler::FCEQ(spu_opcode_t op)
+{
+	set_vr(op.rt, m_ir->CreateSExt(m_ir->CreateFCmpOEQ(get_vr<f32[4]>(op.ra), get_vr<f32[4]>(op.rb)), get_type<u32[4]>()));
+}
+
+void spu_llvm_recompiler::DFCEQ(spu_opcode_t op)
+{
+	InterpreterCall(op);
+}
+
+void spu_llvm_recompiler::MPY(spu_opcode_t op)
+{
+	set_vr(op.rt, m_ir->CreateMul(ext16(get_vr<u32[4]>(op.ra), true), ext16(get_vr<u32[4]>(op.rb), true)));
+}
+
+void spu_llvm_recompiler::MPYH(spu_opcode_t op)
+{
+	const auto mul = m_ir->CreateMul(m_ir->CreateLShr(get_vr<u32[4]>(op.ra), 16), get_vr<u32[4]>(op.rb));
+	set_vr(op.rt, m_ir->CreateShl(mul, 16));
+}
+
+void spu_llvm_recompiler::MPYHH(spu_opcode_t op)
+{
+	set_vr(op.rt, m_ir->CreateMul(m_ir->CreateAShr(get_vr<u32[4]>(op.ra), 16), m_ir->CreateAShr(get_vr<u32[4]>(op.rb), 16)));
+}
+
+void spu_llvm_recompiler::MPYS(spu_opcode_t op)
+{
+	const auto mul = m_ir->CreateMul(ext16(get_vr<u32[4]>(op.ra), true), ext16(get_vr<u32[4]>(op.rb), true));
+	set_vr(op.rt, m_ir->CreateAShr(mul, 16));
+}
+
+void spu_llvm_recompiler::CEQH(spu_opcode_t op)
+{
+	set_cmp<u16[8]>(op.rt, ICmpInst::ICMP_EQ, get_vr<u16[8]>(op.ra), get_vr<u16[8]>(op.rb));
+}
+
+void spu_llvm_recompiler::FCMEQ(spu_opcode_t op)
+{
+	const auto a = bitcast(m_ir->CreateAnd(get_vr<u32[4]>(op.ra), 0x7fffffff), get_type<f32[4]>());
+	const auto b = bitcast(m_ir->CreateAnd(get_vr<u32[4]>(op.rb), 0x7fffffff), get_type<f32[4]>());
+	set_vr(op.rt, m_ir->CreateSExt(m_ir->CreateFCmpOEQ(a, b), get_type<u32[4]>()));
+}
+
+void spu_llvm_recompiler::DFCMEQ(spu_opcode_t op)
+{
+	InterpreterCall(op);
+}
+
+void spu_llvm_recompiler::MPYU(spu_opcode_t op)
+{
+	set_vr(op.rt, m_ir->CreateMul(ext16(get_vr<u32[4]>(op.ra), false), ext16(get_vr<u32[4]>(op.rb), false)));
+}
+
+void spu_llvm_recompiler::CEQB(spu_opcode_t op)
+{
+	set_cmp<u8[16]>(op.rt, ICmpInst::ICMP_EQ, get_vr<u8[16]>(op.ra), get_vr<u8[16]>(op.rb));
+}
+
+void spu_llvm_recompiler::FI(spu_opcode_t op)
+{
+	InterpreterCall(op);
+}
+
+void spu_llvm_recompiler::HEQ(spu_opcode_t op)
+{
+	InterpreterCall(op);
+}
+
+void spu_llvm_recompiler::CFLTS(spu_opcode_t op)
+{
+	InterpreterCall(op);
+}
+
+void spu_llvm_recompiler::CFLTU(spu_opcode_t op)
+{
+	InterpreterCall(op);
+}
+
+void spu_llvm_recompiler::CSFLT(spu_opcode_t op)
+{
+	InterpreterCall(op);
+}
+
+void spu_llvm_recompiler::CUFLT(spu_opcode_t op)
+{
+	InterpreterCall(op);
+}
+
+void spu_llvm_recompiler::BRZ(spu_opcode_t op)
+{
+	const u32 target = spu_branch_target(m_pos, op.i16);
+
+	if (target == m_pos) fmt::throw_exception("Branch-to-self (0x%05x)" HERE, target);
+
+	branch_if(m_ir->CreateICmpEQ(get_pref32(op.rt), m_ir->getInt32(0)), target, "brz");
+}
+
+void spu_llvm_recompiler::STQA(spu_opcode_t op)
+{
+	m_ir->CreateAlignedStore(byteswap(get_vr<u8[16]>(op.rt)), ls_ptr(m_ir->getInt32(spu_ls_target(0, op.i16))), 16);
+}
+
+void spu_llvm_recompiler::BRNZ(spu_opcode_t op)
+{
+	const u32 target = spu_branch_target(m_pos, op.i16);
+
+	if (target == m_pos) fmt::throw_exception("Branch-to-self (0x%05x)" HERE, target);
+
+	branch_if(m_ir->CreateICmpNE(get_pref32(op.rt), m_ir->getInt32(0)), target, "brnz");
+}
+
+void spu_llvm_recompiler::BRHZ(spu_opcode_t op)
+{
+	const u32 target = spu_branch_target(m_pos, op.i16);
+
+	if (target == m_pos) fmt::throw_exception("Branch-to-self (0x%05x)" HERE, target);
+
+	const auto value = m_ir->CreateExtractElement(get_vr<u16[8]>(op.rt), m_ir->getInt32(6));
+	branch_if(m_ir->CreateICmpEQ(value, m_ir->getInt16(0)), target, "brhz");
+}
+
+void spu_llvm_recompiler::BRHNZ(spu_opcode_t op)
+{
+	const u32 target = spu_branch_target(m_pos, op.i16);
+
+	if (target == m_pos) fmt::throw_exception("Branch-to-self (0x%05x)" HERE, target);
+
+	const auto value = m_ir->CreateExtractElement(get_vr<u16[8]>(op.rt), m_ir->getInt32(6));
+	branch_if(m_ir->CreateICmpNE(value, m_ir->getInt16(0)), target, "brhnz");
+}
+
+void spu_llvm_recompiler::STQR(spu_opcode_t op)
+{
+	m_ir->CreateAlignedStore(byteswap(get_vr<u8[16]>(op.rt)), ls_ptr(m_ir->getInt32(spu_ls_target(m_pos, op.i16))), 16);
+}
+
+void spu_llvm_recompiler::BRA(spu_opcode_t op)
+{
+	const u32 target = spu_branch_target(0, op.i16);
+
+	if (target == m_pos) fmt::throw_exception("Branch-to-self (0x%05x)" HERE, target);
+
+	m_ir->CreateBr(get_target(target, "bra"));
+}
+
+void spu_llvm_recompiler::LQA(spu_opcode_t op)
+{
+	set_vr(op.rt, byteswap(m_ir->CreateAlignedLoad(ls_ptr(m_ir->getInt32(spu_ls_target(0, op.i16))), 16)));
+}
+
+void spu_llvm_recompiler::BRASL(spu_opcode_t op)
+{
+	const u32 target = spu_branch_target(0, op.i16);
+
+	if (target == m_pos) fmt::throw_exception("Branch-to-self (0x%05x)" HERE, target);
+
+	if (target == spu_branch_target(m_pos + 4))
+	{
+		// branch-to-next
+		set_vr(op.rt, make_const(v128::from32r(target), get_type<u32[4]>()));
+		return;
+	}
+
+	FunctionCall(m_ir->getInt32(target), op);
+}
+
+void spu_llvm_recompiler::BR(spu_opcode_t op)
+{
+	const u32 target = spu_branch_target(m_pos, op.i16);
+
+	if (target == m_pos)
+	{
+		// Branch-to-self: stop the thread (same as the ASMJIT recompiler)
+		m_ir->CreateAtomicRMW(AtomicRMWInst::Or, spu_ptr<u32>(OFFSET_32(SPUThread, state)), m_ir->getInt32(static_cast<u32>(cpu_flag::stop + cpu_flag::ret)), AtomicOrdering::SequentiallyConsistent);
+		ret_addr(m_ir->getInt32(target | 0x2000000));
+		return;
+	}
+
+	m_ir->CreateBr(get_target(target, "br"));
+}
+
+void spu_llvm_recompiler::FSMBI(spu_opcode_t op)
+{
+	set_vr(op.rt, make_const(g_spu_imm.fsmb[op.i16], get_type<u32[4]>()));
+}
+
+void spu_llvm_recompiler::BRSL(spu_opcode_t op)
+{
+	const u32 target = spu_branch_target(m_pos, op.i16);
+
+	if (target == m_pos) fmt::throw_exception("Branch-to-self (0x%05x)" HERE, target);
+
+	if (target == spu_branch_target(m_pos + 4))
+	{
+		// branch-to-next
+		set_vr(op.rt, make_const(v128::from32r(target), get_type<u32[4]>()));
+		return;
+	}
+
+	FunctionCall(m_ir->getInt32(target), op);
+}
+
+void spu_llvm_recompiler::LQR(spu_opcode_t op)
+{
+	set_vr(op.rt, byteswap(m_ir->CreateAlignedLoad(ls_ptr(m_ir->getInt32(spu_ls_target(m_pos, op.i16))), 16)));
+}
+
+void spu_llvm_recompiler::IL(spu_opcode_t op)
+{
+	set_vr(op.rt, splat<u32, 4>(op.si16));
+}
+
+void spu_llvm_recompiler::ILHU(spu_opcode_t op)
+{
+	set_vr(op.rt, splat<u32, 4>(op.i16 << 16));
+}
+
+void spu_llvm_recompiler::ILH(spu_opcode_t op)
+{
+	set_vr(op.rt, splat<u16, 8>(op.i16));
+}
+
+void spu_llvm_recompiler::IOHL(spu_opcode_t op)
+{
+	set_vr(op.rt, m_ir->CreateOr(get_vr<u32[4]>(op.rt), splat<u32, 4>(op.i16)));
+}
+
+void spu_llvm_recompiler::ORI(spu_opcode_t op)
+{
+	set_vr(op.rt, m_ir->CreateOr(get_vr<u32[4]>(op.ra), splat<u32, 4>(op.si10)));
+}
+
+void spu_llvm_recompiler::ORHI(spu_opcode_t op)
+{
+	set_vr(op.rt, m_ir->CreateOr(get_vr<u16[8]>(op.ra), splat<u16, 8>(op.si10)));
+}
+
+void spu_llvm_recompiler::ORBI(spu_opcode_t op)
+{
+	set_vr(op.rt, m_ir->CreateOr(get_vr<u8[16]>(op.ra), splat<u8, 16>(op.si10)));
+}
+
+void spu_llvm_recompiler::SFI(spu_opcode_t op)
+{
+	set_vr(op.rt, m_ir->CreateSub(splat<u32, 4>(op.si10), get_vr<u32[4]>(op.ra)));
+}
+
+void spu_llvm_recompiler::SFHI(spu_opcode_t op)
+{
+	set_vr(op.rt, m_ir->CreateSub(splat<u16, 8>(op.si10), get_vr<u16[8]>(op.ra)));
+}
+
+void spu_llvm_recompiler::ANDI(spu_opcode_t op)
+{
+	set_vr(op.rt, m_ir->CreateAnd(get_vr<u32[4]>(op.ra), splat<u32, 4>(op.si10)));
+}
+
+void spu_llvm_recompiler::ANDHI(spu_opcode_t op)
+{
+	set_vr(op.rt, m_ir->CreateAnd(get_vr<u16[8]>(op.ra), splat<u16, 8>(op.si10)));
+}
+
+void spu_llvm_recompiler::ANDBI(spu_opcode_t op)
+{
+	set_vr(op.rt, m_ir->CreateAnd(get_vr<u8[16]>(op.ra), splat<u8, 16>(op.si10)));
+}
+
+void spu_llvm_recompiler::AI(spu_opcode_t op)
+{
+	set_vr(op.rt, m_ir->CreateAdd(get_vr<u32[4]>(op.ra), splat<u32, 4>(op.si10)));
+}
+
+void spu_llvm_recompiler::AHI(spu_opcode_t op)
+{
+	set_vr(op.rt, m_ir->CreateAdd(get_vr<u16[8]>(op.ra), splat<u16, 8>(op.si10)));
+}
+
+void spu_llvm_recompiler::STQD(spu_opcode_t op)
+{
+	const auto addr = m_ir->CreateAdd(get_pref32(op.ra), m_ir->getInt32(op.si10 << 4));
+	m_ir->CreateAlignedStore(byteswap(get_vr<u8[16]>(op.rt)), ls_ptr(addr), 16);
+}
+
+void spu_llvm_recompiler::LQD(spu_opcode_t op)
+{
+	const auto addr = m_ir->CreateAdd(get_pref32(op.ra), m_ir->getInt32(op.si10 << 4));
+	set_vr(op.rt, byteswap(m_ir->CreateAlignedLoad(ls_ptr(addr), 16)));
+}
+
+void spu_llvm_recompiler::XORI(spu_opcode_t op)
+{
+	set_vr(op.rt, m_ir->CreateXor(get_vr<u32[4]>(op.ra), splat<u32, 4>(op.si10)));
+}
+
+void spu_llvm_recompiler::XORHI(spu_opcode_t op)
+{
+	set_vr(op.rt, m_ir->CreateXor(get_vr<u16[8]>(op.ra), splat<u16, 8>(op.si10)));
+}
+
+void spu_llvm_recompiler::XORBI(spu_opcode_t op)
+{
+	set_vr(op.rt, m_ir->CreateXor(get_vr<u8[16]>(op.ra), splat<u8, 16>(op.si10)));
+}
+
+void spu_llvm_recompiler::CGTI(spu_opcode_t op)
+{
+	set_cmp<u32[4]>(op.rt, ICmpInst::ICMP_SGT, get_vr<u32[4]>(op.ra), splat<u32, 4>(op.si10));
+}
+
+void spu_llvm_recompiler::CGTHI(spu_opcode_t op)
+{
+	set_cmp<u16[8]>(op.rt, ICmpInst::ICMP_SGT, get_vr<u16[8]>(op.ra), splat<u16, 8>(op.si10));
+}
+
+void spu_llvm_recompiler::CGTBI(spu_opcode_t op)
+{
+	set_cmp<u8[16]>(op.rt, ICmpInst::ICMP_SGT, get_vr<u8[16]>(op.ra), splat<u8, 16>(op.si10));
+}
+
+void spu_llvm_recompiler::HGTI(spu_opcode_t op)
+{
+	InterpreterCall(op);
+}
+
+void spu_llvm_recompiler::CLGTI(spu_opcode_t op)
+{
+	set_cmp<u32[4]>(op.rt, ICmpInst::ICMP_UGT, get_vr<u32[4]>(op.ra), splat<u32, 4>(op.si10));
+}
+
+void spu_llvm_recompiler::CLGTHI(spu_opcode_t op)
+{
+	set_cmp<u16[8]>(op.rt, ICmpInst::ICMP_UGT, get_vr<u16[8]>(op.ra), splat<u16, 8>(op.si10));
+}
+
+void spu_llvm_recompiler::CLGTBI(spu_opcode_t op)
+{
+	set_cmp<u8[16]>(op.rt, ICmpInst::ICMP_UGT, get_vr<u8[16]>(op.ra), splat<u8, 16>(op.si10));
+}
+
+void spu_llvm_recompiler::HLGTI(spu_opcode_t op)
+{
+	InterpreterCall(op);
+}
+
+void spu_llvm_recompiler::MPYI(spu_opcode_t op)
+{
+	set_vr(op.rt, m_ir->CreateMul(ext16(get_vr<u32[4]>(op.ra), true), splat<u32, 4>(op.si10)));
+}
+
+void spu_llvm_recompiler::MPYUI(spu_opcode_t op)
+{
+	set_vr(op.rt, m_ir->CreateMul(ext16(get_vr<u32[4]>(op.ra), false), splat<u32, 4>(op.si10 & 0xffff)));
+}
+
+void spu_llvm_recompiler::CEQI(spu_opcode_t op)
+{
+	set_cmp<u32[4]>(op.rt, ICmpInst::ICMP_EQ, get_vr<u32[4]>(op.ra), splat<u32, 4>(op.si10));
+}
+
+void spu_llvm_recompiler::CEQHI(spu_opcode_t op)
+{
+	set_cmp<u16[8]>(op.rt, ICmpInst::ICMP_EQ, get_vr<u16[8]>(op.ra), splat<u16, 8>(op.si10));
+}
+
+void spu_llvm_recompiler::CEQBI(spu_opcode_t op)
+{
+	set_cmp<u8[16]>(op.rt, ICmpInst::ICMP_EQ, get_vr<u8[16]>(op.ra), splat<u8, 16>(op.si10));
+}
+
+void spu_llvm_recompiler::HEQI(spu_opcode_t op)
+{
+	InterpreterCall(op);
+}
+
+void spu_llvm_recompiler::HBRA(spu_opcode_t op)
+{
+}
+
+void spu_llvm_recompiler::HBRR(spu_opcode_t op)
+{
+}
+
+void spu_llvm_recompiler::ILA(spu_opcode_t op)
+{
+	set_vr(op.rt, splat<u32, 4>(op.i18));
+}
+
+void spu_llvm_recompiler::SELB(spu_opcode_t op)
+{
+	const auto c = get_vr<u32[4]>(op.rc);
+	const auto a = m_ir->CreateAnd(get_vr<u32[4]>(op.ra), m_ir->CreateNot(c));
+	set_vr(op.rt4, m_ir->CreateOr(m_ir->CreateAnd(get_vr<u32[4]>(op.rb), c), a));
+}
+
+void spu_llvm_recompiler::SHUFB(spu_opcode_t op)
+{
+	set_vr(op.rt4, shufb(get_vr<u8[16]>(op.ra), get_vr<u8[16]>(op.rb), get_vr<u8[16]>(op.rc)));
+}
+
+void spu_llvm_recompiler::MPYA(spu_opcode_t op)
+{
+	const auto mul = m_ir->CreateMul(ext16(get_vr<u32[4]>(op.ra), true), ext16(get_vr<u32[4]>(op.rb), true));
+	set_vr(op.rt4, m_ir->CreateAdd(mul, get_vr<u32[4]>(op.rc)));
+}
+
+void spu_llvm_recompiler::FNMS(spu_opcode_t op)
+{
+	const auto mul = m_ir->CreateFMul(get_vr<f32[4]>(op.ra), get_vr<f32[4]>(op.rb));
+	set_vr(op.rt4, m_ir->CreateFSub(get_vr<f32[4]>(op.rc), mul));
+}
+
+void spu_llvm_recompiler::FMA(spu_opcode_t op)
+{
+	const auto mul = m_ir->CreateFMul(get_vr<f32[4]>(op.ra), get_vr<f32[4]>(op.rb));
+	set_vr(op.rt4, m_ir->CreateFAdd(mul, get_vr<f32[4]>(op.rc)));
+}
+
+void spu_llvm_recompiler::FMS(spu_opcode_t op)
+{
+	const auto mul = m_ir->CreateFMul(get_vr<f32[4]>(op.ra), get_vr<f32[4]>(op.rb));
+	set_vr(op.rt4, m_ir->CreateFSub(mul, get_vr<f32[4]>(op.rc)));
+}
+
+void spu_llvm_recompiler::UNK(spu_opcode_t op)
+{
+	LOG_ERROR(SPU, "0x%05x: Unknown/Illegal opcode (0x%08x)", m_pos, op.opcode);
+	InterpreterCall(op);
+}
+
+#endif
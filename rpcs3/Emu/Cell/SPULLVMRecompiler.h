@@ -0,0 +1,349 @@
+#pragma once
+
+#ifdef LLVM_AVAILABLE
+
+#include "SPURecompiler.h"
+#include "../CPU/CPUTranslator.h"
+
+#include <bitset>
+
+class jit_compiler;
+
+// SPU LLVM Recompiler
+class spu_llvm_recompiler : public spu_recompiler_base, public cpu_translator
+{
+	// Context shared by all generated modules (compile() is serialized by m_mutex)
+	llvm::LLVMContext m_llvm;
+
+	std::unique_ptr<jit_compiler> m_jit;
+
+	// Counter for unique function names
+	u32 m_count = 0;
+
+	// Current function
+	llvm::Function* m_function;
+
+	// Function arguments: SPUThread*, LS base (both i8*)
+	llvm::Value* m_thread;
+	llvm::Value* m_lsptr;
+
+	// Exit address variable (returned from the function)
+	llvm::Value* m_addr;
+
+	// Register variables (allocas), only created for registers referenced by the function
+	std::array<llvm::Value*, 128> m_gpr;
+
+	// Current register values in the current basic block (nullptr if not known)
+	std::array<llvm::Value*, 128> m_cache;
+
+	// Registers referenced by the function
+	std::bitset<128> m_regs_used;
+
+	// Registers possibly modified by the function
+	std::bitset<128> m_regs_mod;
+
+	// Basic blocks for block entries
+	std::unordered_map<u32, llvm::BasicBlock*> m_blocks;
+
+	// Jump table resolver (uses m_addr)
+	llvm::BasicBlock* m_jt;
+
+	// Function end (returns m_addr)
+	llvm::BasicBlock* m_end;
+
+	// Get pointer to SPUThread member at the specified offset
+	template<typename T>
+	llvm::Value* spu_ptr(u32 offset)
+	{
+		return m_ir->CreateBitCast(m_ir->CreateConstGEP1_32(m_thread, offset), get_type<T>()->getPointerTo());
+	}
+
+	// Get pointer to the register in SPUThread
+	llvm::Value* spu_gpr_ptr(u32 index);
+
+	// Load register (as the specified vector type)
+	llvm::Value* get_vr_raw(u32 index);
+
+	template<typename T>
+	llvm::Value* get_vr(u32 index)
+	{
+		return bitcast(get_vr_raw(index), get_type<T>());
+	}
+
+	// Get preferred slot (word element 0) of the register
+	llvm::Value* get_pref32(u32 index);
+
+	// Set register (any 128-bit vector type)
+	void set_vr(u32 index, llvm::Value* value);
+
+	// Store register variables to SPUThread
+	void spill(const std::bitset<128>& regs);
+
+	// Load register variables from SPUThread
+	void reload(const std::bitset<128>& regs);
+
+	// Start new basic block (if the current one is terminated) and forget cached register values
+	void enter_block(llvm::BasicBlock* block);
+
+	// Leave the function with the address value
+	void ret_addr(llvm::Value* addr);
+
+	// Get block for branch target (or a stub which leaves the function)
+	llvm::BasicBlock* get_target(u32 target, const char* hint);
+
+	// Branch to the target address if the condition is true, otherwise fall through
+	void branch_if(llvm::Value* cond, u32 target, const char* hint);
+
+	// Indirect branch to the address (0x3fffc mask applied) using jump table resolver
+	void branch_indirect(llvm::Value* cond, spu_opcode_t op);
+
+	// Leave the function if the result of a gate is not zero
+	void check_result(llvm::Value* result);
+
+	// Zero-extend or sign-extend lower halfwords of words
+	llvm::Value* ext16(llvm::Value* value, bool is_signed);
+
+	// Compare and set all bits if true
+	template<typename T>
+	void set_cmp(u32 rt, llvm::CmpInst::Predicate pred, llvm::Value* a, llvm::Value* b)
+	{
+		set_vr(rt, m_ir->CreateSExt(m_ir->CreateICmp(pred, a, b), get_type<T>()));
+	}
+
+	// Shuffle bytes using SHUFB control vector
+	llvm::Value* shufb(llvm::Value* a, llvm::Value* b, llvm::Value* c);
+
+	// Element shifts with SPU semantics (shift count not masked by element size)
+	llvm::Value* vshl(llvm::Value* a, llvm::Value* n);
+	llvm::Value* vlshr(llvm::Value* a, llvm::Value* n);
+	llvm::Value* vashr(llvm::Value* a, llvm::Value* n);
+	llvm::Value* vrotl(llvm::Value* a, llvm::Value* n);
+
+	// Get constant value of the vector (returns false if not a constant)
+	bool get_const(llvm::Value* value, v128& data);
+
+	// Make vector constant of the specified type
+	llvm::Constant* make_const(const v128& data, llvm::Type* type);
+
+	// Bitcast which always folds constants (IRBuilder leaves bitcasts between different vector types unfolded)
+	llvm::Value* bitcast(llvm::Value* value, llvm::Type* type);
+
+	// Get pointer to the LS quadword (address is masked)
+	llvm::Value* ls_ptr(llvm::Value* addr);
+
+	// Block which leaves the function with the target address (or m_addr if null) if the thread state is set
+	llvm::BasicBlock* check_state(llvm::Value* target, llvm::BasicBlock* next);
+
+public:
+	spu_llvm_recompiler();
+	~spu_llvm_recompiler();
+
+	virtual void compile(spu_function_t& f) override;
+
+	void InterpreterCall(spu_opcode_t op);
+	void FunctionCall(llvm::Value* target, spu_opcode_t op);
+
+	void STOP(spu_opcode_t op);
+	void LNOP(spu_opcode_t op);
+	void SYNC(spu_opcode_t op);
+	void DSYNC(spu_opcode_t op);
+	void MFSPR(spu_opcode_t op);
+	void RDCH(spu_opcode_t op);
+	void RCHCNT(spu_opcode_t op);
+	void SF(spu_opcode_t op);
+	void OR(spu_opcode_t op);
+	void BG(spu_opcode_t op);
+	void SFH(spu_opcode_t op);
+	void NOR(spu_opcode_t op);
+	void ABSDB(spu_opcode_t op);
+	void ROT(spu_opcode_t op);
+	void ROTM(spu_opcode_t op);
+	void ROTMA(spu_opcode_t op);
+	void SHL(spu_opcode_t op);
+	void ROTH(spu_opcode_t op);
+	void ROTHM(spu_opcode_t op);
+	void ROTMAH(spu_opcode_t op);
+	void SHLH(spu_opcode_t op);
+	void ROTI(spu_opcode_t op);
+	void ROTMI(spu_opcode_t op);
+	void ROTMAI(spu_opcode_t op);
+	void SHLI(spu_opcode_t op);
+	void ROTHI(spu_opcode_t op);
+	void ROTHMI(spu_opcode_t op);
+	void ROTMAHI(spu_opcode_t op);
+	void SHLHI(spu_opcode_t op);
+	void A(spu_opcode_t op);
+	void AND(spu_opcode_t op);
+	void CG(spu_opcode_t op);
+	void AH(spu_opcode_t op);
+	void NAND(spu_opcode_t op);
+	void AVGB(spu_opcode_t op);
+	void MTSPR(spu_opcode_t op);
+	void WRCH(spu_opcode_t op);
+	void BIZ(spu_opcode_t op);
+	void BINZ(spu_opcode_t op);
+	void BIHZ(spu_opcode_t op);
+	void BIHNZ(spu_opcode_t op);
+	void STOPD(spu_opcode_t op);
+	void STQX(spu_opcode_t op);
+	void BI(spu_opcode_t op);
+	void BISL(spu_opcode_t op);
+	void IRET(spu_opcode_t op);
+	void BISLED(spu_opcode_t op);
+	void HBR(spu_opcode_t op);
+	void GB(spu_opcode_t op);
+	void GBH(spu_opcode_t op);
+	void GBB(spu_opcode_t op);
+	void FSM(spu_opcode_t op);
+	void FSMH(spu_opcode_t op);
+	void FSMB(spu_opcode_t op);
+	void FREST(spu_opcode_t op);
+	void FRSQEST(spu_opcode_t op);
+	void LQX(spu_opcode_t op);
+	void ROTQBYBI(spu_opcode_t op);
+	void ROTQMBYBI(spu_opcode_t op);
+	void SHLQBYBI(spu_opcode_t op);
+	void CBX(spu_opcode_t op);
+	void CHX(spu_opcode_t op);
+	void CWX(spu_opcode_t op);
+	void CDX(spu_opcode_t op);
+	void ROTQBI(spu_opcode_t op);
+	void ROTQMBI(spu_opcode_t op);
+	void SHLQBI(spu_opcode_t op);
+	void ROTQBY(spu_opcode_t op);
+	void ROTQMBY(spu_opcode_t op);
+	void SHLQBY(spu_opcode_t op);
+	void ORX(spu_opcode_t op);
+	void CBD(spu_opcode_t op);
+	void CHD(spu_opcode_t op);
+	void CWD(spu_opcode_t op);
+	void CDD(spu_opcode_t op);
+	void ROTQBII(spu_opcode_t op);
+	void ROTQMBII(spu_opcode_t op);
+	void SHLQBII(spu_opcode_t op);
+	void ROTQBYI(spu_opcode_t op);
+	void ROTQMBYI(spu_opcode_t op);
+	void SHLQBYI(spu_opcode_t op);
+	void NOP(spu_opcode_t op);
+	void CGT(spu_opcode_t op);
+	void XOR(spu_opcode_t op);
+	void CGTH(spu_opcode_t op);
+	void EQV(spu_opcode_t op);
+	void CGTB(spu_opcode_t op);
+	void SUMB(spu_opcode_t op);
+	void HGT(spu_opcode_t op);
+	void CLZ(spu_opcode_t op);
+	void XSWD(spu_opcode_t op);
+	void XSHW(spu_opcode_t op);
+	void CNTB(spu_opcode_t op);
+	void XSBH(spu_opcode_t op);
+	void CLGT(spu_opcode_t op);
+	void ANDC(spu_opcode_t op);
+	void FCGT(spu_opcode_t op);
+	void DFCGT(spu_opcode_t op);
+	void FA(spu_opcode_t op);
+	void FS(spu_opcode_t op);
+	void FM(spu_opcode_t op);
+	void CLGTH(spu_opcode_t op);
+	void ORC(spu_opcode_t op);
+	void FCMGT(spu_opcode_t op);
+	void DFCMGT(spu_opcode_t op);
+	void DFA(spu_opcode_t op);
+	void DFS(spu_opcode_t op);
+	void DFM(spu_opcode_t op);
+	void CLGTB(spu_opcode_t op);
+	void HLGT(spu_opcode_t op);
+	void DFMA(spu_opcode_t op);
+	void DFMS(spu_opcode_t op);
+	void DFNMS(spu_opcode_t op);
+	void DFNMA(spu_opcode_t op);
+	void CEQ(spu_opcode_t op);
+	void MPYHHU(spu_opcode_t op);
+	void ADDX(spu_opcode_t op);
+	void SFX(spu_opcode_t op);
+	void CGX(spu_opcode_t op);
+	void BGX(spu_opcode_t op);
+	void MPYHHA(spu_opcode_t op);
+	void MPYHHAU(spu_opcode_t op);
+	void FSCRRD(spu_opcode_t op);
+	void FESD(spu_opcode_t op);
+	void FRDS(spu_opcode_t op);
+	void FSCRWR(spu_opcode_t op);
+	void DFTSV(spu_opcode_t op);
+	void FCEQ(spu_opcode_t op);
+	void DFCEQ(spu_opcode_t op);
+	void MPY(spu_opcode_t op);
+	void MPYH(spu_opcode_t op);
+	void MPYHH(spu_opcode_t op);
+	void MPYS(spu_opcode_t op);
+	void CEQH(spu_opcode_t op);
+	void FCMEQ(spu_opcode_t op);
+	void DFCMEQ(spu_opcode_t op);
+	void MPYU(spu_opcode_t op);
+	void CEQB(spu_opcode_t op);
+	void FI(spu_opcode_t op);
+	void HEQ(spu_opcode_t op);
+	void CFLTS(spu_opcode_t op);
+	void CFLTU(spu_opcode_t op);
+	void CSFLT(spu_opcode_t op);
+	void CUFLT(spu_opcode_t op);
+	void BRZ(spu_opcode_t op);
+	void STQA(spu_opcode_t op);
+	void BRNZ(spu_opcode_t op);
+	void BRHZ(spu_opcode_t op);
+	void BRHNZ(spu_opcode_t op);
+	void STQR(spu_opcode_t op);
+	void BRA(spu_opcode_t op);
+	void LQA(spu_opcode_t op);
+	void BRASL(spu_opcode_t op);
+	void BR(spu_opcode_t op);
+	void FSMBI(spu_opcode_t op);
+	void BRSL(spu_opcode_t op);
+	void LQR(spu_opcode_t op);
+	void IL(spu_opcode_t op);
+	void ILHU(spu_opcode_t op);
+	void ILH(spu_opcode_t op);
+	void IOHL(spu_opcode_t op);
+	void ORI(spu_opcode_t op);
+	void ORHI(spu_opcode_t op);
+	void ORBI(spu_opcode_t op);
+	void SFI(spu_opcode_t op);
+	void SFHI(spu_opcode_t op);
+	void ANDI(spu_opcode_t op);
+	void ANDHI(spu_opcode_t op);
+	void ANDBI(spu_opcode_t op);
+	void AI(spu_opcode_t op);
+	void AHI(spu_opcode_t op);
+	void STQD(spu_opcode_t op);
+	void LQD(spu_opcode_t op);
+	void XORI(spu_opcode_t op);
+	void XORHI(spu_opcode_t op);
+	void XORBI(spu_opcode_t op);
+	void CGTI(spu_opcode_t op);
+	void CGTHI(spu_opcode_t op);
+	void CGTBI(spu_opcode_t op);
+	void HGTI(spu_opcode_t op);
+	void CLGTI(spu_opcode_t op);
+	void CLGTHI(spu_opcode_t op);
+	void CLGTBI(spu_opcode_t op);
+	void HLGTI(spu_opcode_t op);
+	void MPYI(spu_opcode_t op);
+	void MPYUI(spu_opcode_t op);
+	void CEQI(spu_opcode_t op);
+	void CEQHI(spu_opcode_t op);
+	void CEQBI(spu_opcode_t op);
+	void HEQI(spu_opcode_t op);
+	void HBRA(spu_opcode_t op);
+	void HBRR(spu_opcode_t op);
+	void ILA(spu_opcode_t op);
+	void SELB(spu_opcode_t op);
+	void SHUFB(spu_opcode_t op);
+	void MPYA(spu_opcode_t op);
+	void FNMS(spu_opcode_t op);
+	void FMA(spu_opcode_t op);
+	void FMS(spu_opcode_t op);
+
+	void UNK(spu_opcode_t op);
+};
+
+#endif
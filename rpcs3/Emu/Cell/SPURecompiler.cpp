@@ -5,6 +5,7 @@
 #include "SPUThread.h"
 #include "SPURecompiler.h"
 #include "SPUASMJITRecompiler.h"
+#include "SPULLVMRecompiler.h"
 
 extern u64 get_system_time();
 
@@ -22,8 +23,25 @@ void spu_recompiler_base::enter(SPUThread& spu)
 	// Get SPU LS pointer
 	const auto _ls = vm::ps3::_ptr<u32>(spu.offset);
 
-	// Always validate (TODO)
-	const auto func = spu.spu_db->analyse(_ls, spu.pc);
+	if (!spu.spu_cache)
+	{
+		spu.spu_cache = std::make_unique<spu_function_cache>();
+	}
+
+	// Drop cached functions overwritten since the last dispatch
+	if (UNLIKELY(spu.ls_dirty))
+	{
+		spu.spu_cache->invalidate(spu.ls_dirty.exchange(0));
+	}
+
+	auto func = spu.spu_cache->find(spu.pc);
+
+	if (UNLIKELY(!func))
+	{
+		// Validate LS contents against the database
+		func = verify("SPU function" HERE, spu.spu_db->analyse(_ls, spu.pc).get());
+		spu.spu_cache->add(*func);
+	}
 
 	// Reset callstack if necessary
 	if (func->does_reset_stack && spu.recursion_level)
@@ -36,7 +54,7 @@ void spu_recompiler_base::enter(SPUThread& spu)
 	{
 		if (!spu.spu_rec)
 		{
-			spu.spu_rec = fxm::get_always<spu_recompiler>();
+			spu.spu_rec = get(false);
 		}
 
 		spu.spu_rec->compile(*func);
@@ -77,3 +95,159 @@ void spu_recompiler_base::enter(SPUThread& spu)
 
 	spu.pc = res & 0x3fffc;
 }
+
+// Get the mask of LS pages (4 KiB) occupied by the function
+static inline u64 spu_function_pages(const spu_function_t& func)
+{
+	const u32 first = func.addr / 4096;
+	const u32 last = (func.addr + func.size - 1) / 4096;
+	return (~0ull >> (63 - last)) & (~0ull << first);
+}
+
+void spu_function_cache::add(spu_function_t& func)
+{
+	auto& entry = m_map[func.addr / 4];
+
+	if (!entry)
+	{
+		m_list.emplace_back(func.addr);
+	}
+
+	entry = &func;
+	m_pages |= spu_function_pages(func);
+}
+
+void spu_function_cache::invalidate(u64 pages)
+{
+	if (!(pages & m_pages))
+	{
+		return;
+	}
+
+	m_pages = 0;
+
+	for (auto it = m_list.begin(); it != m_list.end();)
+	{
+		auto& entry = m_map[*it / 4];
+
+		const u64 mask = spu_function_pages(*entry);
+
+		if (mask & pages)
+		{
+			entry = nullptr;
+			*it = m_list.back();
+			m_list.pop_back();
+			continue;
+		}
+
+		m_pages |= mask;
+		it++;
+	}
+}
+
+std::shared_ptr<spu_recompiler_base> spu_recompiler_base::get(bool llvm)
+{
+	if (llvm)
+	{
+#ifdef LLVM_AVAILABLE
+		return fxm::get_always<spu_llvm_recompiler>();
+#else
+		LOG_ERROR(SPU, "SPU Recompiler (LLVM) is not available, using ASMJIT");
+#endif
+	}
+
+	return fxm::get_always<spu_recompiler>();
+}
+
+u32 spu_recompiler_base::interpreter_gate(SPUThread* _spu, u32 opcode, spu_inter_func_t _func) noexcept
+{
+	try
+	{
+		// TODO: check correctness
+
+		const u32 old_pc = _spu->pc;
+
+		if (test(_spu->state) && _spu->check_state())
+		{
+			return 0x2000000 | _spu->pc;
+		}
+
+		_func(*_spu, { opcode });
+
+		if (old_pc != _spu->pc)
+		{
+			_spu->pc += 4;
+			return 0x2000000 | _spu->pc;
+		}
+
+		_spu->pc += 4;
+		return 0;
+	}
+	catch (...)
+	{
+		_spu->pending_exception = std::current_exception();
+		return 0x1000000 | _spu->pc;
+	}
+}
+
+u32 spu_recompiler_base::function_gate(SPUThread* _spu, u32 link) noexcept
+{
+	_spu->recursion_level++;
+
+	try
+	{
+		// TODO: check correctness
+
+		if (_spu->pc & 0x4000000)
+		{
+			if (_spu->pc & 0x8000000)
+			{
+				fmt::throw_exception("Undefined behaviour" HERE);
+			}
+
+			_spu->set_interrupt_status(true);
+			_spu->pc &= ~0x4000000;
+		}
+		else if (_spu->pc & 0x8000000)
+		{
+			_spu->set_interrupt_status(false);
+			_spu->pc &= ~0x8000000;
+		}
+
+		if (_spu->pc == link)
+		{
+			LOG_ERROR(SPU, "Branch-to-next");
+		}
+		else if (_spu->pc == link - 4)
+		{
+			LOG_ERROR(SPU, "Branch-to-self");
+		}
+
+		while (!test(_spu->state) || !_spu->check_state())
+		{
+			// Proceed recursively
+			spu_recompiler_base::enter(*_spu);
+
+			if (test(_spu->state & cpu_flag::ret))
+			{
+				break;
+			}
+
+			if (_spu->pc == link)
+			{
+				_spu->recursion_level--;
+				return 0; // Successfully returned 
+			}
+		}
+
+		_spu->recursion_level--;
+		return 0x2000000 | _spu->pc;
+	}
+	catch (...)
+	{
+		_spu->pending_exception = std::current_exception();
+
+		_spu->recursion_level--;
+		return 0x1000000 | _spu->pc;
+	}
+}
@@ -1,9 +1,35 @@
 #pragma once
 
 #include "SPUAnalyser.h"
+#include "SPUInterpreter.h"
 
 #include <mutex>
 
+// Per-thread table of validated SPU functions indexed by LS address
+class spu_function_cache
+{
+	// Function currently valid at each LS address (owned by SPUDatabase)
+	std::array<spu_function_t*, 0x10000> m_map{};
+
+	// Occupied addresses
+	std::vector<u32> m_list;
+
+	// LS pages (4 KiB) covered by cached functions
+	u64 m_pages = 0;
+
+public:
+	// Get the function validated at the specified address (lock-free, owner thread only)
+	spu_function_t* find(u32 addr) const
+	{
+		return m_map[addr / 4];
+	}
+
+	void add(spu_function_t& func);
+
+	// Drop functions overlapping specified LS pages
+	void invalidate(u64 pages);
+};
+
 // SPU Recompiler instance base (must be global or PS3 process-local)
 class spu_recompiler_base
 {
@@ -22,4 +48,13 @@ public:
 
 	// Run
 	static void enter(class SPUThread&);
+
+	// Get recompiler instance for the selected decoder
+	static std::shared_ptr<spu_recompiler_base> get(bool llvm);
+
+	// Execute single instruction with the interpreter (returns 0 to continue, or the next address with flags)
+	static u32 interpreter_gate(class SPUThread* _spu, u32 opcode, spu_inter_func_t _func) noexcept;
+
+	// Execute called function until it returns to the link address (returns 0, or the next address with flags)
+	static u32 function_gate(class SPUThread* _spu, u32 link) noexcept;
 };
@@ -192,9 +192,10 @@ void SPUThread::cpu_task()
 		return custom_task(*this);
 	}
 
-	if (g_cfg_spu_decoder.get() == spu_decoder_type::asmjit)
+	if (g_cfg_spu_decoder.get() == spu_decoder_type::asmjit || g_cfg_spu_decoder.get() == spu_decoder_type::llvm)
 	{
 		if (!spu_db) spu_db = fxm::get_always<SPUDatabase>();
+		if (!spu_rec) spu_rec = spu_recompiler_base::get(g_cfg_spu_decoder.get() == spu_decoder_type::llvm);
 		return spu_recompiler_base::enter(*this);
 	}
 
@@ -282,6 +283,9 @@ void SPUThread::do_dma_transfer(u32 cmd, spu_mfc_arg_t args)
 
 	u32 eal = vm::cast(args.ea, HERE);
 
+	// Target SPU Thread if the access is redirected to its LS
+	SPUThread* target = nullptr;
+
 	if (eal >= SYS_SPU_THREAD_BASE_LOW && offset < RAW_SPU_BASE_ADDR) // SPU Thread Group MMIO (LS and SNR)
 	{
 		const u32 index = (eal - SYS_SPU_THREAD_BASE_LOW) / SYS_SPU_THREAD_OFFSET; // thread number in group
@@ -294,6 +298,7 @@ void SPUThread::do_dma_transfer(u32 cmd, spu_mfc_arg_t args)
 			if (offset + args.size - 1 < 0x40000) // LS access
 			{
 				eal = spu.offset + offset; // redirect access
+				target = &spu;
 			}
 			else if ((cmd & MFC_PUT_CMD) && args.size == 4 && (offset == SYS_SPU_THREAD_SNR1 || offset == SYS_SPU_THREAD_SNR2))
 			{
@@ -317,12 +322,19 @@ void SPUThread::do_dma_transfer(u32 cmd, spu_mfc_arg_t args)
 	case MFC_PUTR_CMD:
 	{
 		std::memcpy(vm::base(eal), vm::base(offset + args.lsa), args.size);
+
+		if (target)
+		{
+			target->mark_ls_dirty(eal - target->offset, args.size);
+		}
+
 		return;
 	}
 
 	case MFC_GET_CMD:
 	{
 		std::memcpy(vm::base(offset + args.lsa), vm::base(eal), args.size);
+		mark_ls_dirty(args.lsa, args.size);
 		return;
 	}
 	}
@@ -426,6 +438,7 @@ void SPUThread::process_mfc_cmd(u32 cmd)
 		const u32 raddr = vm::cast(ch_mfc_args.ea, HERE);
 
 		vm::reservation_acquire(vm::base(offset + ch_mfc_args.lsa), raddr, 128);
+		mark_ls_dirty(ch_mfc_args.lsa, 128);
 
 		if (std::exchange(last_raddr, raddr))
 		{
@@ -504,7 +517,7 @@ void SPUThread::process_mfc_cmd(u32 cmd)
 u32 SPUThread::get_events(bool waiting)
 {
 	// check reservation status and set SPU_EVENT_LR if lost
-	if (last_raddr != 0 && !vm::reservation_test(this->get()))
+	if (last_raddr != 0 && !vm::reservation_test())
 	{
 		ch_event_stat |= SPU_EVENT_LR;
 
@@ -698,7 +711,7 @@ bool SPUThread::get_ch_value(u32 ch, u32& out)
 		if (ch_event_mask & SPU_EVENT_LR)
 		{
 			// register waiter if polling reservation status is required
-			vm::wait_op(last_raddr, 128, [&] { return get_events(true) || test(state & cpu_flag::stop); });
+			vm::wait_op(last_raddr, 128, [&] { return get_events(true) || test(state & cpu_flag::stop); }, 50);
 		}
 		else
 		{
@@ -1165,7 +1178,7 @@ bool SPUThread::stop_and_signal(u32 code)
 
 			if (queue->events.empty())
 			{
-				queue->sq.emplace_back(this);
+				queue->sq.push_back(this);
 				group->run_state = SPU_THREAD_GROUP_STATUS_WAITING;
 
 				for (auto& thread : group->threads)
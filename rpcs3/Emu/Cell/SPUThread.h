@@ -559,8 +559,23 @@ public:
 
 	std::shared_ptr<class SPUDatabase> spu_db;
 	std::shared_ptr<class spu_recompiler_base> spu_rec;
+	std::unique_ptr<class spu_function_cache> spu_cache;
+
+	// LS pages (4 KiB) written since the last function dispatch (bit mask)
+	atomic_t<u64> ls_dirty{0};
 	u32 recursion_level = 0;
 
+	// Notify the recompiler about LS modification (must be called after writing)
+	void mark_ls_dirty(u32 lsa, u32 size)
+	{
+		if (size)
+		{
+			const u32 first = lsa / 4096 % 64;
+			const u32 last = (lsa + size - 1) / 4096 % 64;
+			ls_dirty |= first <= last ? (~0ull >> (63 - last)) & (~0ull << first) : ~0ull;
+		}
+	}
+
 	void push_snr(u32 number, u32 value);
 	void do_dma_transfer(u32 cmd, spu_mfc_arg_t args);
 	void do_dma_list_cmd(u32 cmd, spu_mfc_arg_t args);
@@ -56,6 +56,8 @@ LOG_CHANNEL(sys_vm);
 
 extern std::string ppu_get_syscall_name(u64 code);
 
+atomic_t<u64> lv2_sleep_queue::s_prio_gen{0};
+
 static constexpr ppu_function_t null_func = nullptr;
 
 // UNS = Unused
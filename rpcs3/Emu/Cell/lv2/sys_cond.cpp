@@ -222,7 +222,7 @@ error_code sys_cond_wait(ppu_thread& ppu, u32 cond_id, u64 timeout)
 		semaphore_lock lock(cond->mutex->mutex);
 
 		// Register waiter
-		cond->sq.emplace_back(&ppu);
+		cond->sq.push_back(&ppu);
 
 		// Unlock the mutex
 		cond->mutex->lock_count = 0;
@@ -28,7 +28,7 @@ struct lv2_cond final : lv2_obj
 
 	std::shared_ptr<lv2_mutex> mutex; // Associated Mutex
 	atomic_t<u32> waiters{0};
-	std::deque<cpu_thread*> sq;
+	lv2_sleep_queue sq;
 
 	lv2_cond(u64 name, std::shared_ptr<lv2_mutex> mutex)
 		: shared(0)
@@ -57,10 +57,8 @@ bool lv2_event_queue::send(lv2_event event)
 	else
 	{
 		// Store event in In_MBox
-		auto& spu = static_cast<SPUThread&>(*sq.front());
-
 		// TODO: use protocol?
-		sq.pop_front();
+		auto& spu = static_cast<SPUThread&>(*sq.pop_front());
 
 		const u32 data1 = static_cast<u32>(std::get<1>(event));
 		const u32 data2 = static_cast<u32>(std::get<2>(event));
@@ -166,7 +164,7 @@ error_code sys_event_queue_destroy(u32 equeue_id, s32 mode)
 	{
 		semaphore_lock lock(queue->mutex);
 
-		for (auto cpu : queue->sq)
+		while (const auto cpu = queue->sq.pop_front())
 		{
 			if (queue->type == SYS_PPU_QUEUE)
 			{
@@ -235,7 +233,7 @@ error_code sys_event_queue_receive(ppu_thread& ppu, u32 equeue_id, vm::ptr<sys_e
 		
 		if (queue.events.empty())
 		{
-			queue.sq.emplace_back(&ppu);
+			queue.sq.push_back(&ppu);
 			return CELL_EBUSY;
 		}
 
@@ -365,25 +363,40 @@ error_code sys_event_port_connect_local(u32 eport_id, u32 equeue_id)
 
 	writer_lock lock(id_manager::g_mutex);
 
-	const auto port = idm::check_unlocked<lv2_obj, lv2_event_port>(eport_id);
-	
-	if (!port || !idm::check_unlocked<lv2_obj, lv2_event_queue>(equeue_id))
+	const auto queue = idm::get_unlocked<lv2_obj, lv2_event_queue>(equeue_id);
+
+	// Modify the port under its writer lock (sys_event_port_send may run concurrently)
+	const auto port = idm::check_exclusive<lv2_obj, lv2_event_port>(eport_id, [&](lv2_event_port& port) -> CellError
 	{
-		return CELL_ESRCH;
-	}
+		if (!queue)
+		{
+			return CELL_ESRCH;
+		}
+
+		if (port.type != SYS_EVENT_PORT_LOCAL)
+		{
+			return CELL_EINVAL;
+		}
+
+		if (!port.queue.expired())
+		{
+			return CELL_EISCONN;
+		}
+
+		port.queue = queue;
+		return {};
+	});
 
-	if (port->type != SYS_EVENT_PORT_LOCAL)
+	if (!port)
 	{
-		return CELL_EINVAL;
+		return CELL_ESRCH;
 	}
 
-	if (!port->queue.expired())
+	if (port.ret)
 	{
-		return CELL_EISCONN;
+		return port.ret;
 	}
 
-	port->queue = idm::get_unlocked<lv2_obj, lv2_event_queue>(equeue_id);
-
 	return CELL_OK;
 }
 
@@ -393,22 +406,29 @@ error_code sys_event_port_disconnect(u32 eport_id)
 
 	writer_lock lock(id_manager::g_mutex);
 
-	const auto port = idm::check_unlocked<lv2_obj, lv2_event_port>(eport_id);
+	const auto port = idm::check_exclusive<lv2_obj, lv2_event_port>(eport_id, [](lv2_event_port& port) -> CellError
+	{
+		if (port.queue.expired())
+		{
+			return CELL_ENOTCONN;
+		}
+
+		// TODO: return CELL_EBUSY if necessary (can't detect the condition)
+
+		port.queue.reset();
+		return {};
+	});
 
 	if (!port)
 	{
 		return CELL_ESRCH;
 	}
 
-	if (port->queue.expired())
+	if (port.ret)
 	{
-		return CELL_ENOTCONN;
+		return port.ret;
 	}
 
-	// TODO: return CELL_EBUSY if necessary (can't detect the condition)
-
-	port->queue.reset();
-
 	return CELL_OK;
 }
 
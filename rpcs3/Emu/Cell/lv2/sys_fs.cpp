@@ -6,11 +6,14 @@
 #include "Emu/VFS.h"
 #include "Emu/IdManager.h"
 #include "Utilities/StrUtil.h"
+#include "Utilities/Config.h"
 
 namespace vm { using namespace ps3; }
 
 logs::channel sys_fs("sys_fs", logs::level::notice);
 
+cfg::bool_entry g_cfg_fs_map_files(cfg::root.vfs, "Map read-only files into memory");
+
 struct lv2_fs_mount_point
 {
 	std::mutex mutex;
@@ -29,21 +32,154 @@ lv2_fs_mount_point* lv2_fs_object::get_mp(const char* filename)
 	return &g_mp_sys_dev_hdd0;
 }
 
-u64 lv2_file::op_read(vm::ps3::ptr<void> buf, u64 size)
+// Write counters hashed by file path
+std::array<atomic_t<u64>, 256> g_fs_write_gen{};
+
+atomic_t<u64>& lv2_file::get_write_gen(const char* filename)
+{
+	return g_fs_write_gen[std::hash<std::string>()(filename) % g_fs_write_gen.size()];
+}
+
+// Intermediate buffer size for guest memory which can't be accessed directly
+constexpr u64 s_fs_buffer_size = 0x10000;
+
+// Read data into guest memory using specified native read function
+template <typename F>
+static u64 fs_read_to_guest(vm::ps3::ptr<void> buf, u64 size, F&& read)
+{
+	thread_local std::unique_ptr<u8[]> local_buf(new u8[s_fs_buffer_size]);
+
+	if (size && size <= UINT32_MAX && vm::check_addr(buf.addr(), static_cast<u32>(size), vm::page_writable))
+	{
+		// Read directly into guest memory (privileged mapping is used so native API never faults)
+		const u64 result = read(vm::base_priv(buf.addr()), size);
+
+		if (result && !vm::check_addr(buf.addr(), static_cast<u32>(result), vm::page_writable))
+		{
+			// Memory was protected during the read: store the data again through the normal mapping, so its owner is notified
+			for (u64 pos = 0; pos < result; pos += s_fs_buffer_size)
+			{
+				const u64 chunk = std::min<u64>(result - pos, s_fs_buffer_size);
+				std::memcpy(local_buf.get(), vm::base_priv(buf.addr() + static_cast<u32>(pos)), chunk);
+				std::memcpy(static_cast<u8*>(buf.get_ptr()) + pos, local_buf.get(), chunk);
+			}
+		}
+
+		vm::page_notify_write(buf.addr(), static_cast<u32>(result));
+		return result;
+	}
+
+	// Copy data from intermediate buffer (avoid passing protected or unmapped vm pointer to a native API)
+	u64 result = 0;
+
+	while (result < size)
+	{
+		const u64 count = read(local_buf.get(), std::min<u64>(size - result, s_fs_buffer_size));
+		std::memcpy(static_cast<u8*>(buf.get_ptr()) + result, local_buf.get(), count);
+		result += count;
+
+		if (count < s_fs_buffer_size)
+		{
+			break;
+		}
+	}
+
+	return result;
+}
+
+// Write data from guest memory using specified native write function
+template <typename F>
+static u64 fs_write_from_guest(vm::ps3::cptr<void> buf, u64 size, F&& write)
 {
-	// Copy data from intermediate buffer (avoid passing vm pointer to a native API)
-	std::unique_ptr<u8[]> local_buf(new u8[size]);
-	const u64 result = file.read(local_buf.get(), size);
-	std::memcpy(buf.get_ptr(), local_buf.get(), result);
+	if (size && size <= UINT32_MAX && vm::check_addr(buf.addr(), static_cast<u32>(size), vm::page_readable))
+	{
+		// Write directly from guest memory
+		return write(vm::base_priv(buf.addr()), size);
+	}
+
+	// Copy data to intermediate buffer (avoid passing protected or unmapped vm pointer to a native API)
+	thread_local std::unique_ptr<u8[]> local_buf(new u8[s_fs_buffer_size]);
+
+	u64 result = 0;
+
+	while (result < size)
+	{
+		const u64 chunk = std::min<u64>(size - result, s_fs_buffer_size);
+		std::memcpy(local_buf.get(), static_cast<const u8*>(buf.get_ptr()) + result, chunk);
+
+		const u64 count = write(local_buf.get(), chunk);
+		result += count;
+
+		if (count < chunk)
+		{
+			break;
+		}
+	}
+
 	return result;
 }
 
+u64 lv2_file::op_read(vm::ps3::ptr<void> buf, u64 size)
+{
+	if (view)
+	{
+		const u64 pos = file.pos();
+
+		if (pos < view.size())
+		{
+			// Copy from the mapped file (access violations are handled as for usual guest memory writes)
+			const u64 result = std::min<u64>(size, view.size() - pos);
+			std::memcpy(buf.get_ptr(), view.data() + pos, result);
+			file.seek(pos + result);
+			return result;
+		}
+	}
+
+	return fs_read_to_guest(buf, size, [&](void* ptr, u64 count)
+	{
+		return file.read(ptr, count);
+	});
+}
+
 u64 lv2_file::op_write(vm::ps3::cptr<void> buf, u64 size)
 {
-	// Copy data to intermediate buffer (avoid passing vm pointer to a native API)
-	std::unique_ptr<u8[]> local_buf(new u8[size]);
-	std::memcpy(local_buf.get(), buf.get_ptr(), size);
-	return file.write(local_buf.get(), size);
+	const u64 result = fs_write_from_guest(buf, size, [&](const void* ptr, u64 count)
+	{
+		return file.write(ptr, count);
+	});
+
+	write_gen++;
+	return result;
+}
+
+u64 lv2_file::op_read_at(u64 offset, vm::ps3::ptr<void> buf, u64 size)
+{
+	if (view && offset < view.size())
+	{
+		const u64 result = std::min<u64>(size, view.size() - offset);
+		std::memcpy(buf.get_ptr(), view.data() + offset, result);
+		return result;
+	}
+
+	return fs_read_to_guest(buf, size, [&](void* ptr, u64 count)
+	{
+		const u64 result = file.read_at(offset, ptr, count);
+		offset += result;
+		return result;
+	});
+}
+
+u64 lv2_file::op_write_at(u64 offset, vm::ps3::cptr<void> buf, u64 size)
+{
+	const u64 result = fs_write_from_guest(buf, size, [&](const void* ptr, u64 count)
+	{
+		const u64 result = file.write_at(offset, ptr, count);
+		offset += result;
+		return result;
+	});
+
+	write_gen++;
+	return result;
 }
 
 error_code sys_fs_test(u32 arg1, u32 arg2, vm::ptr<u32> arg3, u32 arg4, vm::ptr<char> arg5, u32 arg6)
@@ -144,7 +280,20 @@ error_code sys_fs_open(vm::cptr<char> path, s32 flags, vm::ptr<u32> fd, s32 mode
 		return CELL_ENOENT;
 	}
 
-	if (const u32 id = idm::make<lv2_fs_object, lv2_file>(path.get_ptr(), std::move(file), mode, flags))
+	fs::file_view view;
+
+	if (g_cfg_fs_map_files && (flags & CELL_FS_O_ACCMODE) == CELL_FS_O_RDONLY)
+	{
+		const std::string vpath = path.get_ptr();
+
+		// Only map files from the disc: files on writable devices may be truncated through another descriptor, which would fault on access
+		if (vpath.compare(0, 10, "/dev_bdvd/") == 0)
+		{
+			view = fs::file_view(local_path);
+		}
+	}
+
+	if (const u32 id = idm::make<lv2_fs_object, lv2_file>(path.get_ptr(), std::move(file), mode, flags, std::move(view)))
 	{
 		*fd = id;
 		return CELL_OK;
@@ -462,14 +611,9 @@ error_code sys_fs_fcntl(u32 fd, u32 op, vm::ptr<void> _arg, u32 _size)
 
 		std::lock_guard<std::mutex> lock(file->mp->mutex);
 
-		const u64 old_pos = file->file.pos();
-		const u64 new_pos = file->file.seek(arg->offset);
-
 		arg->out_size = op == 0x8000000A
-			? file->op_read(arg->buf, arg->size)
-			: file->op_write(arg->buf, arg->size);
-
-		verify(HERE), old_pos == file->file.seek(old_pos);
+			? file->op_read_at(arg->offset, arg->buf, arg->size)
+			: file->op_write_at(arg->offset, arg->buf, arg->size);
 
 		arg->out_code = CELL_OK;
 
@@ -550,6 +694,8 @@ error_code sys_fs_truncate(vm::cptr<char> path, u64 size)
 		return CELL_EIO; // ???
 	}
 
+	lv2_file::get_write_gen(path.get_ptr())++;
+
 	return CELL_OK;
 }
 
@@ -577,6 +723,8 @@ error_code sys_fs_ftruncate(u32 fd, u64 size)
 		return CELL_EIO; // ???
 	}
 
+	file->write_gen++;
+
 	return CELL_OK;
 }
 
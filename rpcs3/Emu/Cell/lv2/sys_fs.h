@@ -115,22 +115,37 @@ struct lv2_fs_object
 struct lv2_file final : lv2_fs_object
 {
 	const fs::file file;
+	const fs::file_view view; // Optional memory mapping of a read-only file
 	const s32 mode;
 	const s32 flags;
 
-	lv2_file(const char* filename, fs::file&& file, s32 mode, s32 flags)
+	// Incremented after every write or truncation (shared by all files with the same path hash)
+	atomic_t<u64>& write_gen;
+
+	lv2_file(const char* filename, fs::file&& file, s32 mode, s32 flags, fs::file_view&& view = {})
 		: lv2_fs_object(lv2_fs_object::get_mp(filename))
 		, file(std::move(file))
+		, view(std::move(view))
 		, mode(mode)
 		, flags(flags)
+		, write_gen(get_write_gen(filename))
 	{
 	}
 
-	// File reading with intermediate buffer
+	// Get write counter for the specified path (used to invalidate cached file data)
+	static atomic_t<u64>& get_write_gen(const char* filename);
+
+	// File reading directly into guest memory (uses intermediate buffer if the range is not writable)
 	u64 op_read(vm::ps3::ptr<void> buf, u64 size);
 
-	// File writing with intermediate buffer
+	// File writing directly from guest memory (uses intermediate buffer if the range is not readable)
 	u64 op_write(vm::ps3::cptr<void> buf, u64 size);
+
+	// Positional reading (doesn't change the file position if supported natively)
+	u64 op_read_at(u64 offset, vm::ps3::ptr<void> buf, u64 size);
+
+	// Positional writing (doesn't change the file position if supported natively)
+	u64 op_write_at(u64 offset, vm::ps3::cptr<void> buf, u64 size);
 };
 
 struct lv2_dir final : lv2_fs_object
@@ -73,11 +73,11 @@ error_code _sys_lwcond_signal(u32 lwcond_id, u32 lwmutex_id, u32 ppu_thread_id,
 		fmt::throw_exception("Unknown mode (%d)" HERE, mode);
 	}
 
-	lv2_lwmutex* mutex = nullptr;
+	std::shared_ptr<lv2_lwmutex> mutex;
 
 	const auto cond = idm::check<lv2_obj, lv2_lwcond>(lwcond_id, [&](lv2_lwcond& cond) -> cpu_thread*
 	{
-		mutex = idm::check_unlocked<lv2_obj, lv2_lwmutex>(lwmutex_id);
+		mutex = idm::get<lv2_obj, lv2_lwmutex>(lwmutex_id);
 
 		if (mutex && cond.waiters)
 		{
@@ -110,7 +110,7 @@ error_code _sys_lwcond_signal(u32 lwcond_id, u32 lwmutex_id, u32 ppu_thread_id,
 
 				if (mode != 2 && !mutex->signaled.fetch_op([](u32& v) { if (v) v--; }))
 				{
-					mutex->sq.emplace_back(result);
+					mutex->sq.push_back(result);
 					result = nullptr;
 					mode = 2; // Enforce CELL_OK
 				}
@@ -161,11 +161,11 @@ error_code _sys_lwcond_signal_all(u32 lwcond_id, u32 lwmutex_id, u32 mode)
 
 	std::basic_string<cpu_thread*> threads;
 
-	lv2_lwmutex* mutex = nullptr;
+	std::shared_ptr<lv2_lwmutex> mutex;
 
 	const auto cond = idm::check<lv2_obj, lv2_lwcond>(lwcond_id, [&](lv2_lwcond& cond) -> u32
 	{
-		mutex = idm::check_unlocked<lv2_obj, lv2_lwmutex>(lwmutex_id);
+		mutex = idm::get<lv2_obj, lv2_lwmutex>(lwmutex_id);
 
 		if (mutex && cond.waiters)
 		{
@@ -181,7 +181,7 @@ error_code _sys_lwcond_signal_all(u32 lwcond_id, u32 lwmutex_id, u32 mode)
 
 				if (mode != 2 && !mutex->signaled.fetch_op([](u32& v) { if (v) v--; }))
 				{
-					mutex->sq.emplace_back(cpu);
+					mutex->sq.push_back(cpu);
 				}
 				else
 				{
@@ -227,7 +227,7 @@ error_code _sys_lwcond_queue_wait(ppu_thread& ppu, u32 lwcond_id, u32 lwmutex_id
 
 	const auto cond = idm::get<lv2_obj, lv2_lwcond>(lwcond_id, [&](lv2_lwcond& cond) -> cpu_thread*
 	{
-		mutex = idm::get_unlocked<lv2_obj, lv2_lwmutex>(lwmutex_id);
+		mutex = idm::get<lv2_obj, lv2_lwmutex>(lwmutex_id);
 
 		if (!mutex)
 		{
@@ -238,7 +238,7 @@ error_code _sys_lwcond_queue_wait(ppu_thread& ppu, u32 lwcond_id, u32 lwmutex_id
 
 		// Add a waiter
 		cond.waiters++;
-		cond.sq.emplace_back(&ppu);
+		cond.sq.push_back(&ppu);
 
 		// Process lwmutex sleep queue
 		if (const auto cpu = mutex->schedule<ppu_thread>(mutex->sq, mutex->protocol))
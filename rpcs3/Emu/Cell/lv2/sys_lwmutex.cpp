@@ -92,7 +92,7 @@ error_code _sys_lwmutex_lock(ppu_thread& ppu, u32 lwmutex_id, u64 timeout)
 			}
 		}
 
-		mutex.sq.emplace_back(&ppu);
+		mutex.sq.push_back(&ppu);
 		return false;
 	});
 
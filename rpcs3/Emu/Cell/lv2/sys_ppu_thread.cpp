@@ -5,6 +5,7 @@
 
 #include "Emu/Cell/ErrorCodes.h"
 #include "Emu/Cell/PPUThread.h"
+#include "sys_sync.h"
 #include "sys_ppu_thread.h"
 
 #include <thread>
@@ -136,7 +137,13 @@ error_code sys_ppu_thread_set_priority(u32 thread_id, s32 prio)
 		return CELL_EINVAL;
 	}
 
-	thread->prio = prio;
+	if (thread->prio != static_cast<u32>(prio))
+	{
+		thread->prio = prio;
+
+		// The thread may be waiting in a priority queue already
+		lv2_sleep_queue::notify_prio_change();
+	}
 
 	return CELL_OK;
 }
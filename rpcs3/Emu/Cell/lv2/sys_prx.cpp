@@ -18,7 +18,10 @@ s32 prx_load_module(std::string path, u64 flags, vm::ptr<sys_prx_load_module_opt
 {
 	sys_prx.warning("prx_load_module(path='%s', flags=0x%llx, pOpt=*0x%x)", path.c_str(), flags, pOpt);
 
-	const ppu_prx_object obj = decrypt_self(fs::file(vfs::get(path)));
+	// Firmware modules are immutable, cache their decrypted images
+	const bool is_firmware = path.compare(0, 11, "/dev_flash/") == 0;
+
+	const ppu_prx_object obj = decrypt_self(fs::file(vfs::get(path)), is_firmware);
 
 	if (obj != elf_error::ok)
 	{
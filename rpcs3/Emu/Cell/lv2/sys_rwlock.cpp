@@ -106,7 +106,7 @@ error_code sys_rwlock_rlock(ppu_thread& ppu, u32 rw_lock_id, u64 timeout)
 
 		if (_old > 0 || _old & 1)
 		{
-			rwlock.rq.emplace_back(&ppu);
+			rwlock.rq.push_back(&ppu);
 			return false;
 		}
 
@@ -291,7 +291,7 @@ error_code sys_rwlock_wlock(ppu_thread& ppu, u32 rw_lock_id, u64 timeout)
 
 		if (_old != 0)
 		{
-			rwlock.wq.emplace_back(&ppu);
+			rwlock.wq.push_back(&ppu);
 			return false;
 		}
 
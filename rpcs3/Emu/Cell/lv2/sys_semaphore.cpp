@@ -100,7 +100,7 @@ error_code sys_semaphore_wait(ppu_thread& ppu, u32 sem_id, u64 timeout)
 
 		if (sema.val-- <= 0)
 		{
-			sema.sq.emplace_back(&ppu);
+			sema.sq.push_back(&ppu);
 			return false;
 		}
 
@@ -30,7 +30,7 @@ struct lv2_sema final : lv2_obj
 
 	semaphore<> mutex;
 	atomic_t<s32> val;
-	std::deque<cpu_thread*> sq;
+	lv2_sleep_queue sq;
 
 	lv2_sema(u32 protocol, u64 name, s32 max, s32 value)
 		: protocol(protocol)
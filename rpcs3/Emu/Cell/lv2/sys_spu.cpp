@@ -260,6 +260,7 @@ error_code sys_spu_thread_group_start(u32 id)
 			// Copy SPU image:
 			// TODO: use segment info
 			std::memcpy(vm::base(thread->offset), image->segs.get_ptr(), 256 * 1024);
+			thread->mark_ls_dirty(0, 0x40000);
 
 			thread->pc = image->entry_point;
 			thread->cpu_init();
@@ -587,6 +588,7 @@ error_code sys_spu_thread_write_ls(u32 id, u32 lsa, u64 value, u32 type)
 	default: return CELL_EINVAL;
 	}
 
+	thread->mark_ls_dirty(lsa, type);
 	return CELL_OK;
 }
 
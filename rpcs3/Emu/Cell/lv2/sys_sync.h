@@ -5,6 +5,7 @@
 #include "Utilities/sema.h"
 #include "Utilities/cond.h"
 
+#include "Emu/CPU/CPUThread.h"
 #include "Emu/Cell/ErrorCodes.h"
 
 #include <deque>
@@ -48,6 +49,313 @@ enum
 	SYS_SYNC_NOT_ADAPTIVE = 0x2000,
 };
 
+// Intrusive queue of threads waiting on lv2 synchronization object (doesn't allocate, protected by the object's mutex).
+// Threads are kept in insertion order, so FIFO operations are O(1). For priority scheduling, new waiters are lazily
+// moved into a pairing heap ordered by priority and then by insertion order (O(log n) amortized).
+// Waiters whose priority changed after insertion are re-keyed on the next priority scheduling.
+class lv2_sleep_queue
+{
+	cpu_thread* m_head = nullptr;
+	cpu_thread* m_tail = nullptr;
+	cpu_thread* m_pending = nullptr; // First thread not yet inserted in the heap (the following ones aren't too)
+	cpu_thread* m_root = nullptr; // Heap root
+	std::size_t m_size = 0;
+	u64 m_seq = 0;
+	u64 m_prio_gen = 0; // Value of s_prio_gen when heap keys were checked last time
+
+	static constexpr u64 c_seq_mask = (1ull << 48) - 1;
+
+	// Incremented on every thread priority change (the queue owner's mutex isn't available to the caller)
+	static atomic_t<u64> s_prio_gen;
+
+	// Link two heap roots, return new root
+	static cpu_thread* heap_meld(cpu_thread* a, cpu_thread* b)
+	{
+		if (b->sq_link.key < a->sq_link.key)
+		{
+			std::swap(a, b);
+		}
+
+		b->sq_link.left = a;
+		b->sq_link.right = a->sq_link.child;
+
+		if (a->sq_link.child)
+		{
+			a->sq_link.child->sq_link.left = b;
+		}
+
+		a->sq_link.child = b;
+		return a;
+	}
+
+	// Merge the list of siblings in two passes, return new root
+	static cpu_thread* heap_merge_pairs(cpu_thread* first)
+	{
+		cpu_thread* stack = nullptr;
+
+		// Meld pairs left to right, stack the results (linked through "left")
+		while (first)
+		{
+			const auto a = first;
+			const auto b = a->sq_link.right;
+
+			if (!b)
+			{
+				a->sq_link.left = stack;
+				a->sq_link.right = nullptr;
+				stack = a;
+				break;
+			}
+
+			first = b->sq_link.right;
+			a->sq_link.left = a->sq_link.right = nullptr;
+			b->sq_link.left = b->sq_link.right = nullptr;
+
+			const auto m = heap_meld(a, b);
+			m->sq_link.left = stack;
+			stack = m;
+		}
+
+		if (!stack)
+		{
+			return nullptr;
+		}
+
+		// Meld the results right to left
+		auto result = stack;
+		stack = stack->sq_link.left;
+		result->sq_link.left = nullptr;
+
+		while (stack)
+		{
+			const auto next = stack->sq_link.left;
+			stack->sq_link.left = nullptr;
+			result = heap_meld(stack, result);
+			stack = next;
+		}
+
+		return result;
+	}
+
+	void heap_remove(cpu_thread* cpu)
+	{
+		auto& link = cpu->sq_link;
+
+		if (cpu == m_root)
+		{
+			m_root = heap_merge_pairs(link.child);
+		}
+		else
+		{
+			// Detach from the parent or the previous sibling
+			if (link.left->sq_link.child == cpu)
+			{
+				link.left->sq_link.child = link.right;
+			}
+			else
+			{
+				link.left->sq_link.right = link.right;
+			}
+
+			if (link.right)
+			{
+				link.right->sq_link.left = link.left;
+			}
+
+			if (const auto sub = heap_merge_pairs(link.child))
+			{
+				m_root = heap_meld(m_root, sub);
+			}
+		}
+
+		link.child = link.left = link.right = nullptr;
+		link.in_heap = false;
+	}
+
+	// Remove the thread known to be in the queue
+	void erase(cpu_thread* cpu)
+	{
+		auto& link = cpu->sq_link;
+
+		if (link.in_heap)
+		{
+			heap_remove(cpu);
+		}
+		else if (m_pending == cpu)
+		{
+			m_pending = link.next;
+		}
+
+		(link.prev ? link.prev->sq_link.next : m_head) = link.next;
+		(link.next ? link.next->sq_link.prev : m_tail) = link.prev;
+
+		link.queue = nullptr;
+		link.prev = link.next = nullptr;
+		m_size--;
+	}
+
+public:
+	class iterator
+	{
+		cpu_thread* m_ptr;
+
+	public:
+		iterator(cpu_thread* ptr)
+			: m_ptr(ptr)
+		{
+		}
+
+		cpu_thread* operator*() const
+		{
+			return m_ptr;
+		}
+
+		iterator& operator++()
+		{
+			m_ptr = m_ptr->sq_link.next;
+			return *this;
+		}
+
+		bool operator!=(const iterator& rhs) const
+		{
+			return m_ptr != rhs.m_ptr;
+		}
+	};
+
+	lv2_sleep_queue() = default;
+
+	lv2_sleep_queue(const lv2_sleep_queue&) = delete;
+
+	lv2_sleep_queue& operator=(const lv2_sleep_queue&) = delete;
+
+	// Iterate in insertion order (the current thread can be removed only if iteration stops)
+	iterator begin() const
+	{
+		return m_head;
+	}
+
+	iterator end() const
+	{
+		return nullptr;
+	}
+
+	bool empty() const
+	{
+		return m_head == nullptr;
+	}
+
+	std::size_t size() const
+	{
+		return m_size;
+	}
+
+	cpu_thread* front() const
+	{
+		return m_head;
+	}
+
+	// Add the thread (it must not be in any other queue)
+	void push_back(cpu_thread* cpu)
+	{
+		auto& link = cpu->sq_link;
+
+		verify(HERE), !link.queue;
+
+		link = {};
+		link.queue = this;
+		link.prev = m_tail;
+		link.key = m_seq++ & c_seq_mask;
+
+		(m_tail ? m_tail->sq_link.next : m_head) = cpu;
+		m_tail = cpu;
+
+		if (!m_pending)
+		{
+			m_pending = cpu;
+		}
+
+		m_size++;
+	}
+
+	// Remove the thread, return false if it's not in this queue
+	bool remove(cpu_thread* cpu)
+	{
+		if (cpu->sq_link.queue != this)
+		{
+			return false;
+		}
+
+		erase(cpu);
+		return true;
+	}
+
+	// Remove the first thread
+	cpu_thread* pop_front()
+	{
+		const auto res = m_head;
+
+		if (res)
+		{
+			erase(res);
+		}
+
+		return res;
+	}
+
+	// Report a priority change of some thread, which may be waiting in any queue
+	static void notify_prio_change()
+	{
+		s_prio_gen++;
+	}
+
+	// Remove the thread with the highest priority (E must have "prio" field, lower value means higher priority)
+	template <typename E>
+	cpu_thread* pop_prio()
+	{
+		const u64 prio_gen = s_prio_gen;
+
+		if (UNLIKELY(m_prio_gen != prio_gen))
+		{
+			m_prio_gen = prio_gen;
+
+			// Re-key the threads already in the heap if their priority changed (remove and insert again)
+			for (auto cpu = m_head; cpu != m_pending; cpu = cpu->sq_link.next)
+			{
+				auto& link = cpu->sq_link;
+				const u64 key = u64{static_cast<E*>(cpu)->prio} << 48 | (link.key & c_seq_mask);
+
+				if (link.in_heap && link.key != key)
+				{
+					heap_remove(cpu);
+					link.key = key;
+					link.in_heap = true;
+					m_root = m_root ? heap_meld(m_root, cpu) : cpu;
+				}
+			}
+		}
+
+		// Insert new threads in the heap (the priority is read at this point)
+		for (auto cpu = m_pending; cpu; cpu = cpu->sq_link.next)
+		{
+			auto& link = cpu->sq_link;
+			link.key = u64{static_cast<E*>(cpu)->prio} << 48 | (link.key & c_seq_mask);
+			link.in_heap = true;
+			m_root = m_root ? heap_meld(m_root, cpu) : cpu;
+		}
+
+		m_pending = nullptr;
+
+		const auto res = m_root;
+
+		if (res)
+		{
+			erase(res);
+		}
+
+		return res;
+	}
+};
+
 // Base class for some kernel objects (shared set of 8192 objects).
 struct lv2_obj
 {
@@ -72,6 +380,24 @@ struct lv2_obj
 		return false;
 	}
 
+	// Find and remove the thread from the sleep queue
+	template <typename E>
+	static bool unqueue(lv2_sleep_queue& queue, const E& object)
+	{
+		return queue.remove(object);
+	}
+
+	template <typename E>
+	static cpu_thread* schedule(lv2_sleep_queue& queue, u32 protocol)
+	{
+		if (protocol == SYS_SYNC_FIFO)
+		{
+			return queue.pop_front();
+		}
+
+		return queue.pop_prio<E>();
+	}
+
 	template <typename E, typename T>
 	static T* schedule(std::deque<T*>& queue, u32 protocol)
 	{
@@ -212,7 +212,7 @@ error_code sys_timer_connect_event_queue(u32 timer_id, u32 queue_id, u64 name, u
 
 	const auto timer = idm::check<lv2_obj, lv2_timer>(timer_id, [&](lv2_timer& timer) -> CellError
 	{
-		const auto found = idm::find_unlocked<lv2_obj, lv2_event_queue>(queue_id);
+		const auto found = idm::get<lv2_obj, lv2_event_queue>(queue_id);
 
 		if (!found)
 		{
@@ -227,7 +227,7 @@ error_code sys_timer_connect_event_queue(u32 timer_id, u32 queue_id, u64 name, u
 		}
 
 		// Connect event queue
-		timer.port   = std::static_pointer_cast<lv2_event_queue>(found->second);
+		timer.port   = found;
 		timer.source = name ? name : ((u64)process_getpid() << 32) | timer_id;
 		timer.data1  = data1;
 		timer.data2  = data2;
@@ -7,37 +7,75 @@ thread_local DECLARE(idm::g_id);
 DECLARE(idm::g_map);
 DECLARE(fxm::g_vec);
 
-id_manager::id_map::pointer idm::allocate_id(const id_manager::id_key& info, u32 base, u32 step, u32 count)
+id_manager::id_table::~id_table()
+{
+	clear();
+}
+
+id_manager::id_slot* id_manager::id_table::allocate(u32 index)
+{
+	if (index >= max_blocks * block_size)
+	{
+		return nullptr;
+	}
+
+	auto& block = m_blocks[index / block_size];
+
+	if (!block.load())
+	{
+		// Readers may access the block as soon as it's published
+		block.store(new id_slot[block_size]);
+	}
+
+	if (index >= m_size)
+	{
+		m_size = index + 1;
+	}
+
+	return block.load() + index % block_size;
+}
+
+void id_manager::id_table::clear()
+{
+	for (auto& block : m_blocks)
+	{
+		delete[] block.exchange(nullptr);
+	}
+
+	m_size = 0;
+}
+
+id_manager::id_slot* idm::allocate_id(const id_manager::id_key& info, u32 base, u32 step, u32 count)
 {
 	// Base type id is stored in value
-	auto& vec = g_map[info.value()];
+	auto& map = g_map[info.value()];
 
-	// Preallocate memory
-	vec.reserve(count);
+	const u32 size = map.size();
 
-	if (vec.size() < count)
+	if (size < count)
 	{
-		// Try to emplace back
-		const u32 _next = base + step * ::size32(vec);
+		// Try to use the next unused record
+		const u32 _next = base + step * size;
 
 		if (_next >= base && _next < base + step * count)
 		{
-			g_id = _next;
-			vec.emplace_back(id_manager::id_key(_next, info.type(), info.on_stop()), nullptr);
-			return &vec.back();
+			if (const auto ptr = map.allocate(size))
+			{
+				g_id = _next;
+				return ptr;
+			}
 		}
 	}
 
 	// Check all IDs starting from "next id" (TODO)
-	for (u32 i = 0, next = base; i < count; i++, next += step)
+	for (u32 i = 0, next = base; i < size; i++, next += step)
 	{
-		const auto ptr = &vec[i];
+		const auto ptr = map.find(i);
 
 		// Look for free ID
-		if (!ptr->second)
+		if (!ptr->ptr)
 		{
 			g_id = next;
-			ptr->first = id_manager::id_key(next, info.type(), info.on_stop());
 			return ptr;
 		}
 	}
@@ -49,21 +87,25 @@ id_manager::id_map::pointer idm::allocate_id(const id_manager::id_key& info, u32
 void idm::init()
 {
 	// Allocate
-	g_map.resize(id_manager::typeinfo::get_count());
+	g_map.reset(new id_manager::id_table[id_manager::typeinfo::get_count()]);
 }
 
 void idm::clear()
 {
 	// Call recorded finalization functions for all IDs
-	for (auto& map : g_map)
+	for (u32 i = 0, count = id_manager::typeinfo::get_count(); i < count; i++)
 	{
-		for (auto& pair : map)
+		auto& map = g_map[i];
+
+		for (u32 j = 0, size = map.size(); j < size; j++)
 		{
-			if (auto ptr = pair.second.get())
+			const auto slot = map.find(j);
+
+			if (auto ptr = slot->ptr.get())
 			{
-				pair.first.on_stop()(ptr);
-				pair.second.reset();
-				pair.first = {};
+				slot->key.on_stop()(ptr);
+				slot->ptr.reset();
+				slot->key = {};
 			}
 		}
 
@@ -171,7 +171,62 @@ namespace id_manager
 		}
 	};
 
-	using id_map = std::vector<std::pair<id_key, std::shared_ptr<void>>>;
+	// ID record, protected by its own lock
+	struct id_slot
+	{
+		shared_mutex mutex;
+		id_key key;
+		std::shared_ptr<void> ptr;
+	};
+
+	// ID records of one base type, allocated in fixed blocks which are never moved until cleared (lookups don't need a global lock)
+	class id_table
+	{
+		static constexpr u32 block_size = 256;
+		static constexpr u32 max_blocks = 0x10000 / block_size;
+
+		atomic_t<id_slot*> m_blocks[max_blocks]{};
+
+		// Number of records ever allocated
+		atomic_t<u32> m_size{0};
+
+	public:
+		id_table() = default;
+
+		id_table(const id_table&) = delete;
+
+		id_table& operator =(const id_table&) = delete;
+
+		~id_table();
+
+		// Get the record (returns nullptr if its block is not allocated)
+		id_slot* find(u32 index) const
+		{
+			if (UNLIKELY(index >= max_blocks * block_size))
+			{
+				return nullptr;
+			}
+
+			if (const auto block = m_blocks[index / block_size].load())
+			{
+				return block + index % block_size;
+			}
+
+			return nullptr;
+		}
+
+		// Get the number of records ever allocated
+		u32 size() const
+		{
+			return m_size;
+		}
+
+		// Get the record, allocate its block if necessary (requires g_mutex writer lock)
+		id_slot* allocate(u32 index);
+
+		// Remove all records (no concurrent access allowed)
+		void clear();
+	};
 }
 
 // Object manager for emulated process. Multiple objects of specified arbitrary type are given unique IDs.
@@ -181,7 +236,7 @@ class idm
 	static thread_local u32 g_id;
 
 	// Type Index -> ID -> Object. Use global since only one process is supported atm.
-	static std::vector<id_manager::id_map> g_map;
+	static std::unique_ptr<id_manager::id_table[]> g_map;
 
 	template <typename T>
 	static inline u32 get_type()
@@ -263,40 +318,43 @@ class idm
 		}
 	};
 
-	// Prepare new ID (returns nullptr if out of resources)
-	static id_manager::id_map::pointer allocate_id(const id_manager::id_key& info, u32 base, u32 step, u32 count);
+	// Prepare new ID (returns nullptr if out of resources, requires g_mutex writer lock)
+	static id_manager::id_slot* allocate_id(const id_manager::id_key& info, u32 base, u32 step, u32 count);
 
-	// Find ID (additionally check type if types are not equal)
+	// Find ID record without locking (its contents must be accessed under the record lock or g_mutex)
 	template <typename T, typename Type>
-	static id_manager::id_map::pointer find_id(u32 id)
+	static inline id_manager::id_slot* find_slot(u32 id)
 	{
 		static_assert(id_manager::id_verify<T, Type>::value, "Invalid ID type combination");
 
 		const u32 index = get_index<Type>(id);
 
-		auto& vec = g_map[get_type<T>()];
-
-		if (index >= vec.size() || index >= id_manager::id_traits<Type>::count)
+		if (index >= id_manager::id_traits<Type>::count)
 		{
 			return nullptr;
 		}
 
-		auto& data = vec[index];
+		return g_map[get_type<T>()].find(index);
+	}
 
-		if (data.second)
+	// Get the object from the locked ID record (additionally check type if types are not equal)
+	template <typename T, typename Type>
+	static inline Type* get_object(const id_manager::id_slot& slot)
+	{
+		if (slot.ptr)
 		{
-			if (std::is_same<T, Type>::value || data.first.type() == get_type<Type>())
+			if (std::is_same<T, Type>::value || slot.key.type() == get_type<Type>())
 			{
-				return &data;
+				return static_cast<Type*>(slot.ptr.get());
 			}
 		}
 
 		return nullptr;
 	}
 
-	// Allocate new ID and assign the object from the provider()
+	// Allocate new ID and assign the object from the provider() (returns the object, ID is stored in g_id)
 	template <typename T, typename Type, typename F>
-	static id_manager::id_map::pointer create_id(F&& provider)
+	static std::shared_ptr<void> create_id(F&& provider)
 	{
 		static_assert(id_manager::id_verify<T, Type>::value, "Invalid ID type combination");
 
@@ -312,11 +370,34 @@ class idm
 		if (auto* place = allocate_id(info, traits::base, traits::step, traits::count))
 		{
 			// Get object, store it
-			place->second = provider();
+			std::shared_ptr<void> ptr = provider();
+
+			if (ptr)
+			{
+				writer_lock slot_lock(place->mutex);
+				place->key = id_manager::id_key(g_id, info.type(), info.on_stop());
+				place->ptr = ptr;
+				return ptr;
+			}
+		}
+
+		return nullptr;
+	}
+
+	// Remove the object from the ID record, call func() under writer lock before (void result)
+	template <typename T, typename Get, typename F>
+	static inline std::shared_ptr<void> remove_id(u32 id, F&& func)
+	{
+		writer_lock lock(id_manager::g_mutex);
 
-			if (place->second)
+		if (const auto slot = find_slot<T, Get>(id))
+		{
+			writer_lock slot_lock(slot->mutex);
+
+			if (const auto ptr = get_object<T, Get>(*slot))
 			{
-				return place;
+				func(*ptr);
+				return std::move(slot->ptr);
 			}
 		}
 
@@ -340,10 +421,10 @@ public:
 	template <typename T, typename Make = T, typename... Args>
 	static inline std::enable_if_t<std::is_constructible<Make, Args...>::value, std::shared_ptr<Make>> make_ptr(Args&&... args)
 	{
-		if (auto pair = create_id<T, Make>([&] { return std::make_shared<Make>(std::forward<Args>(args)...); }))
+		if (auto ptr = create_id<T, Make>([&] { return std::make_shared<Make>(std::forward<Args>(args)...); }))
 		{
-			id_manager::on_init<Make>::func(static_cast<Make*>(pair->second.get()), pair->second);
-			return {pair->second, static_cast<Make*>(pair->second.get())};
+			id_manager::on_init<Make>::func(static_cast<Make*>(ptr.get()), ptr);
+			return {ptr, static_cast<Make*>(ptr.get())};
 		}
 
 		return nullptr;
@@ -353,10 +434,11 @@ public:
 	template <typename T, typename Make = T, typename... Args>
 	static inline std::enable_if_t<std::is_constructible<Make, Args...>::value, u32> make(Args&&... args)
 	{
-		if (auto pair = create_id<T, Make>([&] { return std::make_shared<Make>(std::forward<Args>(args)...); }))
+		if (auto ptr = create_id<T, Make>([&] { return std::make_shared<Make>(std::forward<Args>(args)...); }))
 		{
-			id_manager::on_init<Make>::func(static_cast<Make*>(pair->second.get()), pair->second);
-			return pair->first;
+			const u32 id = g_id;
+			id_manager::on_init<Make>::func(static_cast<Make*>(ptr.get()), ptr);
+			return id;
 		}
 
 		return id_manager::id_traits<Make>::invalid;
@@ -366,10 +448,11 @@ public:
 	template <typename T, typename Made = T>
 	static inline u32 import_existing(const std::shared_ptr<T>& ptr)
 	{
-		if (auto pair = create_id<T, Made>([&] { return ptr; }))
+		if (auto _ptr = create_id<T, Made>([&] { return ptr; }))
 		{
-			id_manager::on_init<Made>::func(static_cast<Made*>(pair->second.get()), pair->second);
-			return pair->first;
+			const u32 id = g_id;
+			id_manager::on_init<Made>::func(static_cast<Made*>(_ptr.get()), _ptr);
+			return id;
 		}
 
 		return id_manager::id_traits<Made>::invalid;
@@ -379,29 +462,38 @@ public:
 	template <typename T, typename Made = T, typename F, typename = std::result_of_t<F()>>
 	static inline u32 import(F&& provider)
 	{
-		if (auto pair = create_id<T, Made>(std::forward<F>(provider)))
+		if (auto ptr = create_id<T, Made>(std::forward<F>(provider)))
 		{
-			id_manager::on_init<Made>::func(static_cast<Made*>(pair->second.get()), pair->second);
-			return pair->first;
+			const u32 id = g_id;
+			id_manager::on_init<Made>::func(static_cast<Made*>(ptr.get()), ptr);
+			return id;
 		}
 
 		return id_manager::id_traits<Made>::invalid;
 	}
 
-	// Access the ID record without locking (unsafe)
+	// Access the ID record without locking (unsafe, requires g_mutex)
 	template <typename T, typename Get = T>
-	static inline id_manager::id_map::pointer find_unlocked(u32 id)
+	static inline id_manager::id_slot* find_unlocked(u32 id)
 	{
-		return find_id<T, Get>(id);
+		if (const auto slot = find_slot<T, Get>(id))
+		{
+			if (get_object<T, Get>(*slot))
+			{
+				return slot;
+			}
+		}
+
+		return nullptr;
 	}
 
-	// Check the ID without locking (can be called from other method)
+	// Check the ID without locking (can be called under g_mutex, i.e. from import provider or withdraw function)
 	template <typename T, typename Get = T>
 	static inline Get* check_unlocked(u32 id)
 	{
-		if (const auto found = find_id<T, Get>(id))
+		if (const auto slot = find_slot<T, Get>(id))
 		{
-			return static_cast<Get*>(found->second.get());
+			return get_object<T, Get>(*slot);
 		}
 
 		return nullptr;
@@ -411,23 +503,31 @@ public:
 	template <typename T, typename Get = T>
 	static inline Get* check(u32 id)
 	{
-		reader_lock lock(id_manager::g_mutex);
+		if (const auto slot = find_slot<T, Get>(id))
+		{
+			reader_lock lock(slot->mutex);
+
+			return get_object<T, Get>(*slot);
+		}
 
-		return check_unlocked<T, Get>(id);
+		return nullptr;
 	}
 
 	// Check the ID, access object under shared lock
 	template <typename T, typename Get = T, typename F, typename FRT = std::result_of_t<F(Get&)>, typename = std::enable_if_t<std::is_void<FRT>::value>>
 	static inline Get* check(u32 id, F&& func, int = 0)
 	{
-		reader_lock lock(id_manager::g_mutex);
-
-		if (const auto ptr = check_unlocked<T, Get>(id))
+		if (const auto slot = find_slot<T, Get>(id))
 		{
-			func(*ptr);
-			return ptr;
+			reader_lock lock(slot->mutex);
+
+			if (const auto ptr = get_object<T, Get>(*slot))
+			{
+				func(*ptr);
+				return ptr;
+			}
 		}
-		
+
 		return nullptr;
 	}
 
@@ -435,44 +535,74 @@ public:
 	template <typename T, typename Get = T, typename F, typename FRT = std::result_of_t<F(Get&)>, typename = std::enable_if_t<!std::is_void<FRT>::value>>
 	static inline return_pair<Get*, FRT> check(u32 id, F&& func)
 	{
-		reader_lock lock(id_manager::g_mutex);
+		if (const auto slot = find_slot<T, Get>(id))
+		{
+			reader_lock lock(slot->mutex);
+
+			if (const auto ptr = get_object<T, Get>(*slot))
+			{
+				return {ptr, func(*ptr)};
+			}
+		}
 
-		if (const auto ptr = check_unlocked<T, Get>(id))
+		return {nullptr};
+	}
+
+	// Check the ID, access object under writer lock (excludes other accessors of the same object), propagate return value
+	template <typename T, typename Get = T, typename F, typename FRT = std::result_of_t<F(Get&)>, typename = std::enable_if_t<!std::is_void<FRT>::value>>
+	static inline return_pair<Get*, FRT> check_exclusive(u32 id, F&& func)
+	{
+		if (const auto slot = find_slot<T, Get>(id))
 		{
-			return {ptr, func(*ptr)};
+			writer_lock lock(slot->mutex);
+
+			if (const auto ptr = get_object<T, Get>(*slot))
+			{
+				return {ptr, func(*ptr)};
+			}
 		}
 
 		return {nullptr};
 	}
 
-	// Get the object without locking (can be called from other method)
+	// Get the object without locking (can be called under g_mutex, i.e. from import provider or withdraw function)
 	template <typename T, typename Get = T>
 	static inline std::shared_ptr<Get> get_unlocked(u32 id)
 	{
-		const auto found = find_id<T, Get>(id);
+		const auto slot = find_slot<T, Get>(id);
 
-		if (UNLIKELY(found == nullptr))
+		if (UNLIKELY(slot == nullptr))
 		{
 			return nullptr;
 		}
 
-		return {found->second, static_cast<Get*>(found->second.get())};
+		if (const auto ptr = get_object<T, Get>(*slot))
+		{
+			return {slot->ptr, ptr};
+		}
+
+		return nullptr;
 	}
 
 	// Get the object
 	template <typename T, typename Get = T>
 	static inline std::shared_ptr<Get> get(u32 id)
 	{
-		reader_lock lock(id_manager::g_mutex);
-
-		const auto found = find_id<T, Get>(id);
+		const auto slot = find_slot<T, Get>(id);
 
-		if (UNLIKELY(found == nullptr))
+		if (UNLIKELY(slot == nullptr))
 		{
 			return nullptr;
 		}
 
-		return {found->second, static_cast<Get*>(found->second.get())};
+		reader_lock lock(slot->mutex);
+
+		if (const auto ptr = get_object<T, Get>(*slot))
+		{
+			return {slot->ptr, ptr};
+		}
+
+		return nullptr;
 	}
 
 	// Get the object, access object under reader lock
@@ -481,20 +611,25 @@ public:
 	{
 		using result_type = std::shared_ptr<Get>;
 
-		reader_lock lock(id_manager::g_mutex);
-
-		const auto found = find_id<T, Get>(id);
+		const auto slot = find_slot<T, Get>(id);
 
-		if (UNLIKELY(found == nullptr))
+		if (UNLIKELY(slot == nullptr))
 		{
 			return result_type{nullptr};
 		}
 
-		const auto ptr = static_cast<Get*>(found->second.get());
+		reader_lock lock(slot->mutex);
+
+		const auto ptr = get_object<T, Get>(*slot);
+
+		if (UNLIKELY(ptr == nullptr))
+		{
+			return result_type{nullptr};
+		}
 
 		func(*ptr);
 
-		return result_type{found->second, ptr};
+		return result_type{slot->ptr, ptr};
 	}
 
 	// Get the object, access object under reader lock, propagate return value
@@ -503,46 +638,55 @@ public:
 	{
 		using result_type = return_pair<Get, FRT>;
 
-		reader_lock lock(id_manager::g_mutex);
-
-		const auto found = find_id<T, Get>(id);
+		const auto slot = find_slot<T, Get>(id);
 
-		if (UNLIKELY(found == nullptr))
+		if (UNLIKELY(slot == nullptr))
 		{
 			return result_type{nullptr};
 		}
 
-		const auto ptr = static_cast<Get*>(found->second.get());
+		reader_lock lock(slot->mutex);
+
+		const auto ptr = get_object<T, Get>(*slot);
+
+		if (UNLIKELY(ptr == nullptr))
+		{
+			return result_type{nullptr};
+		}
 
-		return result_type{{found->second, ptr}, func(*ptr)};
+		return result_type{{slot->ptr, ptr}, func(*ptr)};
 	}
 
-	// Access all objects of specified type. Returns the number of objects processed.
+	// Access all objects of specified type (each one under its reader lock). Returns the number of objects processed.
 	template <typename T, typename Get = T, typename F, typename FT = decltype(&std::decay_t<F>::operator()), typename FRT = typename function_traits<FT>::void_type>
 	static inline u32 select(F&& func, int = 0)
 	{
 		static_assert(id_manager::id_verify<T, Get>::value, "Invalid ID type combination");
 
-		reader_lock lock(id_manager::g_mutex);
+		using object_type = typename function_traits<FT>::object_type;
+
+		auto& map = g_map[get_type<T>()];
 
 		u32 result = 0;
 
-		for (auto& id : g_map[get_type<T>()])
+		for (u32 i = 0, size = map.size(); i < size; i++)
 		{
-			if (id.second)
+			if (const auto slot = map.find(i))
 			{
-				if (std::is_same<T, Get>::value || id.first.type() == get_type<Get>())
+				reader_lock lock(slot->mutex);
+
+				if (const auto ptr = get_object<T, Get>(*slot))
 				{
-					func(id.first, *static_cast<typename function_traits<FT>::object_type*>(id.second.get()));
+					func(slot->key, *static_cast<object_type*>(ptr));
 					result++;
 				}
 			}
-		}	
+		}
 
 		return result;
 	}
 
-	// Access all objects of specified type. If function result evaluates to true, stop and return the object and the value.
+	// Access all objects of specified type (each one under its reader lock). If function result evaluates to true, stop and return the object and the value.
 	template <typename T, typename Get = T, typename F, typename FT = decltype(&std::decay_t<F>::operator()), typename FRT = typename function_traits<FT>::result_type>
 	static inline auto select(F&& func)
 	{
@@ -551,17 +695,19 @@ public:
 		using object_type = typename function_traits<FT>::object_type;
 		using result_type = return_pair<object_type, FRT>;
 
-		reader_lock lock(id_manager::g_mutex);
+		auto& map = g_map[get_type<T>()];
 
-		for (auto& id : g_map[get_type<T>()])
+		for (u32 i = 0, size = map.size(); i < size; i++)
 		{
-			if (auto ptr = static_cast<object_type*>(id.second.get()))
+			if (const auto slot = map.find(i))
 			{
-				if (std::is_same<T, Get>::value || id.first.type() == get_type<Get>())
+				reader_lock lock(slot->mutex);
+
+				if (const auto ptr = static_cast<object_type*>(get_object<T, Get>(*slot)))
 				{
-					if (FRT result = func(id.first, *ptr))
+					if (FRT result = func(slot->key, *ptr))
 					{
-						return result_type{{id.second, ptr}, std::move(result)};
+						return result_type{{slot->ptr, ptr}, std::move(result)};
 					}
 				}
 			}
@@ -574,18 +720,11 @@ public:
 	template <typename T, typename Get = T>
 	static inline explicit_bool_t remove(u32 id)
 	{
-		std::shared_ptr<void> ptr;
-		{
-			writer_lock lock(id_manager::g_mutex);
+		const auto ptr = remove_id<T, Get>(id, [](Get&) {});
 
-			if (const auto found = find_id<T, Get>(id))
-			{
-				ptr = std::move(found->second);
-			}
-			else
-			{
-				return false;
-			}
+		if (!ptr)
+		{
+			return false;
 		}
 
 		id_manager::on_stop<Get>::func(static_cast<Get*>(ptr.get()));
@@ -596,18 +735,11 @@ public:
 	template <typename T, typename Get = T>
 	static inline std::shared_ptr<Get> withdraw(u32 id)
 	{
-		std::shared_ptr<void> ptr;
-		{
-			writer_lock lock(id_manager::g_mutex);
+		const auto ptr = remove_id<T, Get>(id, [](Get&) {});
 
-			if (const auto found = find_id<T, Get>(id))
-			{
-				ptr = std::move(found->second);
-			}
-			else
-			{
-				return nullptr;
-			}
+		if (!ptr)
+		{
+			return nullptr;
 		}
 
 		id_manager::on_stop<Get>::func(static_cast<Get*>(ptr.get()));
@@ -620,20 +752,11 @@ public:
 	{
 		using result_type = std::shared_ptr<Get>;
 
-		std::shared_ptr<void> ptr;
-		{
-			writer_lock lock(id_manager::g_mutex);
+		const auto ptr = remove_id<T, Get>(id, std::forward<F>(func));
 
-			if (const auto found = find_id<T, Get>(id))
-			{
-				func(*static_cast<Get*>(found->second.get()));
-
-				ptr = std::move(found->second);
-			}
-			else
-			{
-				return result_type{nullptr};
-			}
+		if (!ptr)
+		{
+			return result_type{nullptr};
 		}
 
 		id_manager::on_stop<Get>::func(static_cast<Get*>(ptr.get()));
@@ -651,18 +774,25 @@ public:
 		{
 			writer_lock lock(id_manager::g_mutex);
 
-			if (const auto found = find_id<T, Get>(id))
+			const auto slot = find_slot<T, Get>(id);
+
+			if (UNLIKELY(slot == nullptr))
 			{
-				const auto _ptr = static_cast<Get*>(found->second.get());
+				return result_type{nullptr};
+			}
 
+			writer_lock slot_lock(slot->mutex);
+
+			if (const auto _ptr = get_object<T, Get>(*slot))
+			{
 				ret = func(*_ptr);
 
 				if (ret)
 				{
-					return result_type{{found->second, _ptr}, std::move(ret)};
+					return result_type{{slot->ptr, _ptr}, std::move(ret)};
 				}
 
-				ptr = std::move(found->second);
+				ptr = std::move(slot->ptr);
 			}
 			else
 			{
@@ -3,6 +3,9 @@
 
 VirtualMemoryBlock RSXIOMem;
 
+constexpr u32 VirtualMemoryBlock::unmapped_page;
+constexpr u16 VirtualMemoryBlock::unmapped_real_page;
+
 VirtualMemoryBlock* VirtualMemoryBlock::SetRange(const u32 start, const u32 size)
 {
 	m_range_start = start;
@@ -11,6 +14,44 @@ VirtualMemoryBlock* VirtualMemoryBlock::SetRange(const u32 start, const u32 size
 	return this;
 }
 
+void VirtualMemoryBlock::Clear()
+{
+	m_mapped_memory.clear();
+	m_reserve_size = 0;
+	m_range_start = 0;
+	m_range_size = 0;
+
+	for (auto& page : m_real_pages)
+	{
+		page = unmapped_page;
+	}
+
+	for (auto& page : m_mapped_pages)
+	{
+		page = unmapped_real_page;
+	}
+}
+
+void VirtualMemoryBlock::SetPages(u32 addr, u32 realaddr, u32 size)
+{
+	for (u32 i = 0; i < size >> page_shift; i++)
+	{
+		const u32 page = (addr >> page_shift) + i;
+
+		if (realaddr == unmapped_page)
+		{
+			// Remove reverse mapping only if it still points to this page
+			const u32 old = m_real_pages[page].exchange(unmapped_page);
+			m_mapped_pages[old >> page_shift].compare_and_swap(page, unmapped_real_page);
+		}
+		else
+		{
+			m_real_pages[page] = realaddr + (i << page_shift);
+			m_mapped_pages[(realaddr >> page_shift) + i] = page;
+		}
+	}
+}
+
 bool VirtualMemoryBlock::IsInMyRange(const u32 addr, const u32 size)
 {
 	return addr >= m_range_start && addr + size - 1 <= m_range_start + m_range_size - 1 - GetReservedAmount();
@@ -18,29 +59,25 @@ bool VirtualMemoryBlock::IsInMyRange(const u32 addr, const u32 size)
 
 u32 VirtualMemoryBlock::Map(u32 realaddr, u32 size)
 {
-	verify(HERE), (size);
+	verify(HERE), (size), (size & (page_size - 1)) == 0, (realaddr & (page_size - 1)) == 0;
 
-	for (u32 addr = m_range_start; addr <= m_range_start + m_range_size - 1 - GetReservedAmount() - size;)
+	// Find the first free area using the page table
+	for (u32 addr = m_range_start, free = 0; addr < m_range_start + m_range_size - GetReservedAmount(); addr += page_size)
 	{
-		bool is_good_addr = true;
-
-		// check if address is already mapped
-		for (u32 i = 0; i<m_mapped_memory.size(); ++i)
+		if (m_real_pages[addr >> page_shift] != unmapped_page)
 		{
-			if ((addr >= m_mapped_memory[i].addr && addr < m_mapped_memory[i].addr + m_mapped_memory[i].size) ||
-				(m_mapped_memory[i].addr >= addr && m_mapped_memory[i].addr < addr + size))
-			{
-				is_good_addr = false;
-				addr = m_mapped_memory[i].addr + m_mapped_memory[i].size;
-				break;
-			}
+			free = 0;
+			continue;
 		}
 
-		if (!is_good_addr) continue;
-
-		m_mapped_memory.emplace_back(addr, realaddr, size);
+		if ((free += page_size) == size)
+		{
+			const u32 start = addr + page_size - size;
 
-		return addr;
+			m_mapped_memory.emplace_back(start, realaddr, size);
+			SetPages(start, realaddr, size);
+			return start;
+		}
 	}
 
 	return 0;
@@ -48,22 +85,23 @@ u32 VirtualMemoryBlock::Map(u32 realaddr, u32 size)
 
 bool VirtualMemoryBlock::Map(u32 realaddr, u32 size, u32 addr)
 {
-	verify(HERE), (size);
+	verify(HERE), (size), (size & (page_size - 1)) == 0, (realaddr & (page_size - 1)) == 0;
 
-	if (!IsInMyRange(addr, size))
+	if (!IsInMyRange(addr, size) || addr & (page_size - 1))
 	{
 		return false;
 	}
 
-	for (u32 i = 0; i<m_mapped_memory.size(); ++i)
+	for (u32 i = 0; i < size >> page_shift; i++)
 	{
-		if (addr >= m_mapped_memory[i].addr && addr + size - 1 <= m_mapped_memory[i].addr + m_mapped_memory[i].size - 1)
+		if (m_real_pages[(addr >> page_shift) + i] != unmapped_page)
 		{
 			return false;
 		}
 	}
 
 	m_mapped_memory.emplace_back(addr, realaddr, size);
+	SetPages(addr, realaddr, size);
 	return true;
 }
 
@@ -74,6 +112,7 @@ bool VirtualMemoryBlock::UnmapRealAddress(u32 realaddr, u32& size)
 		if (m_mapped_memory[i].realAddress == realaddr && IsInMyRange(m_mapped_memory[i].addr, m_mapped_memory[i].size))
 		{
 			size = m_mapped_memory[i].size;
+			SetPages(m_mapped_memory[i].addr, unmapped_page, size);
 			m_mapped_memory.erase(m_mapped_memory.begin() + i);
 			return true;
 		}
@@ -89,6 +128,7 @@ bool VirtualMemoryBlock::UnmapAddress(u32 addr, u32& size)
 		if (m_mapped_memory[i].addr == addr && IsInMyRange(m_mapped_memory[i].addr, m_mapped_memory[i].size))
 		{
 			size = m_mapped_memory[i].size;
+			SetPages(addr, unmapped_page, size);
 			m_mapped_memory.erase(m_mapped_memory.begin() + i);
 			return true;
 		}
@@ -115,33 +155,6 @@ bool VirtualMemoryBlock::Write32(const u32 addr, const u32 value)
 	return true;
 }
 
-bool VirtualMemoryBlock::getRealAddr(u32 addr, u32& result)
-{
-	for (u32 i = 0; i<m_mapped_memory.size(); ++i)
-	{
-		if (addr >= m_mapped_memory[i].addr && addr < m_mapped_memory[i].addr + m_mapped_memory[i].size)
-		{
-			result = m_mapped_memory[i].realAddress + (addr - m_mapped_memory[i].addr);
-			return true;
-		}
-	}
-
-	return false;
-}
-
-u32 VirtualMemoryBlock::getMappedAddress(u32 realAddress)
-{
-	for (u32 i = 0; i<m_mapped_memory.size(); ++i)
-	{
-		if (realAddress >= m_mapped_memory[i].realAddress && realAddress < m_mapped_memory[i].realAddress + m_mapped_memory[i].size)
-		{
-			return m_mapped_memory[i].addr + (realAddress - m_mapped_memory[i].realAddress);
-		}
-	}
-
-	return 0;
-}
-
 bool VirtualMemoryBlock::Reserve(u32 size)
 {
 	if (size + GetReservedAmount() > m_range_size)
@@ -35,18 +35,41 @@ struct VirtualMemInfo : public MemInfo
 	}
 };
 
+// Address space mapped with 1 MB pages (like GCM IO offset table)
 class VirtualMemoryBlock
 {
+	static const u32 page_shift = 20;
+	static const u32 page_size = 1 << page_shift;
+	static const u32 page_count = 0x1000; // 4 GB / 1 MB
+
+	// Page table entry of an unmapped page
+	static constexpr u32 unmapped_page = ~0u;
+
+	// Reverse page table entry of an unmapped real page
+	static constexpr u16 unmapped_real_page = 0xffff;
+
 	std::vector<VirtualMemInfo> m_mapped_memory;
 	u32 m_reserve_size = 0;
 	u32 m_range_start = 0;
 	u32 m_range_size = 0;
 
+	// Mapped address page -> real address of the page (or unmapped_page)
+	std::array<atomic_t<u32>, page_count> m_real_pages;
+
+	// Real address page -> mapped address page (or unmapped_real_page)
+	std::array<atomic_t<u16>, page_count> m_mapped_pages;
+
+	// Update page tables for the specified area (in bytes), set realaddr to unmapped_page to unmap
+	void SetPages(u32 addr, u32 realaddr, u32 size);
+
 public:
-	VirtualMemoryBlock() = default;
+	VirtualMemoryBlock()
+	{
+		Clear();
+	}
 
 	VirtualMemoryBlock* SetRange(const u32 start, const u32 size);
-	void Clear() { m_mapped_memory.clear(); m_reserve_size = 0; m_range_start = 0; m_range_size = 0; }
+	void Clear();
 	u32 GetStartAddr() const { return m_range_start; }
 	u32 GetSize() const { return m_range_size; }
 	bool IsInMyRange(const u32 addr, const u32 size);
@@ -77,7 +100,18 @@ public:
 
 	// try to get the real address given a mapped address
 	// return true for success
-	bool getRealAddr(u32 addr, u32& result);
+	bool getRealAddr(u32 addr, u32& result)
+	{
+		const u32 page = m_real_pages[addr >> page_shift];
+
+		if (page == unmapped_page)
+		{
+			return false;
+		}
+
+		result = page | (addr & (page_size - 1));
+		return true;
+	}
 
 	u32 RealAddr(u32 addr)
 	{
@@ -93,5 +127,15 @@ public:
 	}
 
 	// return the mapped address given a real address, if not mapped return 0
-	u32 getMappedAddress(u32 realAddress);
+	u32 getMappedAddress(u32 realAddress)
+	{
+		const u16 page = m_mapped_pages[realAddress >> page_shift];
+
+		if (page == unmapped_real_page)
+		{
+			return 0;
+		}
+
+		return u32{page} << page_shift | (realAddress & (page_size - 1));
+	}
 };
@@ -21,6 +21,7 @@
 #include "wait_engine.h"
 
 #include <mutex>
+#include <thread>
 
 namespace vm
 {
@@ -97,77 +98,197 @@ namespace vm
 		g_tls_fault_count &= ~(1ull << 63);
 	}
 
-	using reservation_mutex_t = std::mutex;
+	using memory_mutex_t = std::mutex;
 
-	thread_ctrl* volatile g_reservation_owner = nullptr;
+	// Memory map mutex (reservations don't use it)
+	memory_mutex_t g_mutex;
 
-	u32 g_reservation_addr = 0;
-	u32 g_reservation_size = 0;
+	// Reservation stamp of 128-byte lines (hashed by line address): bit 0 is the update lock, other bits are the version.
+	// Every stamp occupies its own cache line, so threads using adjacent lines don't contend.
+	struct alignas(64) reservation_stamp
+	{
+		atomic_t<u64> value{0};
+	};
+
+	std::array<reservation_stamp, 0x10000> g_reservations{};
+
+	// Reservation of the current thread
+	struct reservation_info
+	{
+		u32 addr = 0;
+		u32 size = 0;
+		u64 stamp = 0;
+		alignas(16) u8 data[128];
+	};
+
+	thread_local reservation_info g_tls_reservation;
 
 	thread_local bool g_tls_did_break_reservation = false;
 
-	reservation_mutex_t g_reservation_mutex;
+	static bool _page_set_protection(u32 page, u32 count, u8 flags);
+
+	static bool _page_sync_faults(u32 first, u32 last);
 
-	void _reservation_set(u32 addr, bool no_access = false)
+	// Get host protection flags of the page (watched pages are not writable)
+	static inline u8 _page_host_flags(u32 page, u8 flags)
 	{
-#ifdef _WIN32
-		DWORD old;
-		if (!::VirtualProtect(vm::base(addr & ~0xfff), 4096, no_access ? PAGE_NOACCESS : PAGE_READONLY, &old))
-#else
-		if (::mprotect(vm::base(addr & ~0xfff), 4096, no_access ? PROT_NONE : PROT_READ))
-#endif
+		return flags & page_watched ? flags & page_readable : flags & (page_readable | page_writable);
+	}
+
+	static inline atomic_t<u64>& _reservation_stamp(u32 addr)
+	{
+		return g_reservations[(addr >> 7) % g_reservations.size()].value;
+	}
+
+	static inline void _reservation_check_args(u32 addr, u32 size)
+	{
+		const u64 align = 0x80000000ull >> cntlz32(size, true);
+
+		// Reservations never cross a 128-byte line (unlike the old page-based reservations limited to 4096 bytes)
+		if (!size || !addr || size > 128 || size != align || addr & (align - 1))
 		{
-			fmt::throw_exception("System failure (addr=0x%x)" HERE, addr);
+			fmt::throw_exception("Invalid arguments (addr=0x%x, size=0x%x)" HERE, addr, size);
 		}
 	}
 
-	bool _reservation_break(u32 addr)
+	// Wait until the stamp is unlocked and return it
+	static inline u64 _reservation_wait(atomic_t<u64>& stamp)
 	{
-		if (g_reservation_addr >> 12 == addr >> 12)
+		for (u32 i = 0;; i++)
 		{
-#ifdef _WIN32
-			DWORD old;
-			if (!::VirtualProtect(vm::base(addr & ~0xfff), 4096, PAGE_READWRITE, &old))
-#else
-			if (::mprotect(vm::base(addr & ~0xfff), 4096, PROT_READ | PROT_WRITE))
-#endif
+			const u64 value = stamp.load();
+
+			if (LIKELY((value & 1) == 0))
 			{
-				fmt::throw_exception("System failure (addr=0x%x)" HERE, addr);
+				return value;
 			}
 
-			g_reservation_addr = 0;
-			g_reservation_size = 0;
-			g_reservation_owner = nullptr;
-			
-			return true;
+			if (i < 100)
+			{
+				_mm_pause();
+			}
+			else
+			{
+				std::this_thread::yield();
+			}
 		}
+	}
 
-		return false;
+	// Lock the stamp for update, return its previous (unlocked) value
+	static inline u64 _reservation_lock(atomic_t<u64>& stamp)
+	{
+		while (true)
+		{
+			const u64 value = _reservation_wait(stamp);
+
+			if (LIKELY(stamp.compare_and_swap_test(value, value + 1)))
+			{
+				return value;
+			}
+		}
 	}
 
-	void reservation_break(u32 addr)
+	// Atomically replace reserved data with a single host instruction
+	template<typename T>
+	static inline bool _reservation_cas(u32 addr, const void* old_data, const void* new_data)
 	{
-		std::unique_lock<reservation_mutex_t> lock(g_reservation_mutex);
+		T old_value, new_value;
+		std::memcpy(&old_value, old_data, sizeof(T));
+		std::memcpy(&new_value, new_data, sizeof(T));
 
-		const u32 raddr = g_reservation_addr;
-		const u32 rsize = g_reservation_size;
+		return atomic_storage<T>::compare_exchange(*static_cast<T*>(vm::base_priv(addr)), old_value, new_value);
+	}
+
+	// Atomically replace reserved data of 16..128 bytes chunk by chunk (the line must be locked by the stamp).
+	// Normal stores aren't blocked: if one changed a chunk not written yet, written chunks are reverted and the update fails.
+	static bool _reservation_cas_line(u32 addr, const void* old_data, const void* new_data, u32 size)
+	{
+		const auto ptr = static_cast<u128*>(vm::base_priv(addr));
+		const auto _old = static_cast<const u8*>(old_data);
+		const auto _new = static_cast<const u8*>(new_data);
 
-		if ((g_tls_did_break_reservation = _reservation_break(addr)))
+		// fail early without writing anything
+		if (std::memcmp(ptr, _old, size) != 0)
 		{
-			lock.unlock(), vm::notify_at(raddr, rsize);
+			return false;
 		}
+
+		for (u32 i = 0; i < size / 16; i++)
+		{
+			u128 old_value, new_value;
+			std::memcpy(&old_value, _old + i * 16, 16);
+			std::memcpy(&new_value, _new + i * 16, 16);
+
+			if (LIKELY(atomic_storage<u128>::compare_exchange(ptr[i], old_value, new_value)))
+			{
+				continue;
+			}
+
+			// revert written chunks, keeping bytes changed by normal stores since
+			while (i--)
+			{
+				u128 value = atomic_storage<u128>::load(ptr[i]);
+
+				while (true)
+				{
+					u8 bytes[16];
+					std::memcpy(bytes, &value, 16);
+
+					for (u32 j = 0; j < 16; j++)
+					{
+						if (bytes[j] == _new[i * 16 + j])
+						{
+							bytes[j] = _old[i * 16 + j];
+						}
+					}
+
+					std::memcpy(&new_value, bytes, 16);
+
+					if (atomic_storage<u128>::compare_exchange(ptr[i], value, new_value))
+					{
+						break;
+					}
+				}
+			}
+
+			return false;
+		}
+
+		return true;
 	}
 
-	void reservation_acquire(void* data, u32 addr, u32 size)
+	// Check whether the current thread's reservation is still valid (stamp and data unchanged)
+	static inline bool _reservation_valid(u32 addr, u32 size, u64 stamp)
 	{
-		std::lock_guard<reservation_mutex_t> lock(g_reservation_mutex);
+		const auto& res = g_tls_reservation;
 
-		const u64 align = 0x80000000ull >> cntlz32(size, true);
+		return res.addr == addr && res.size == size && res.stamp == stamp && std::memcmp(res.data, vm::base_priv(addr), size) == 0;
+	}
+
+	// Increment the version of every reservation line in the specified range
+	static void _reservation_break(u32 addr, u32 size)
+	{
+		const u32 start = addr >> 7;
+		const u32 count = std::min<u64>(((u64{addr} + size + 127) >> 7) - start, g_reservations.size());
 
-		if (!size || !addr || size > 4096 || size != align || addr & (align - 1))
+		for (u32 i = 0; i < count; i++)
 		{
-			fmt::throw_exception("Invalid arguments (addr=0x%x, size=0x%x)" HERE, addr, size);
+			g_reservations[(start + i) % g_reservations.size()].value += 2;
 		}
+	}
+
+	void reservation_break(u32 addr)
+	{
+		_reservation_break(addr & ~127, 128);
+
+		g_tls_did_break_reservation = true;
+
+		vm::notify_at(addr & ~127, 128);
+	}
+
+	void reservation_acquire(void* data, u32 addr, u32 size)
+	{
+		_reservation_check_args(addr, size);
 
 		const u8 flags = g_pages[addr >> 12];
 
@@ -176,154 +297,122 @@ namespace vm
 			fmt::throw_exception("Invalid page flags (addr=0x%x, size=0x%x, flags=0x%x)" HERE, addr, size, flags);
 		}
 
-		// break the reservation
-		g_tls_did_break_reservation = g_reservation_owner && _reservation_break(g_reservation_addr);
+		auto& res = g_tls_reservation;
+		auto& stamp = _reservation_stamp(addr);
 
-		// change memory protection to read-only
-		_reservation_set(addr);
+		// replace the previous reservation
+		g_tls_did_break_reservation = res.addr != 0;
+
+		while (true)
+		{
+			const u64 value = _reservation_wait(stamp);
 
-		// may not be necessary
-		_mm_mfence();
+			// read data (may be concurrently modified)
+			std::memcpy(res.data, vm::base(addr), size);
 
-		// set additional information
-		g_reservation_addr = addr;
-		g_reservation_size = size;
-		g_reservation_owner = thread_ctrl::get_current();
+			if (LIKELY(stamp.load() == value))
+			{
+				res.addr = addr;
+				res.size = size;
+				res.stamp = value;
+				break;
+			}
+		}
 
 		// copy data
-		std::memcpy(data, vm::base(addr), size);
+		std::memcpy(data, res.data, size);
 	}
 
 	bool reservation_update(u32 addr, const void* data, u32 size)
 	{
-		std::unique_lock<reservation_mutex_t> lock(g_reservation_mutex);
+		_reservation_check_args(addr, size);
 
-		const u64 align = 0x80000000ull >> cntlz32(size, true);
+		auto& res = g_tls_reservation;
 
-		if (!size || !addr || size > 4096 || size != align || addr & (align - 1))
-		{
-			fmt::throw_exception("Invalid arguments (addr=0x%x, size=0x%x)" HERE, addr, size);
-		}
-
-		if (g_reservation_owner != thread_ctrl::get_current() || g_reservation_addr != addr || g_reservation_size != size)
+		if (res.addr != addr || res.size != size)
 		{
 			// atomic update failed
+			res.addr = 0;
 			return false;
 		}
 
-		// change memory protection to no access
-		_reservation_set(addr, true);
+		auto& stamp = _reservation_stamp(addr);
 
-		// update memory using privileged access
-		std::memcpy(vm::base_priv(addr), data, size);
+		res.addr = 0;
 
-		// free the reservation and restore memory protection
-		_reservation_break(addr);
-
-		// notify waiter
-		lock.unlock(), vm::notify_at(addr, size);
+		// lock the line if its version didn't change
+		if (!stamp.compare_and_swap_test(res.stamp, res.stamp + 1))
+		{
+			return false;
+		}
 
-		// atomic update succeeded
-		return true;
-	}
+		bool result;
 
-	bool reservation_query(u32 addr, u32 size, bool is_writing, std::function<bool()> callback)
-	{
-		std::unique_lock<reservation_mutex_t> lock(g_reservation_mutex);
+		switch (size)
+		{
+		// compare and write with a single atomic instruction
+		case 1: result = _reservation_cas<u8>(addr, res.data, data); break;
+		case 2: result = _reservation_cas<u16>(addr, res.data, data); break;
+		case 4: result = _reservation_cas<u32>(addr, res.data, data); break;
+		case 8: result = _reservation_cas<u64>(addr, res.data, data); break;
+		// compare and write 16-byte chunks, detecting normal stores in the middle
+		default: result = _reservation_cas_line(addr, res.data, data, size); break;
+		}
 
-		if (!check_addr(addr))
+		if (!result)
 		{
+			stamp += 1;
 			return false;
 		}
 
-		// check if current reservation and address may overlap
-		if (g_reservation_addr >> 12 == addr >> 12 && is_writing)
-		{
-			const bool result = callback(); 
+		page_notify_write(addr, size);
 
-			if (result && size && addr + size - 1 >= g_reservation_addr && g_reservation_addr + g_reservation_size - 1 >= addr)
-			{
-				const u32 raddr = g_reservation_addr;
-				const u32 rsize = g_reservation_size;
+		// unlock with the new version
+		stamp += 1;
 
-				// break the reservation if overlap
-				if ((g_tls_did_break_reservation = _reservation_break(addr)))
-				{
-					lock.unlock(), vm::notify_at(raddr, rsize);
-				}
-			}
-			
-			return result;
-		}
-		
+		// notify waiter
+		vm::notify_at(addr, size);
+
+		// atomic update succeeded
 		return true;
 	}
 
-	bool reservation_test(thread_ctrl* current)
+	bool reservation_test()
 	{
-		const auto owner = g_reservation_owner;
+		const auto& res = g_tls_reservation;
 
-		return owner && owner == current;
+		return res.addr && _reservation_valid(res.addr, res.size, _reservation_stamp(res.addr));
 	}
 
 	void reservation_free()
 	{
-		auto thread = thread_ctrl::get_current();
-
-		if (reservation_test(thread))
-		{
-			std::lock_guard<reservation_mutex_t> lock(g_reservation_mutex);
-
-			if (g_reservation_owner && g_reservation_owner == thread)
-			{
-				g_tls_did_break_reservation = _reservation_break(g_reservation_addr);
-			}
-		}
+		g_tls_did_break_reservation = std::exchange(g_tls_reservation.addr, 0) != 0;
 	}
 
 	void reservation_op(u32 addr, u32 size, std::function<void()> proc)
 	{
-		std::unique_lock<reservation_mutex_t> lock(g_reservation_mutex);
-
-		const u64 align = 0x80000000ull >> cntlz32(size, true);
-
-		if (!size || !addr || size > 4096 || size != align || addr & (align - 1))
-		{
-			fmt::throw_exception("Invalid arguments (addr=0x%x, size=0x%x)" HERE, addr, size);
-		}
-
-		g_tls_did_break_reservation = false;
-
-		// check and possibly break previous reservation
-		if (g_reservation_owner != thread_ctrl::get_current() || g_reservation_addr != addr || g_reservation_size != size)
-		{
-			if (g_reservation_owner)
-			{
-				_reservation_break(g_reservation_addr);
-			}
+		_reservation_check_args(addr, size);
 
-			g_tls_did_break_reservation = true;
-		}
+		auto& stamp = _reservation_stamp(addr);
 
-		// change memory protection to no access
-		_reservation_set(addr, true);
+		// lock the line
+		const u64 value = _reservation_lock(stamp);
 
-		// set additional information
-		g_reservation_addr = addr;
-		g_reservation_size = size;
-		g_reservation_owner = thread_ctrl::get_current();
+		// check the current thread's reservation
+		g_tls_did_break_reservation = !_reservation_valid(addr, size, value);
 
-		// may not be necessary
-		_mm_mfence();
+		// remove the reservation
+		g_tls_reservation.addr = 0;
 
-		// do the operation
+		// do the operation (only other reservation functions are excluded)
 		proc();
+		page_notify_write(addr, size);
 
-		// remove the reservation
-		_reservation_break(addr);
+		// unlock with the new version
+		stamp += 1;
 
 		// notify waiter
-		lock.unlock(), vm::notify_at(addr, size);
+		vm::notify_at(addr, size);
 	}
 
 	void _page_map(u32 addr, u32 size, u8 flags)
@@ -366,17 +455,77 @@ namespace vm
 		std::memset(priv_addr, 0, size); // ???
 	}
 
+	// Set host protection of contiguous pages [page, page + count) according to flags
+	static bool _page_set_protection(u32 page, u32 count, u8 flags)
+	{
+		void* real_addr = vm::base(page * 4096);
+
+#ifdef _WIN32
+		DWORD old;
+
+		auto protection = flags & page_writable ? PAGE_READWRITE : (flags & page_readable ? PAGE_READONLY : PAGE_NOACCESS);
+		return ::VirtualProtect(real_addr, count * 4096, protection, &old) != FALSE;
+#else
+		auto protection = flags & page_writable ? PROT_WRITE | PROT_READ : (flags & page_readable ? PROT_READ : PROT_NONE);
+		return ::mprotect(real_addr, count * 4096, protection) == 0;
+#endif
+	}
+
+	// Update page flags in [first, last) and change host protection once per run of pages with identical new protection
+	static bool _page_protect(u32 first, u32 last, u8 flags_set, u8 flags_clear)
+	{
+		const u8 flags_inv = flags_set & flags_clear;
+
+		u32 run_start = 0;
+		u32 run_count = 0; // Pages up to the last changed one
+		u32 run_skip = 0; // Unchanged pages with the same protection following the run
+		u8 run_flags = 0;
+
+		for (u32 i = first; i < last; i++)
+		{
+			const u8 f1 = _page_host_flags(i, g_pages[i].fetch_or(flags_set & ~flags_inv));
+			g_pages[i].fetch_and(~(flags_clear & ~flags_inv));
+			const u8 f2 = _page_host_flags(i, g_pages[i] ^= flags_inv);
+
+			const bool adjacent = run_count && run_start + run_count + run_skip == i && run_flags == f2;
+
+			if (f1 == f2)
+			{
+				// Unchanged page may be covered by the run if it gets extended later
+				if (adjacent) run_skip++;
+				continue;
+			}
+
+			if (adjacent)
+			{
+				run_count += run_skip + 1;
+				run_skip = 0;
+				continue;
+			}
+
+			if (run_count && !_page_set_protection(run_start, run_count, run_flags))
+			{
+				return false;
+			}
+
+			run_start = i;
+			run_count = 1;
+			run_skip = 0;
+			run_flags = f2;
+		}
+
+		return (!run_count || _page_set_protection(run_start, run_count, run_flags)) && _page_sync_faults(first, last);
+	}
+
 	bool page_protect(u32 addr, u32 size, u8 flags_test, u8 flags_set, u8 flags_clear)
 	{
-		std::lock_guard<reservation_mutex_t> lock(g_reservation_mutex);
+		std::lock_guard<memory_mutex_t> lock(g_mutex);
 
 		if (!size || (size | addr) % 4096)
 		{
 			fmt::throw_exception("Invalid arguments (addr=0x%x, size=0x%x)" HERE, addr, size);
 		}
 
-		const u8 flags_inv = flags_set & flags_clear;
-
 		flags_test |= page_allocated;
 
 		for (u32 i = addr / 4096; i < addr / 4096 + size / 4096; i++)
@@ -387,41 +536,254 @@ namespace vm
 			}
 		}
 
-		if (!flags_inv && !flags_set && !flags_clear)
+		if (!flags_set && !flags_clear)
 		{
 			return true;
 		}
 
-		for (u32 i = addr / 4096; i < addr / 4096 + size / 4096; i++)
+		if (!_page_protect(addr / 4096, addr / 4096 + size / 4096, flags_set, flags_clear))
 		{
-			_reservation_break(i * 4096);
+			fmt::throw_exception("System failure (addr=0x%x, size=0x%x, flags_test=0x%x, flags_set=0x%x, flags_clear=0x%x)" HERE, addr, size, flags_test, flags_set, flags_clear);
+		}
 
-			const u8 f1 = g_pages[i].fetch_or(flags_set & ~flags_inv) & (page_writable | page_readable);
-			g_pages[i].fetch_and(~(flags_clear & ~flags_inv));
-			const u8 f2 = (g_pages[i] ^= flags_inv) & (page_writable | page_readable);
+		return true;
+	}
 
-			if (f1 != f2)
-			{
-				void* real_addr = vm::base(i * 4096);
+	bool page_protect(std::vector<std::pair<u32, u32>> ranges, u8 flags_test, u8 flags_set, u8 flags_clear)
+	{
+		std::lock_guard<memory_mutex_t> lock(g_mutex);
 
-#ifdef _WIN32
-				DWORD old;
+		flags_test |= page_allocated;
 
-				auto protection = f2 & page_writable ? PAGE_READWRITE : (f2 & page_readable ? PAGE_READONLY : PAGE_NOACCESS);
-				if (!::VirtualProtect(real_addr, 4096, protection, &old))
-#else
-				auto protection = f2 & page_writable ? PROT_WRITE | PROT_READ : (f2 & page_readable ? PROT_READ : PROT_NONE);
-				if (::mprotect(real_addr, 4096, protection))
-#endif
+		for (const auto& range : ranges)
+		{
+			if (!range.second || (range.first | range.second) % 4096)
+			{
+				fmt::throw_exception("Invalid arguments (addr=0x%x, size=0x%x)" HERE, range.first, range.second);
+			}
+
+			for (u32 i = range.first / 4096; i < range.first / 4096 + range.second / 4096; i++)
+			{
+				if ((g_pages[i] & flags_test) != (flags_test | page_allocated))
 				{
-					fmt::throw_exception("System failure (addr=0x%x, size=0x%x, flags_test=0x%x, flags_set=0x%x, flags_clear=0x%x)" HERE, addr, size, flags_test, flags_set, flags_clear);
+					return false;
 				}
 			}
 		}
 
+		if (!flags_set && !flags_clear)
+		{
+			return true;
+		}
+
+		// Sort and merge ranges (as page numbers) so that adjacent ranges share host calls
+		std::sort(ranges.begin(), ranges.end());
+
+		u32 first = 0;
+		u32 last = 0;
+
+		for (const auto& range : ranges)
+		{
+			const u32 page = range.first / 4096;
+			const u32 end = page + range.second / 4096;
+
+			if (first != last && page <= last)
+			{
+				last = std::max(last, end);
+				continue;
+			}
+
+			if (first != last && !_page_protect(first, last, flags_set, flags_clear))
+			{
+				fmt::throw_exception("System failure (addr=0x%x, size=0x%x, flags_test=0x%x, flags_set=0x%x, flags_clear=0x%x)" HERE, first * 4096, (last - first) * 4096, flags_test, flags_set, flags_clear);
+			}
+
+			first = page;
+			last = end;
+		}
+
+		if (first != last && !_page_protect(first, last, flags_set, flags_clear))
+		{
+			fmt::throw_exception("System failure (addr=0x%x, size=0x%x, flags_test=0x%x, flags_set=0x%x, flags_clear=0x%x)" HERE, first * 4096, (last - first) * 4096, flags_test, flags_set, flags_clear);
+		}
+
+		return true;
+	}
+
+	// Write generation counter (incremented on every recorded write)
+	atomic_t<u64> g_write_gen{0};
+
+	// Last write generation of every page, and of every 1 MiB chunk (for fast range checks)
+	std::array<atomic_t<u64>, 0x100000> g_page_gen{};
+	std::array<atomic_t<u64>, 0x1000> g_chunk_gen{};
+
+	// Count of access violation handlers changing host protection without g_mutex
+	atomic_t<u32> g_watch_faults{0};
+
+	// Record a write to the page (lock-free)
+	static void _page_record_write(u32 page)
+	{
+		const u64 gen = ++g_write_gen;
+		g_page_gen[page] = gen;
+		g_chunk_gen[page / 256] = gen;
+	}
+
+	// Wait for access violation handlers and set host protection of [first, last) again (must be called under g_mutex after changing it).
+	// A handler may have applied protection computed from flags that were changed in the meantime.
+	static bool _page_sync_faults(u32 first, u32 last)
+	{
+		if (LIKELY(!g_watch_faults))
+		{
+			return true;
+		}
+
+		while (g_watch_faults)
+		{
+			_mm_pause();
+		}
+
+		for (u32 i = first; i < last; i++)
+		{
+			if (!_page_set_protection(i, 1, _page_host_flags(i, g_pages[i])))
+			{
+				return false;
+			}
+		}
+
 		return true;
 	}
 
+	u64 page_watch(u32 addr, u32 size)
+	{
+		std::lock_guard<memory_mutex_t> lock(g_mutex);
+
+		if (size)
+		{
+			const u32 end = static_cast<u32>((u64{addr} + size + 4095) / 4096);
+
+			for (u32 i = addr / 4096, first = i; i <= end; i++)
+			{
+				// Arm allocated pages in runs
+				if (i < end && g_pages[i] & page_allocated)
+				{
+					continue;
+				}
+
+				if (first < i && !_page_protect(first, i, page_watched, 0))
+				{
+					fmt::throw_exception("System failure (addr=0x%x, size=0x%x)" HERE, first * 4096, (i - first) * 4096);
+				}
+
+				first = i + 1;
+			}
+		}
+
+		return g_write_gen;
+	}
+
+	bool page_written_since(u32 addr, u32 size, u64 gen)
+	{
+		if (!size)
+		{
+			return false;
+		}
+
+		const u32 first = addr / 4096;
+		const u32 last = static_cast<u32>((u64{addr} + size - 1) / 4096);
+
+		for (u32 chunk = first / 256; chunk <= last / 256; chunk++)
+		{
+			if (g_chunk_gen[chunk] <= gen)
+			{
+				continue;
+			}
+
+			for (u32 i = std::max(first, chunk * 256); i <= std::min(last, chunk * 256 + 255); i++)
+			{
+				if (g_page_gen[i] > gen)
+				{
+					return true;
+				}
+			}
+		}
+
+		return false;
+	}
+
+	void page_notify_write(u32 addr, u32 size)
+	{
+		if (!size)
+		{
+			return;
+		}
+
+		const u32 first = addr / 4096;
+		const u32 last = static_cast<u32>((u64{addr} + size - 1) / 4096);
+
+		for (u32 i = first; i <= last; i++)
+		{
+			if (g_pages[i] & page_watched)
+			{
+				std::lock_guard<memory_mutex_t> lock(g_mutex);
+
+				if (g_pages[i] & page_watched)
+				{
+					_page_record_write(i);
+
+					if (!_page_protect(i, i + 1, 0, page_watched))
+					{
+						fmt::throw_exception("System failure (addr=0x%x)" HERE, i * 4096);
+					}
+				}
+			}
+		}
+	}
+
+	bool page_watch_fault(u32 addr)
+	{
+		// Called from the access violation handler: g_mutex may be owned by the faulting thread, so only atomic operations are used
+		const u32 page = addr / 4096;
+
+		if (!(g_pages[page] & page_allocated))
+		{
+			return false;
+		}
+
+		// Disarm the write watch, the generation is recorded before the write is retried
+		if (g_pages[page].fetch_and(~page_watched) & page_watched)
+		{
+			_page_record_write(page);
+		}
+
+		if (!(_page_host_flags(page, g_pages[page]) & page_writable))
+		{
+			// Still protected by page_protect or by a reservation update
+			return false;
+		}
+
+		// Unprotect the page (it may also be left protected from a stale flag snapshot of a concurrent _page_protect)
+		g_watch_faults++;
+
+		u8 flags = _page_host_flags(page, g_pages[page]);
+
+		while (_page_set_protection(page, 1, flags))
+		{
+			// Repeat if the flags were changed concurrently, g_mutex owners wait for g_watch_faults and restore protection anyway
+			const u8 _new = _page_host_flags(page, g_pages[page]);
+
+			if (_new == flags)
+			{
+				g_watch_faults--;
+				return (flags & page_writable) != 0;
+			}
+
+			flags = _new;
+		}
+
+		g_watch_faults--;
+		return false;
+	}
+
 	void _page_unmap(u32 addr, u32 size)
 	{
 		if (!size || (size | addr) % 4096)
@@ -437,9 +799,16 @@ namespace vm
 			}
 		}
 
+		// Break reservations on unmapped memory
+		_reservation_break(addr, size);
+
+		// Unmapped contents are lost: report the pages as written
+		const u64 gen = ++g_write_gen;
+
 		for (u32 i = addr / 4096; i < addr / 4096 + size / 4096; i++)
 		{
-			_reservation_break(i * 4096);
+			g_page_gen[i] = gen;
+			g_chunk_gen[i / 256] = gen;
 
 			if (!(g_pages[i].exchange(0) & page_allocated))
 			{
@@ -460,18 +829,25 @@ namespace vm
 		{
 			fmt::throw_exception("System failure (addr=0x%x, size=0x%x)" HERE, addr, size);
 		}
+
+		if (!_page_sync_faults(addr / 4096, addr / 4096 + size / 4096))
+		{
+			fmt::throw_exception("System failure (addr=0x%x, size=0x%x)" HERE, addr, size);
+		}
 	}
 
-	bool check_addr(u32 addr, u32 size)
+	bool check_addr(u32 addr, u32 size, u8 flags)
 	{
 		if (addr + (size - 1) < addr)
 		{
 			return false;
 		}
 
+		flags |= page_allocated;
+
 		for (u32 i = addr / 4096; i <= (addr + size - 1) / 4096; i++)
 		{
-			if ((g_pages[i] & page_allocated) == 0)
+			if ((g_pages[i] & flags) != flags)
 			{
 				return false;
 			}
@@ -535,7 +911,25 @@ namespace vm
 
 	bool block_t::try_alloc(u32 addr, u32 size, u32 sup)
 	{
-		// Check if memory area is already mapped
+		// Find free extent containing the area
+		auto found = m_free.upper_bound(addr);
+
+		if (found == m_free.begin())
+		{
+			return false;
+		}
+
+		found--;
+
+		const u32 ext_addr = found->first;
+		const u64 ext_end = u64{ext_addr} + found->second;
+
+		if (u64{addr} + size > ext_end)
+		{
+			return false;
+		}
+
+		// Check if memory area is already mapped (possible for overlapping blocks)
 		for (u32 i = addr / 4096; i <= (addr + size - 1) / 4096; i++)
 		{
 			if (g_pages[i])
@@ -547,8 +941,25 @@ namespace vm
 		// Map "real" memory pages
 		_page_map(addr, size, page_readable | page_writable);
 
+		// Split free extent
+		m_free_size.erase(std::make_pair(found->second, ext_addr));
+		m_free.erase(found);
+
+		if (addr > ext_addr)
+		{
+			m_free.emplace(ext_addr, addr - ext_addr);
+			m_free_size.emplace(addr - ext_addr, ext_addr);
+		}
+
+		if (u64{addr} + size < ext_end)
+		{
+			m_free.emplace(addr + size, static_cast<u32>(ext_end - addr - size));
+			m_free_size.emplace(static_cast<u32>(ext_end - addr - size), addr + size);
+		}
+
 		// Add entry
 		m_map[addr] = size;
+		m_used += size;
 
 		// Add supplementary info if necessary
 		if (sup) m_sup[addr] = sup;
@@ -556,16 +967,50 @@ namespace vm
 		return true;
 	}
 
+	void block_t::free_insert(u32 addr, u32 size)
+	{
+		auto next = m_free.lower_bound(addr);
+
+		// Merge with the following extent
+		if (next != m_free.end() && u64{addr} + size == next->first)
+		{
+			size += next->second;
+			m_free_size.erase(std::make_pair(next->second, next->first));
+			next = m_free.erase(next);
+		}
+
+		// Merge with the preceding extent
+		if (next != m_free.begin())
+		{
+			const auto prev = std::prev(next);
+
+			if (u64{prev->first} + prev->second == addr)
+			{
+				addr = prev->first;
+				size += prev->second;
+				m_free_size.erase(std::make_pair(prev->second, prev->first));
+				m_free.erase(prev);
+			}
+		}
+
+		m_free.emplace(addr, size);
+		m_free_size.emplace(size, addr);
+	}
+
 	block_t::block_t(u32 addr, u32 size, u64 flags)
 		: addr(addr)
 		, size(size)
 		, flags(flags)
 	{
+		if (size)
+		{
+			free_insert(addr, size);
+		}
 	}
 
 	block_t::~block_t()
 	{
-		std::lock_guard<reservation_mutex_t> lock(g_reservation_mutex);
+		std::lock_guard<memory_mutex_t> lock(g_mutex);
 
 		// Deallocate all memory
 		for (auto& entry : m_map)
@@ -576,7 +1021,7 @@ namespace vm
 
 	u32 block_t::alloc(u32 size, u32 align, u32 sup)
 	{
-		std::lock_guard<reservation_mutex_t> lock(g_reservation_mutex);
+		std::lock_guard<memory_mutex_t> lock(g_mutex);
 
 		// Align to minimal page size
 		size = ::align(size, 4096);
@@ -593,12 +1038,20 @@ namespace vm
 			return 0;
 		}
 
-		// Search for an appropriate place (unoptimized)
-		for (u32 addr = ::align(this->addr, align); addr < this->addr + this->size - 1; addr += align)
+		// Best fit: smallest free extents first, lowest address among equal sizes
+		for (auto it = m_free_size.lower_bound(std::make_pair(size, 0u)); it != m_free_size.end(); it++)
 		{
-			if (try_alloc(addr, size, sup))
+			const u64 addr = ::align<u64>(it->second, align);
+
+			if (addr + size > u64{it->second} + it->first)
+			{
+				continue;
+			}
+
+			// Iterator is invalidated by successful allocation
+			if (try_alloc(static_cast<u32>(addr), size, sup))
 			{
-				return addr;
+				return static_cast<u32>(addr);
 			}
 		}
 
@@ -607,7 +1060,7 @@ namespace vm
 
 	u32 block_t::falloc(u32 addr, u32 size, u32 sup)
 	{
-		std::lock_guard<reservation_mutex_t> lock(g_reservation_mutex);
+		std::lock_guard<memory_mutex_t> lock(g_mutex);
 
 		// align to minimal page size
 		size = ::align(size, 4096);
@@ -628,7 +1081,7 @@ namespace vm
 
 	u32 block_t::dealloc(u32 addr, u32* sup_out)
 	{
-		std::lock_guard<reservation_mutex_t> lock(g_reservation_mutex);
+		std::lock_guard<memory_mutex_t> lock(g_mutex);
 
 		const auto found = m_map.find(addr);
 
@@ -638,10 +1091,14 @@ namespace vm
 
 			// Remove entry
 			m_map.erase(found);
+			m_used -= size;
 
 			// Unmap "real" memory pages
 			_page_unmap(addr, size);
 
+			// Return the area to the free list
+			free_insert(addr, size);
+
 			// Write supplementary info if necessary
 			if (sup_out) *sup_out = m_sup[addr];
 
@@ -656,21 +1113,27 @@ namespace vm
 
 	u32 block_t::used()
 	{
-		std::lock_guard<reservation_mutex_t> lock(g_reservation_mutex);
-
-		u32 result = 0;
+		std::lock_guard<memory_mutex_t> lock(g_mutex);
 
-		for (auto& entry : m_map)
-		{
-			result += entry.second;
-		}
+		return m_used;
+	}
 
+	block_stats block_t::stats()
+	{
+		std::lock_guard<memory_mutex_t> lock(g_mutex);
+
+		block_stats result;
+		result.used = m_used;
+		result.free = this->size - m_used;
+		result.allocs = ::size32(m_map);
+		result.free_extents = ::size32(m_free);
+		result.largest_free = m_free_size.empty() ? 0 : m_free_size.rbegin()->first;
 		return result;
 	}
 
 	std::shared_ptr<block_t> map(u32 addr, u32 size, u64 flags)
 	{
-		std::lock_guard<reservation_mutex_t> lock(g_reservation_mutex);
+		std::lock_guard<memory_mutex_t> lock(g_mutex);
 
 		if (!size || (size | addr) % 4096)
 		{
@@ -707,7 +1170,7 @@ namespace vm
 
 	std::shared_ptr<block_t> unmap(u32 addr, bool must_be_empty)
 	{
-		std::lock_guard<reservation_mutex_t> lock(g_reservation_mutex);
+		std::lock_guard<memory_mutex_t> lock(g_mutex);
 
 		for (auto it = g_locations.begin(); it != g_locations.end(); it++)
 		{
@@ -729,7 +1192,7 @@ namespace vm
 
 	std::shared_ptr<block_t> get(memory_location_t location, u32 addr)
 	{
-		std::lock_guard<reservation_mutex_t> lock(g_reservation_mutex);
+		std::lock_guard<memory_mutex_t> lock(g_mutex);
 
 		if (location != any)
 		{
@@ -754,8 +1217,6 @@ namespace vm
 		return nullptr;
 	}
 
-	extern void start();
-
 	namespace ps3
 	{
 		void init()
@@ -768,8 +1229,6 @@ namespace vm
 				std::make_shared<block_t>(0xD0000000, 0x10000000), // stack
 				std::make_shared<block_t>(0xE0000000, 0x20000000), // SPU reserved
 			};
-
-			vm::start();
 		}
 	}
 
@@ -784,8 +1243,6 @@ namespace vm
 				std::make_shared<block_t>(0xC0000000, 0x10000000), // video (arbitrarily)
 				std::make_shared<block_t>(0xD0000000, 0x10000000), // stack (arbitrarily)
 			};
-
-			vm::start();
 		}
 	}
 
@@ -803,8 +1260,6 @@ namespace vm
 				std::make_shared<block_t>(0x00010000, 0x00004000), // scratchpad
 				std::make_shared<block_t>(0x88000000, 0x00800000), // kernel
 			};
-
-			vm::start();
 		}
 	}
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <map>
+#include <set>
 #include <functional>
 #include <memory>
 
@@ -30,6 +31,7 @@ namespace vm
 
 		page_fault_notification = (1 << 3),
 		page_no_reservations    = (1 << 4),
+		page_watched            = (1 << 5), // Write watch armed (host protection is read-only)
 
 		page_allocated          = (1 << 7),
 	};
@@ -44,41 +46,54 @@ namespace vm
 
 	[[noreturn]] void throw_access_violation(u64 addr, const char* cause);
 
+	// Reservations are tracked per 128-byte line with versioned stamps, reserved size must not exceed 128.
+	// Updates compare and write the data with 16-byte atomic instructions, so normal stores are never blocked.
 	// This flag is changed by various reservation functions and may have different meaning.
-	// reservation_break() - true if the reservation was successfully broken.
-	// reservation_acquire() - true if another existing reservation was broken.
+	// reservation_break() - always true.
+	// reservation_acquire() - true if the previous reservation of the current thread was replaced.
 	// reservation_free() - true if this thread's reservation was successfully removed.
 	// reservation_op() - false if reservation_update() would succeed if called instead.
-	// Write access to reserved memory - only set to true if the reservation was broken.
 	extern thread_local bool g_tls_did_break_reservation;
 
 	// Unconditionally break the reservation at specified address
 	void reservation_break(u32 addr);
 
-	// Reserve memory at the specified address for further atomic update
+	// Reserve memory at the specified address for further atomic update (size must not exceed 128)
 	void reservation_acquire(void* data, u32 addr, u32 size);
 
 	// Attempt to atomically update previously reserved memory
 	bool reservation_update(u32 addr, const void* data, u32 size);
 
-	// Process a memory access error if it's caused by the reservation
-	bool reservation_query(u32 addr, u32 size, bool is_writing, std::function<bool()> callback);
-
-	// Returns true if the current thread owns reservation
-	bool reservation_test(thread_ctrl* current);
+	// Returns true if the current thread's reservation is still valid
+	bool reservation_test();
 
 	// Break all reservations created by the current thread
 	void reservation_free();
 
-	// Perform atomic operation unconditionally
+	// Perform atomic operation unconditionally (proc writes in place and must tolerate concurrent normal stores)
 	void reservation_op(u32 addr, u32 size, std::function<void()> proc);
 
 	// Change memory protection of specified memory region
 	bool page_protect(u32 addr, u32 size, u8 flags_test = 0, u8 flags_set = 0, u8 flags_clear = 0);
 
-	// Check if existing memory range is allocated. Checking address before using it is very unsafe.
-	// Return value may be wrong. Even if it's true and correct, actual memory protection may be read-only and no-access.
-	bool check_addr(u32 addr, u32 size = 1);
+	// Change memory protection of several memory regions at once (all or none), overlapping ranges are processed once
+	bool page_protect(std::vector<std::pair<u32, u32>> ranges, u8 flags_test = 0, u8 flags_set = 0, u8 flags_clear = 0);
+
+	// Arm write watch on allocated pages of the range and return the current write generation
+	u64 page_watch(u32 addr, u32 size);
+
+	// Check if any page of the range was written after the generation returned by page_watch()
+	bool page_written_since(u32 addr, u32 size, u64 gen);
+
+	// Record a write performed through the privileged mapping (it bypasses the write watch)
+	void page_notify_write(u32 addr, u32 size);
+
+	// Process a write fault on a watched page (returns true if the access can be retried), lock-free for the access violation handler
+	bool page_watch_fault(u32 addr);
+
+	// Check if existing memory range is allocated and has all specified page flags. Checking address before using it is very unsafe.
+	// Return value may be wrong. Even if it's true and correct, actual memory protection may change at any moment.
+	bool check_addr(u32 addr, u32 size = 1, u8 flags = page_allocated);
 
 	// Search and map memory in specified memory location (don't pass alignment smaller than 4096)
 	u32 alloc(u32 size, memory_location_t location, u32 align = 4096, u32 sup = 0);
@@ -92,14 +107,31 @@ namespace vm
 	// dealloc() with no return value and no exceptions
 	void dealloc_verbose_nothrow(u32 addr, memory_location_t location = any) noexcept;
 
+	// Memory block statistics
+	struct block_stats
+	{
+		u32 used; // Allocated memory size
+		u32 free; // Free memory size
+		u32 allocs; // Allocation count
+		u32 free_extents; // Free extent count
+		u32 largest_free; // Largest free extent size
+	};
+
 	// Object that handles memory allocations inside specific constant bounds ("location")
 	class block_t final
 	{
 		std::map<u32, u32> m_map; // Mapped memory: addr -> size
 		std::unordered_map<u32, u32> m_sup; // Supplementary info for allocations
 
+		std::map<u32, u32> m_free; // Free extents: addr -> size
+		std::set<std::pair<u32, u32>> m_free_size; // Free extents: (size, addr)
+		u32 m_used = 0; // Allocated memory size
+
 		bool try_alloc(u32 addr, u32 size, u32 sup);
 
+		// Register free extent, merging with neighbours
+		void free_insert(u32 addr, u32 size);
+
 	public:
 		block_t(u32 addr, u32 size, u64 flags = 0);
 
@@ -121,6 +153,9 @@ namespace vm
 
 		// Get allocated memory count
 		u32 used();
+
+		// Get allocation and fragmentation statistics
+		block_stats stats();
 	};
 
 	// Create new memory block with specified parameters and return it
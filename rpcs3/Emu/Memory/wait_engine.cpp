@@ -6,15 +6,28 @@
 #include "Utilities/Thread.h"
 #include "Utilities/mutex.h"
 
-#include <unordered_set>
-
 namespace vm
 {
-	static shared_mutex s_mutex;
+	// List of waiters
+	struct waiter_slot
+	{
+		shared_mutex mutex;
+		waiter_base* first = nullptr;
+		atomic_t<u32> count{0};
+	};
+
+	// Waiters for areas not bigger than 128 bytes (hashed by 128-byte line address)
+	static std::array<waiter_slot, 4096> s_slots;
 
-	static std::unordered_set<waiter_base*, pointer_hash<waiter_base>> s_waiters(256);
+	// Waiters for bigger areas
+	static waiter_slot s_large;
+
+	static inline waiter_slot& get_slot(u32 addr, u32 size)
+	{
+		return size > 128 ? s_large : s_slots[(addr >> 7) % s_slots.size()];
+	}
 
-	void waiter_base::initialize(u32 addr, u32 size)
+	void waiter_base::initialize(u32 addr, u32 size, u64 poll)
 	{
 		verify(HERE), addr, (size & (~size + 1)) == size, (addr & (size - 1)) == 0;
 
@@ -25,15 +38,25 @@ namespace vm
 		struct waiter final
 		{
 			waiter_base* m_ptr;
-			thread_ctrl* m_thread;
+			waiter_slot& m_slot;
 
-			waiter(waiter_base* ptr)
+			waiter(waiter_base* ptr, waiter_slot& slot)
 				: m_ptr(ptr)
-				, m_thread(ptr->thread)
+				, m_slot(slot)
 			{
 				// Initialize waiter
-				writer_lock lock(s_mutex);
-				s_waiters.emplace(m_ptr);
+				writer_lock lock(m_slot.mutex);
+
+				m_ptr->prev = nullptr;
+				m_ptr->next = m_slot.first;
+
+				if (m_slot.first)
+				{
+					m_slot.first->prev = m_ptr;
+				}
+
+				m_slot.first = m_ptr;
+				m_slot.count++;
 			}
 
 			~waiter()
@@ -42,13 +65,33 @@ namespace vm
 				m_ptr->thread = nullptr;
 
 				// Remove waiter
-				writer_lock lock(s_mutex);
-				s_waiters.erase(m_ptr);
+				writer_lock lock(m_slot.mutex);
+
+				if (m_ptr->prev)
+				{
+					m_ptr->prev->next = m_ptr->next;
+				}
+				else
+				{
+					m_slot.first = m_ptr->next;
+				}
+
+				if (m_ptr->next)
+				{
+					m_ptr->next->prev = m_ptr->prev;
+				}
+
+				m_slot.count--;
 			}
 		};
 
-		// Wait until thread == nullptr
-		waiter{this}, thread_ctrl::wait([&] { return !thread || test(); });
+		const waiter _w{this, get_slot(addr, size)};
+
+		// Wait until thread == nullptr, retest predicate periodically
+		while (thread && !test())
+		{
+			thread_ctrl::wait_for(poll);
+		}
 	}
 
 	bool waiter_base::try_notify()
@@ -78,11 +121,16 @@ namespace vm
 		return true;
 	}
 
-	void notify_at(u32 addr, u32 size)
+	static void notify_slot(waiter_slot& slot, u32 addr, u32 size)
 	{
-		reader_lock lock(s_mutex);
+		if (!slot.count)
+		{
+			return;
+		}
 
-		for (const auto _w : s_waiters)
+		reader_lock lock(slot.mutex);
+
+		for (auto _w = slot.first; _w; _w = _w->next)
 		{
 			// Check address range overlapping using masks generated from size (power of 2)
 			if (((_w->addr ^ addr) & (_w->mask & ~(size - 1))) == 0)
@@ -92,38 +140,14 @@ namespace vm
 		}
 	}
 
-	// Return amount of threads which are not notified
-	static std::size_t notify_all()
+	void notify_at(u32 addr, u32 size)
 	{
-		reader_lock lock(s_mutex);
-
-		std::size_t signaled = 0;
-
-		for (const auto _w : s_waiters)
+		// Notify every slot the area may belong to
+		for (u32 i = 0, max = std::min<u32>(std::max<u32>(size >> 7, 1), ::size32(s_slots)); i < max; i++)
 		{
-			if (_w->try_notify())
-			{
-				signaled++;
-			}
+			notify_slot(s_slots[((addr >> 7) + i) % s_slots.size()], addr, size);
 		}
 
-		return s_waiters.size() - signaled;
-	}
-
-	void start()
-	{
-		thread_ctrl::spawn("vm::wait", []()
-		{
-			while (!Emu.IsStopped())
-			{
-				// Poll waiters periodically (TODO)
-				while (notify_all() && !Emu.IsPaused() && !Emu.IsStopped())
-				{
-					thread_ctrl::wait_for(50);
-				}
-
-				thread_ctrl::wait_for(1000);
-			}
-		});
+		notify_slot(s_large, addr, size);
 	}
 }
@@ -13,7 +13,11 @@ namespace vm
 		u32 mask;
 		atomic_t<thread_ctrl*> thread{};
 
-		void initialize(u32 addr, u32 size);
+		// Intrusive list of waiters in the same slot
+		waiter_base* prev;
+		waiter_base* next;
+
+		void initialize(u32 addr, u32 size, u64 poll);
 		bool try_notify();
 
 	protected:
@@ -22,8 +26,9 @@ namespace vm
 
 	// Wait until pred() returns true, addr must be aligned to size which must be a power of 2.
 	// It's possible for pred() to be called from any thread once the waiter is registered.
+	// pred() is also retested every `poll` microseconds for conditions which can change without notification.
 	template<typename F>
-	auto wait_op(u32 addr, u32 size, F&& pred) -> decltype(static_cast<void>(pred()))
+	auto wait_op(u32 addr, u32 size, F&& pred, u64 poll = 1000) -> decltype(static_cast<void>(pred()))
 	{
 		if (LIKELY(pred())) return;
 
@@ -42,7 +47,7 @@ namespace vm
 			}
 		};
 
-		waiter(std::forward<F>(pred)).initialize(addr, size);
+		waiter(std::forward<F>(pred)).initialize(addr, size, poll);
 	}
 
 	// Notify waiters on specific addr, addr must be aligned to size which must be a power of 2
@@ -57,38 +57,114 @@ void ARMv7Thread::cpu_task_main()
 		return fmt::format("%s [0x%08x]", cpu->get_name(), cpu->PC);
 	};
 
+	// Decoded page of the current PC, revalidated after branches and on page switch
+	arm_decoded_page* page = nullptr;
+	u32 page_addr = -1;
+
 	while (!test(state) || !check_state())
 	{
+		const u32 pc = PC;
+
+		if ((pc & ~0xfff) != page_addr)
+		{
+			page_addr = pc & ~0xfff;
+			page = get_decoded_page(page_addr);
+		}
+
+		const auto info = page ? &page->ops[pc % 4096 / 2] : nullptr;
+
+		u32 size;
+
 		if (ISET == Thumb)
 		{
-			const u16 op16 = vm::read16(PC);
 			const u32 cond = ITSTATE.advance();
 
-			if (const auto func16 = s_arm_interpreter.decode_thumb(op16))
+			if (info && info->func && info->iset == Thumb)
 			{
-				func16(*this, op16, cond);
-				PC += 2;
+				size = info->size;
+				info->func(*this, info->op, cond);
 			}
 			else
 			{
-				const u32 op32 = (op16 << 16) | vm::read16(PC + 2);
-
-				s_arm_interpreter.decode_thumb(op32)(*this, op32, cond);
-				PC += 4;
+				const u16 op16 = vm::read16(pc);
+
+				if (const auto func16 = s_arm_interpreter.decode_thumb(op16))
+				{
+					if (info) *info = { func16, op16, 2, Thumb };
+
+					size = 2;
+					func16(*this, op16, cond);
+				}
+				else
+				{
+					const u32 op32 = (op16 << 16) | vm::read16(pc + 2);
+					const auto func32 = s_arm_interpreter.decode_thumb(op32);
+
+					// Don't cache instructions crossing the page boundary
+					if (info && pc % 4096 != 4094) *info = { func32, op32, 4, Thumb };
+
+					size = 4;
+					func32(*this, op32, cond);
+				}
 			}
 		}
 		else if (ISET == ARM)
 		{
-			const u32 op = vm::read32(PC);
+			if (info && info->func && info->iset == ARM)
+			{
+				size = 4;
+				info->func(*this, info->op, info->op >> 28);
+			}
+			else
+			{
+				const u32 op = vm::read32(pc);
+				const auto func = s_arm_interpreter.decode_arm(op);
 
-			s_arm_interpreter.decode_arm(op)(*this, op, op >> 28);
-			PC += 4;
+				if (info) *info = { func, op, 4, ARM };
+
+				size = 4;
+				func(*this, op, op >> 28);
+			}
 		}
 		else
 		{
 			fmt::throw_exception("Invalid instruction set" HERE);
 		}
+
+		PC += size;
+
+		if (PC != pc + size)
+		{
+			// Branch taken: revalidate the page before the next instruction
+			page_addr = -1;
+		}
+	}
+}
+
+arm_decoded_page* ARMv7Thread::get_decoded_page(u32 page_addr)
+{
+	auto& page = decoded_pages[page_addr];
+
+	if (!page)
+	{
+		page = std::make_unique<arm_decoded_page>();
+		page->write_gen = vm::page_watch(page_addr, 4096);
 	}
+	else if (page->invalidations < 16 && vm::page_written_since(page_addr, 4096, page->write_gen))
+	{
+		LOG_TRACE(ARMv7, "Code page modified (addr=0x%x)", page_addr);
+
+		page->invalidations++;
+		page->ops = {};
+		page->write_gen = vm::page_watch(page_addr, 4096);
+	}
+
+	if (page->invalidations >= 16)
+	{
+		return nullptr;
+	}
+
+	return page.get();
 }
 
 ARMv7Thread::~ARMv7Thread()
@@ -11,6 +11,24 @@ enum ARMv7InstructionSet
 	ThumbEE
 };
 
+class ARMv7Thread;
+
+// Decoded instructions of a 4 KiB code page
+struct arm_decoded_page
+{
+	struct op_info
+	{
+		void(*func)(ARMv7Thread&, const u32 op, const u32 cond); // Interpreter function (nullptr if not decoded yet)
+		u32 op; // Opcode (both halfwords for 32-bit Thumb instructions)
+		u8 size; // Instruction size
+		u8 iset; // Instruction set used for decoding
+	};
+
+	u64 write_gen; // Write generation of the page watch
+	u32 invalidations; // Frequently modified pages are not cached
+	std::array<op_info, 2048> ops; // Indexed by halfword
+};
+
 class ARMv7Thread final : public cpu_thread
 {
 public:
@@ -141,6 +159,12 @@ public:
 
 	const char* last_function = nullptr;
 
+	// Decoded instruction cache (page address -> decoded page)
+	std::unordered_map<u32, std::unique_ptr<arm_decoded_page>> decoded_pages;
+
+	// Get validated decoded page (nullptr if the page is not cached)
+	arm_decoded_page* get_decoded_page(u32 page_addr);
+
 	void write_pc(u32 value, u32 size)
 	{
 		ISET = value & 1 ? Thumb : ARM;
@@ -13,36 +13,204 @@ namespace
 	}
 }
 
+std::array<u16, 4> decode_cmp_vector(u32 encoded_vector)
+{
+	u16 Z = encoded_vector >> 22;
+	Z = Z << 6;
+	u16 Y = (encoded_vector >> 11) & 0x7FF;
+	Y = Y << 5;
+	u16 X = encoded_vector & 0x7FF;
+	X = X << 5;
+	return{ X, Y, Z, 1 };
+}
+
 namespace
 {
+	// Byteswap masks for pshufb
+	template <typename T>
+	__m128i get_swap_mask();
+
+	template <>
+	__m128i get_swap_mask<u8>()
+	{
+		return _mm_set_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+	}
+
+	template <>
+	__m128i get_swap_mask<u16>()
+	{
+		return _mm_set_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1);
+	}
+
+	template <>
+	__m128i get_swap_mask<u32>()
+	{
+		return _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+	}
+
+	template <typename T>
+	void swap_attribute(gsl::byte* dst, const gsl::byte* src, u32 size)
+	{
+		for (u32 i = 0; i < size; i += sizeof(T))
+		{
+			be_t<T> value;
+			std::memcpy(&value, src + i, sizeof(T));
+			const T result = value;
+			std::memcpy(dst + i, &result, sizeof(T));
+		}
+	}
+
+	template <>
+	void swap_attribute<u8>(gsl::byte* dst, const gsl::byte* src, u32 size)
+	{
+		std::memcpy(dst, src, size);
+	}
+
 	/**
-	 * Convert CMP vector to RGBA16.
-	 * A vector in CMP (compressed) format is stored as X11Y11Z10 and has a W component of 1.
-	 * X11 and Y11 channels are int between -1024 and 1023 interpreted as -1.f, 1.f
-	 * Z10 is int between -512 and 511 interpreted as -1.f, 1.f
+	 * Copy vertex_count attributes of N bytes made of big-endian T elements, converting them to the host byte order.
+	 * Only N bytes are written per vertex, the rest of dst_stride is preserved (it may be prefilled with default values).
 	 */
-	std::array<u16, 4> decode_cmp_vector(u32 encoded_vector)
+	template <typename T, u32 N>
+	void copy_whole_attribute_array(gsl::span<gsl::byte> dst_span, gsl::span<const gsl::byte> src_span, u32 src_stride, u32 dst_stride, u32 vertex_count)
+	{
+		verify(HERE), (vertex_count == 0 || u64{src_stride} * (vertex_count - 1) + N <= ::narrow<u64>(src_span.size_bytes())), (u64{dst_stride} * vertex_count <= ::narrow<u64>(dst_span.size_bytes()));
+
+		gsl::byte* dst = dst_span.data();
+		const gsl::byte* src = src_span.data();
+		const u32 src_size = ::narrow<u32>(src_span.size_bytes());
+
+		// Tightly packed array: convert the whole run at once
+		if (src_stride == N && dst_stride == N)
+		{
+			const u32 size = N * vertex_count;
+			u32 pos = 0;
+
+			if (sizeof(T) == 1)
+			{
+				std::memcpy(dst, src, size);
+				return;
+			}
+
+			const __m128i mask = get_swap_mask<T>();
+
+			for (; pos + 16 <= size; pos += 16)
+			{
+				const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + pos));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + pos), _mm_shuffle_epi8(data, mask));
+			}
+
+			swap_attribute<T>(dst + pos, src + pos, size - pos);
+			return;
+		}
+
+		// Restride: one unaligned load per vertex while 16 bytes are available in the source
+		const __m128i mask = get_swap_mask<T>();
+		u32 vertex = 0;
+
+		for (; vertex < vertex_count && u64{vertex} * src_stride + 16 <= src_size; vertex++)
+		{
+			const __m128i data = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + vertex * src_stride)), mask);
+			gsl::byte* ptr = dst + vertex * dst_stride;
+
+			if (N == 16)
+			{
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(ptr), data);
+			}
+			else if (N == 8)
+			{
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(ptr), data);
+			}
+			else
+			{
+				std::memcpy(ptr, &data, N);
+			}
+		}
+
+		for (; vertex < vertex_count; vertex++)
+		{
+			swap_attribute<T>(dst + vertex * dst_stride, src + vertex * src_stride, N);
+		}
+	}
+
+	template <typename T>
+	void copy_whole_attribute_array(gsl::span<gsl::byte> dst_span, gsl::span<const gsl::byte> src_span, u32 vector_element_count, u32 src_stride, u32 dst_stride, u32 vertex_count)
 	{
-		u16 Z = encoded_vector >> 22;
-		Z = Z << 6;
-		u16 Y = (encoded_vector >> 11) & 0x7FF;
-		Y = Y << 5;
-		u16 X = encoded_vector & 0x7FF;
-		X = X << 5;
-		return{ X, Y, Z, 1 };
+		switch (vector_element_count)
+		{
+		case 1: return copy_whole_attribute_array<T, sizeof(T) * 1>(dst_span, src_span, src_stride, dst_stride, vertex_count);
+		case 2: return copy_whole_attribute_array<T, sizeof(T) * 2>(dst_span, src_span, src_stride, dst_stride, vertex_count);
+		case 3: return copy_whole_attribute_array<T, sizeof(T) * 3>(dst_span, src_span, src_stride, dst_stride, vertex_count);
+		case 4: return copy_whole_attribute_array<T, sizeof(T) * 4>(dst_span, src_span, src_stride, dst_stride, vertex_count);
+		}
+
+		fmt::throw_exception("Unexpected vector element count (%u)" HERE, vector_element_count);
 	}
 
-	template <typename U, typename T>
-	void copy_whole_attribute_array(gsl::span<T> dst, gsl::span<const gsl::byte> src_ptr, u8 attribute_size, u8 dst_stride, u32 src_stride, u32 vertex_count)
+	/**
+	 * Convert CMP vectors to RGBA16, four at a time (see decode_cmp_vector).
+	 */
+	void decode_cmp_array(gsl::span<gsl::byte> dst_span, gsl::span<const gsl::byte> src_span, u32 src_stride, u32 dst_stride, u32 vertex_count)
 	{
-		for (u32 vertex = 0; vertex < vertex_count; ++vertex)
+		verify(HERE), (vertex_count == 0 || u64{src_stride} * (vertex_count - 1) + 4 <= ::narrow<u64>(src_span.size_bytes())), (u64{dst_stride} * vertex_count <= ::narrow<u64>(dst_span.size_bytes()));
+
+		gsl::byte* dst = dst_span.data();
+		const gsl::byte* src = src_span.data();
+
+		const __m128i mask = get_swap_mask<u32>();
+		const __m128i mask11 = _mm_set1_epi32(0x7ff);
+		const __m128i w = _mm_set1_epi32(1 << 16);
+
+		u32 vertex = 0;
+
+		for (; vertex + 4 <= vertex_count; vertex += 4)
 		{
-			gsl::span<const U> src = gsl::as_span<const U>(src_ptr.subspan(src_stride * vertex, attribute_size * sizeof(const U)));
-			for (u32 i = 0; i < attribute_size; ++i)
+			__m128i v;
+
+			if (src_stride == 4)
+			{
+				v = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + vertex * 4)), mask);
+			}
+			else
+			{
+				be_t<u32> data[4];
+				std::memcpy(data + 0, src + (vertex + 0) * src_stride, 4);
+				std::memcpy(data + 1, src + (vertex + 1) * src_stride, 4);
+				std::memcpy(data + 2, src + (vertex + 2) * src_stride, 4);
+				std::memcpy(data + 3, src + (vertex + 3) * src_stride, 4);
+				v = _mm_set_epi32(data[3], data[2], data[1], data[0]);
+			}
+
+			const __m128i x = _mm_slli_epi32(_mm_and_si128(v, mask11), 5);
+			const __m128i y = _mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(v, 11), mask11), 5);
+			const __m128i z = _mm_slli_epi32(_mm_srli_epi32(v, 22), 6);
+
+			// Interleave XY and ZW halves
+			const __m128i xy = _mm_or_si128(x, _mm_slli_epi32(y, 16));
+			const __m128i zw = _mm_or_si128(z, w);
+			const __m128i lo = _mm_unpacklo_epi32(xy, zw);
+			const __m128i hi = _mm_unpackhi_epi32(xy, zw);
+
+			if (dst_stride == 8)
+			{
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + vertex * 8), lo);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + vertex * 8 + 16), hi);
+			}
+			else
 			{
-				dst[vertex * dst_stride / sizeof(T) + i] = src[i];
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(dst + (vertex + 0) * dst_stride), lo);
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(dst + (vertex + 1) * dst_stride), _mm_srli_si128(lo, 8));
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(dst + (vertex + 2) * dst_stride), hi);
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(dst + (vertex + 3) * dst_stride), _mm_srli_si128(hi, 8));
 			}
 		}
+
+		for (; vertex < vertex_count; vertex++)
+		{
+			be_t<u32> src_value;
+			std::memcpy(&src_value, src + vertex * src_stride, sizeof(be_t<u32>));
+			const auto& decoded_vector = decode_cmp_vector(src_value);
+			std::memcpy(dst + vertex * dst_stride, decoded_vector.data(), sizeof(u16) * 4);
+		}
 	}
 }
 
@@ -55,39 +223,24 @@ void write_vertex_array_data_to_buffer(gsl::span<gsl::byte> raw_dst_span, gsl::s
 	case rsx::vertex_base_type::ub:
 	case rsx::vertex_base_type::ub256:
 	{
-		gsl::span<u8> dst_span = as_span_workaround<u8>(raw_dst_span);
-		copy_whole_attribute_array<u8>(dst_span, src_ptr, vector_element_count, dst_stride, attribute_src_stride, count);
+		copy_whole_attribute_array<u8>(raw_dst_span, src_ptr, vector_element_count, attribute_src_stride, dst_stride, count);
 		return;
 	}
 	case rsx::vertex_base_type::s1:
 	case rsx::vertex_base_type::sf:
 	case rsx::vertex_base_type::s32k:
 	{
-		gsl::span<u16> dst_span = as_span_workaround<u16>(raw_dst_span);
-		copy_whole_attribute_array<be_t<u16>>(dst_span, src_ptr, vector_element_count, dst_stride, attribute_src_stride, count);
+		copy_whole_attribute_array<u16>(raw_dst_span, src_ptr, vector_element_count, attribute_src_stride, dst_stride, count);
 		return;
 	}
 	case rsx::vertex_base_type::f:
 	{
-		gsl::span<u32> dst_span = as_span_workaround<u32>(raw_dst_span);
-		copy_whole_attribute_array<be_t<u32>>(dst_span, src_ptr, vector_element_count, dst_stride, attribute_src_stride, count);
+		copy_whole_attribute_array<u32>(raw_dst_span, src_ptr, vector_element_count, attribute_src_stride, dst_stride, count);
 		return;
 	}
 	case rsx::vertex_base_type::cmp:
 	{
-		gsl::span<u16> dst_span = as_span_workaround<u16>(raw_dst_span);
-		for (u32 i = 0; i < count; ++i)
-		{
-			be_t<u32> src_value;
-			memcpy(&src_value,
-			    src_ptr.subspan(attribute_src_stride * i).data(),
-			    sizeof(be_t<u32>));
-			const auto& decoded_vector                 = decode_cmp_vector(src_value);
-			dst_span[i * dst_stride / sizeof(u16)] = decoded_vector[0];
-			dst_span[i * dst_stride / sizeof(u16) + 1] = decoded_vector[1];
-			dst_span[i * dst_stride / sizeof(u16) + 2] = decoded_vector[2];
-			dst_span[i * dst_stride / sizeof(u16) + 3] = decoded_vector[3];
-		}
+		decode_cmp_array(raw_dst_span, src_ptr, attribute_src_stride, dst_stride, count);
 		return;
 	}
 	}
@@ -95,147 +248,267 @@ void write_vertex_array_data_to_buffer(gsl::span<gsl::byte> raw_dst_span, gsl::s
 
 namespace
 {
+// Unsigned index operations (SSE2 has no unsigned min/max, so the sign bit is flipped)
 template<typename T>
-std::tuple<T, T> upload_untouched(gsl::span<to_be_t<const T>> src, gsl::span<T> dst, bool is_primitive_restart_enabled, T primitive_restart_index)
+struct index_ops;
+
+template<>
+struct index_ops<u16>
 {
-	T min_index = -1;
-	T max_index = 0;
+	static __m128i splat(u16 value) { return _mm_set1_epi16(value); }
+	static __m128i eq(__m128i a, __m128i b) { return _mm_cmpeq_epi16(a, b); }
 
-	verify(HERE), (dst.size_bytes() >= src.size_bytes());
+	static __m128i min(__m128i a, __m128i b)
+	{
+		const __m128i bias = _mm_set1_epi16(-0x8000);
+		return _mm_xor_si128(_mm_min_epi16(_mm_xor_si128(a, bias), _mm_xor_si128(b, bias)), bias);
+	}
 
-	size_t dst_idx = 0;
-	for (T index : src)
+	static __m128i max(__m128i a, __m128i b)
 	{
-		if (is_primitive_restart_enabled && index == primitive_restart_index)
-		{
-			index = -1;
-		}
-		else
-		{
-			max_index = std::max(max_index, index);
-			min_index = std::min(min_index, index);
-		}
-		dst[dst_idx++] = index;
+		const __m128i bias = _mm_set1_epi16(-0x8000);
+		return _mm_xor_si128(_mm_max_epi16(_mm_xor_si128(a, bias), _mm_xor_si128(b, bias)), bias);
 	}
-	return std::make_tuple(min_index, max_index);
-}
+};
 
-// FIXME: expanded primitive type may not support primitive restart correctly
+template<>
+struct index_ops<u32>
+{
+	static __m128i splat(u32 value) { return _mm_set1_epi32(value); }
+	static __m128i eq(__m128i a, __m128i b) { return _mm_cmpeq_epi32(a, b); }
+
+	static __m128i min(__m128i a, __m128i b)
+	{
+		const __m128i bias = _mm_set1_epi32(0x80000000);
+		const __m128i gt = _mm_cmpgt_epi32(_mm_xor_si128(a, bias), _mm_xor_si128(b, bias));
+		return _mm_or_si128(_mm_and_si128(gt, b), _mm_andnot_si128(gt, a));
+	}
+
+	static __m128i max(__m128i a, __m128i b)
+	{
+		const __m128i bias = _mm_set1_epi32(0x80000000);
+		const __m128i gt = _mm_cmpgt_epi32(_mm_xor_si128(a, bias), _mm_xor_si128(b, bias));
+		return _mm_or_si128(_mm_and_si128(gt, a), _mm_andnot_si128(gt, b));
+	}
+};
+
+/**
+ * Converts big-endian indices, replaces primitive restart index with -1 and tracks min/max of other indices.
+ * Vector path handles 16 bytes at a time.
+ */
 template<typename T>
-std::tuple<T, T> expand_indexed_triangle_fan(gsl::span<to_be_t<const T>> src, gsl::span<T> dst, bool is_primitive_restart_enabled, T primitive_restart_index)
+class index_filter
 {
-	T min_index = -1;
-	T max_index = 0;
+	using ops = index_ops<T>;
 
-	verify(HERE), (dst.size() >= 3 * (src.size() - 2));
+	const bool m_restart_enabled;
+	const T m_restart_index;
+	const __m128i m_swap_mask;
+	const __m128i m_restart;
 
-	const T index0 = src[0];
-	if (!is_primitive_restart_enabled || index0 != -1) // Cut
+	__m128i m_min;
+	__m128i m_max;
+
+	T m_min_index = -1;
+	T m_max_index = 0;
+
+public:
+	static constexpr u32 step = 16 / sizeof(T);
+
+	index_filter(bool restart_enabled, T restart_index)
+		: m_restart_enabled(restart_enabled)
+		, m_restart_index(restart_index)
+		, m_swap_mask(get_swap_mask<T>())
+		, m_restart(ops::splat(restart_index))
+		, m_min(_mm_set1_epi32(-1))
+		, m_max(_mm_setzero_si128())
 	{
-		min_index = std::min(min_index, index0);
-		max_index = std::max(max_index, index0);
 	}
 
-	size_t dst_idx = 0;
-	while (src.size() > 2)
+	// Process step indices
+	__m128i process(const be_t<T>* src)
 	{
-		gsl::span<to_be_t<const T>> tri_indexes = src.subspan(0, 2);
-		T index1 = tri_indexes[0];
-		if (is_primitive_restart_enabled && index1 == primitive_restart_index)
+		__m128i v = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)), m_swap_mask);
+
+		if (m_restart_enabled)
 		{
-			index1 = -1;
+			const __m128i mask = ops::eq(v, m_restart);
+			m_max = ops::max(m_max, _mm_andnot_si128(mask, v));
+			v = _mm_or_si128(v, mask);
 		}
 		else
 		{
-			min_index = std::min(min_index, index1);
-			max_index = std::max(max_index, index1);
+			m_max = ops::max(m_max, v);
+		}
+
+		// Restart indices became -1 and don't affect the minimum
+		m_min = ops::min(m_min, v);
+		return v;
+	}
+
+	// Process single index
+	T process(T index)
+	{
+		if (m_restart_enabled && index == m_restart_index)
+		{
+			return -1;
 		}
-		T index2 = tri_indexes[1];
-		if (is_primitive_restart_enabled && index2 == primitive_restart_index)
+
+		m_min_index = std::min(m_min_index, index);
+		m_max_index = std::max(m_max_index, index);
+		return index;
+	}
+
+	// Process the range of indices
+	void process(const be_t<T>* src, T* dst, std::size_t count)
+	{
+		std::size_t i = 0;
+
+		for (; i + step <= count; i += step)
 		{
-			index2 = -1;
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), process(src + i));
 		}
-		else
+
+		for (; i < count; i++)
 		{
-			min_index = std::min(min_index, index2);
-			max_index = std::max(max_index, index2);
+			dst[i] = process(static_cast<T>(src[i]));
 		}
+	}
 
-		dst[dst_idx++] = index0;
-		dst[dst_idx++] = index1;
-		dst[dst_idx++] = index2;
+	std::tuple<T, T> result() const
+	{
+		T min_v[step];
+		T max_v[step];
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(min_v), m_min);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(max_v), m_max);
+
+		T min_index = m_min_index;
+		T max_index = m_max_index;
+
+		for (u32 i = 0; i < step; i++)
+		{
+			min_index = std::min(min_index, min_v[i]);
+			max_index = std::max(max_index, max_v[i]);
+		}
 
-		src = src.subspan(2);
+		return std::make_tuple(min_index, max_index);
 	}
-	return std::make_tuple(min_index, max_index);
+};
+
+template<typename T>
+std::tuple<T, T> upload_untouched(gsl::span<to_be_t<const T>> src, gsl::span<T> dst, bool is_primitive_restart_enabled, T primitive_restart_index)
+{
+	verify(HERE), (dst.size_bytes() >= src.size_bytes());
+
+	index_filter<T> filter(is_primitive_restart_enabled, primitive_restart_index);
+	filter.process(src.data(), dst.data(), src.size());
+	return filter.result();
 }
 
 // FIXME: expanded primitive type may not support primitive restart correctly
 template<typename T>
-std::tuple<T, T> expand_indexed_quads(gsl::span<to_be_t<const T>> src, gsl::span<T> dst, bool is_primitive_restart_enabled, T primitive_restart_index)
+std::tuple<T, T> expand_indexed_triangle_fan(gsl::span<to_be_t<const T>> src, gsl::span<T> dst, bool is_primitive_restart_enabled, T primitive_restart_index)
 {
-	T min_index = -1;
-	T max_index = 0;
+	index_filter<T> filter(is_primitive_restart_enabled, primitive_restart_index);
 
-	verify(HERE), (4 * dst.size_bytes() >= 6 * src.size_bytes());
+	if (src.size() < 3)
+	{
+		// Not a single triangle, nothing to draw
+		return filter.result();
+	}
+
+	verify(HERE), (dst.size() >= 3 * (src.size() - 2));
 
-	size_t dst_idx = 0;
-	while (!src.empty())
+	const T index0 = filter.process(static_cast<T>(src[0]));
+	const std::size_t count = src.size();
+
+	T* out = dst.data();
+
+	// Convert indices in chunks, then emit triangles (index0, i, i + 1)
+	T chunk[256];
+
+	for (std::size_t i = 1; i + 1 < count;)
 	{
-		gsl::span<to_be_t<const T>> quad_indexes = src.subspan(0, 4);
-		T index0 = quad_indexes[0];
-		if (is_primitive_restart_enabled && index0 == primitive_restart_index)
-		{
-			index0 = -1;
-		}
-		else
-		{
-			min_index = std::min(min_index, index0);
-			max_index = std::max(max_index, index0);
-		}
-		T index1 = quad_indexes[1];
-		if (is_primitive_restart_enabled && index1 == primitive_restart_index)
-		{
-			index1 = -1;
-		}
-		else
-		{
-			min_index = std::min(min_index, index1);
-			max_index = std::max(max_index, index1);
-		}
-		T index2 = quad_indexes[2];
-		if (is_primitive_restart_enabled && index2 == primitive_restart_index)
-		{
-			index2 = -1;
-		}
-		else
-		{
-			min_index = std::min(min_index, index2);
-			max_index = std::max(max_index, index2);
-		}
-		T index3 = quad_indexes[3];
-		if (is_primitive_restart_enabled &&index3 == primitive_restart_index)
-		{
-			index3 = -1;
-		}
-		else
+		const std::size_t n = std::min<std::size_t>(count - i, 256);
+		filter.process(src.data() + i, chunk, n);
+
+		for (std::size_t j = 0; j + 1 < n; j++)
 		{
-			min_index = std::min(min_index, index3);
-			max_index = std::max(max_index, index3);
+			*out++ = index0;
+			*out++ = chunk[j];
+			*out++ = chunk[j + 1];
 		}
 
+		// Last index of the chunk starts the next triangle
+		i += n - 1;
+	}
+
+	return filter.result();
+}
+
+// Expand pairs of quads (a vector of 8 indices) to 12 triangle indices
+inline std::size_t expand_quads_vector(index_filter<u16>& filter, const be_t<u16>* src, u16* dst, std::size_t count)
+{
+	const __m128i lo = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 4, 5, 6, 7, 0, 1, 8, 9, 10, 11);
+	const __m128i hi = _mm_setr_epi8(12, 13, 12, 13, 14, 15, 8, 9, -1, -1, -1, -1, -1, -1, -1, -1);
+
+	std::size_t i = 0;
+
+	for (; i + 8 <= count; i += 8, dst += 12)
+	{
+		const __m128i v = filter.process(src + i);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_shuffle_epi8(v, lo));
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(dst + 8), _mm_shuffle_epi8(v, hi));
+	}
+
+	return i;
+}
+
+// Expand a quad (a vector of 4 indices) to 6 triangle indices
+inline std::size_t expand_quads_vector(index_filter<u32>& filter, const be_t<u32>* src, u32* dst, std::size_t count)
+{
+	std::size_t i = 0;
+
+	for (; i + 4 <= count; i += 4, dst += 6)
+	{
+		const __m128i v = filter.process(src + i);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 2, 1, 0)));
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(dst + 4), _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 0, 0, 3)));
+	}
+
+	return i;
+}
+
+// FIXME: expanded primitive type may not support primitive restart correctly
+template<typename T>
+std::tuple<T, T> expand_indexed_quads(gsl::span<to_be_t<const T>> src, gsl::span<T> dst, bool is_primitive_restart_enabled, T primitive_restart_index)
+{
+	verify(HERE), (4 * dst.size_bytes() >= 6 * src.size_bytes());
+
+	index_filter<T> filter(is_primitive_restart_enabled, primitive_restart_index);
+
+	const std::size_t count = src.size();
+	std::size_t i = expand_quads_vector(filter, src.data(), dst.data(), count);
+
+	// Remaining quads (incomplete quad is ignored)
+	for (T* out = dst.data() + i / 4 * 6; i + 4 <= count; i += 4)
+	{
+		const T index0 = filter.process(static_cast<T>(src[i]));
+		const T index1 = filter.process(static_cast<T>(src[i + 1]));
+		const T index2 = filter.process(static_cast<T>(src[i + 2]));
+		const T index3 = filter.process(static_cast<T>(src[i + 3]));
+
 		// First triangle
-		dst[dst_idx++] = index0;
-		dst[dst_idx++] = index1;
-		dst[dst_idx++] = index2;
+		*out++ = index0;
+		*out++ = index1;
+		*out++ = index2;
 		// Second triangle
-		dst[dst_idx++] = index2;
-		dst[dst_idx++] = index3;
-		dst[dst_idx++] = index0;
-
-		src = src.subspan(4);
+		*out++ = index2;
+		*out++ = index3;
+		*out++ = index0;
 	}
-	return std::make_tuple(min_index, max_index);
+
+	return filter.result();
 }
 }
 
@@ -277,7 +550,7 @@ u32 get_index_count(rsx::primitive_type draw_mode, u32 initial_index_count)
 		return initial_index_count + 1;
 	case rsx::primitive_type::polygon:
 	case rsx::primitive_type::triangle_fan:
-		return (initial_index_count - 2) * 3;
+		return initial_index_count < 3 ? 0 : (initial_index_count - 2) * 3;
 	case rsx::primitive_type::quads:
 		return (6 * initial_index_count) / 4;
 	case rsx::primitive_type::quad_strip:
@@ -309,7 +582,7 @@ void write_index_array_for_non_indexed_non_native_primitive_to_buffer(char* dst,
 		return;
 	case rsx::primitive_type::triangle_fan:
 	case rsx::primitive_type::polygon:
-		for (unsigned i = 0; i < (count - 2); i++)
+		for (unsigned i = 0; i + 2 < count; i++)
 		{
 			typedDst[3 * i] = first;
 			typedDst[3 * i + 1] = i + 2 - 1;
@@ -1,11 +1,20 @@
 #pragma once
 
+#include <array>
 #include <vector>
 
 #include "Utilities/GSL.h"
 #include "Emu/Memory/vm.h"
 #include "../RSXThread.h"
 
+/**
+ * Convert CMP vector to RGBA16.
+ * A vector in CMP (compressed) format is stored as X11Y11Z10 and has a W component of 1.
+ * X11 and Y11 channels are int between -1024 and 1023 interpreted as -1.f, 1.f
+ * Z10 is int between -512 and 511 interpreted as -1.f, 1.f
+ */
+std::array<u16, 4> decode_cmp_vector(u32 encoded_vector);
+
 /**
  * Write count vertex attributes from src_ptr.
  * src_ptr array layout is deduced from the type, vector element count and src_stride arguments.
@@ -1,8 +1,15 @@
 #include "stdafx.h"
 #include "ProgramStateCache.h"
+#include "Emu/System.h"
 
 using namespace program_hash_util;
 
+cfg::map_entry<shader_miss_policy> g_cfg_rsx_shader_miss_policy(cfg::root.video, "Shader miss policy",
+{
+	{ "Stall", shader_miss_policy::stall },
+	{ "Skip draw", shader_miss_policy::skip_draw },
+});
+
 size_t vertex_program_hash::operator()(const RSXVertexProgram &program) const
 {
 	// 64-bit Fowler/Noll/Vo FNV-1a hash code
@@ -130,3 +137,267 @@ bool fragment_program_compare::operator()(const RSXFragmentProgram& binary1, con
 			return true;
 	}
 }
+
+namespace
+{
+	enum : u32
+	{
+		pack_vertex_program = 1,
+		pack_fragment_program = 2,
+		pack_pipeline = 3,
+	};
+
+	constexpr u32 pack_magic = "RSXP"_u32;
+	constexpr u32 pack_version = 3;
+
+	struct pack_header
+	{
+		u32 magic;
+		u32 version;
+		u32 vertex_input_size; // Detect layout changes of the stored structures
+		u32 fragment_program_size;
+	};
+
+	struct pack_record
+	{
+		u32 type;
+		u32 size; // Size of the data following the record
+		u64 checksum;
+	};
+
+	u64 pack_checksum(const u8* data, std::size_t size)
+	{
+		// 64-bit Fowler/Noll/Vo FNV-1a hash code
+		u64 hash = 0xCBF29CE484222325ULL;
+
+		for (std::size_t i = 0; i < size; i++)
+		{
+			hash = (hash ^ data[i]) * 0x100000001B3ULL;
+		}
+
+		return hash;
+	}
+
+	bool read_vertex_program(const u8* data, u32 size, RSXVertexProgram& result)
+	{
+		u32 counts[3]; // Output mask, input count, ucode size (in words)
+
+		if (size < sizeof(counts))
+		{
+			return false;
+		}
+
+		std::memcpy(counts, data, sizeof(counts));
+
+		if (size != sizeof(counts) + u64{counts[1]} * sizeof(rsx_vertex_input) + u64{counts[2]} * sizeof(u32))
+		{
+			return false;
+		}
+
+		data += sizeof(counts);
+		result.output_mask = counts[0];
+		result.rsx_vertex_inputs.resize(counts[1]);
+		result.data.resize(counts[2]);
+		std::memcpy(result.rsx_vertex_inputs.data(), data, counts[1] * sizeof(rsx_vertex_input));
+		std::memcpy(result.data.data(), data + counts[1] * sizeof(rsx_vertex_input), counts[2] * sizeof(u32));
+		return true;
+	}
+
+	bool read_fragment_program(const u8* data, u32 size, RSXFragmentProgram& result)
+	{
+		if (size <= sizeof(RSXFragmentProgram))
+		{
+			return false;
+		}
+
+		std::memcpy(&result, data, sizeof(RSXFragmentProgram));
+
+		const u32 ucode_size = size - sizeof(RSXFragmentProgram);
+		result.addr = malloc(ucode_size);
+		std::memcpy(result.addr, data + sizeof(RSXFragmentProgram), ucode_size);
+		return true;
+	}
+
+	bool read_pipeline(const u8* data, u32 size, program_cache_pack::pipeline_record& result)
+	{
+		u32 header[3]; // Backend tag, vertex and fragment program indices
+
+		if (size < sizeof(header))
+		{
+			return false;
+		}
+
+		std::memcpy(header, data, sizeof(header));
+		result.backend = header[0];
+		result.vertex_program = header[1];
+		result.fragment_program = header[2];
+		result.properties.assign(data + sizeof(header), data + size);
+		return true;
+	}
+}
+
+constexpr u32 program_cache_pack::invalid_index;
+
+void program_cache_pack::open(std::vector<RSXVertexProgram>& vertex_programs, std::vector<RSXFragmentProgram>& fragment_programs, std::vector<pipeline_record>& pipelines)
+{
+	const std::string title = Emu.GetTitleID();
+
+	if (title.empty())
+	{
+		// Nothing to reuse between runs
+		return;
+	}
+
+	const std::string path = fs::get_executable_dir() + "data/cache/" + title + "/";
+
+	if ((!fs::is_dir(path) && !fs::create_path(path)) || !m_file.open(path + "programs.pack", fs::read + fs::write + fs::create))
+	{
+		LOG_ERROR(RSX, "Failed to open program cache in '%s' (%s)", path, fs::g_tls_error);
+		return;
+	}
+
+	const pack_header header{ pack_magic, pack_version, sizeof(rsx_vertex_input), sizeof(RSXFragmentProgram) };
+	const std::string data = m_file.to_string();
+
+	if (data.size() < sizeof(header) || std::memcmp(data.data(), &header, sizeof(header)) != 0)
+	{
+		if (!data.empty())
+		{
+			LOG_WARNING(RSX, "Program cache '%s' is outdated and will be rebuilt", path);
+		}
+
+		m_file.trunc(0);
+		m_file.seek(0);
+		m_file.write(header);
+		return;
+	}
+
+	std::size_t pos = sizeof(header);
+
+	while (pos + sizeof(pack_record) <= data.size())
+	{
+		pack_record record;
+		std::memcpy(&record, data.data() + pos, sizeof(record));
+
+		const u8* ptr = reinterpret_cast<const u8*>(data.data()) + pos + sizeof(record);
+
+		if (record.size > data.size() - pos - sizeof(record) || pack_checksum(ptr, record.size) != record.checksum)
+		{
+			break;
+		}
+
+		if (record.type == pack_vertex_program)
+		{
+			RSXVertexProgram program;
+
+			if (!read_vertex_program(ptr, record.size, program))
+			{
+				break;
+			}
+
+			vertex_programs.emplace_back(std::move(program));
+		}
+		else if (record.type == pack_fragment_program)
+		{
+			RSXFragmentProgram program;
+
+			if (!read_fragment_program(ptr, record.size, program))
+			{
+				break;
+			}
+
+			fragment_programs.emplace_back(program);
+		}
+		else if (record.type == pack_pipeline)
+		{
+			pipeline_record pipeline;
+
+			// Pipelines are stored after their programs
+			if (!read_pipeline(ptr, record.size, pipeline) || pipeline.vertex_program >= vertex_programs.size() || pipeline.fragment_program >= fragment_programs.size())
+			{
+				break;
+			}
+
+			pipelines.emplace_back(std::move(pipeline));
+		}
+		else
+		{
+			break;
+		}
+
+		pos += sizeof(record) + record.size;
+	}
+
+	if (pos != data.size())
+	{
+		// Drop the damaged tail (probably an interrupted write), new records are appended after valid ones
+		LOG_WARNING(RSX, "Program cache '%s' is damaged at 0x%x", path, pos);
+		m_file.trunc(pos);
+	}
+
+	m_file.seek(0, fs::seek_end);
+	m_vertex_count = ::size32(vertex_programs);
+	m_fragment_count = ::size32(fragment_programs);
+}
+
+void program_cache_pack::append(u32 type, const std::vector<u8>& data)
+{
+	if (!m_file)
+	{
+		return;
+	}
+
+	// Single write per record
+	std::vector<u8> buffer(sizeof(pack_record) + data.size());
+	const pack_record record{ type, ::size32(data), pack_checksum(data.data(), data.size()) };
+	std::memcpy(buffer.data(), &record, sizeof(record));
+	std::memcpy(buffer.data() + sizeof(record), data.data(), data.size());
+	m_file.write(buffer);
+}
+
+u32 program_cache_pack::store(const RSXVertexProgram& program)
+{
+	if (!m_file)
+	{
+		return invalid_index;
+	}
+
+	const u32 counts[3] = { program.output_mask, ::size32(program.rsx_vertex_inputs), ::size32(program.data) };
+	const u32 inputs_size = counts[1] * sizeof(rsx_vertex_input);
+
+	std::vector<u8> data(sizeof(counts) + inputs_size + counts[2] * sizeof(u32));
+	std::memcpy(data.data(), counts, sizeof(counts));
+	std::memcpy(data.data() + sizeof(counts), program.rsx_vertex_inputs.data(), inputs_size);
+	std::memcpy(data.data() + sizeof(counts) + inputs_size, program.data.data(), counts[2] * sizeof(u32));
+	append(pack_vertex_program, data);
+	return m_vertex_count++;
+}
+
+u32 program_cache_pack::store(const RSXFragmentProgram& program)
+{
+	if (!m_file)
+	{
+		return invalid_index;
+	}
+
+	const std::size_t ucode_size = fragment_program_utils::get_fragment_program_ucode_size(program.addr);
+
+	RSXFragmentProgram state = program;
+	state.addr = nullptr;
+
+	std::vector<u8> data(sizeof(RSXFragmentProgram) + ucode_size);
+	std::memcpy(data.data(), &state, sizeof(RSXFragmentProgram));
+	std::memcpy(data.data() + sizeof(RSXFragmentProgram), program.addr, ucode_size);
+	append(pack_fragment_program, data);
+	return m_fragment_count++;
+}
+
+void program_cache_pack::store(const pipeline_record& pipeline)
+{
+	const u32 header[3] = { pipeline.backend, pipeline.vertex_program, pipeline.fragment_program };
+
+	std::vector<u8> data(sizeof(header) + pipeline.properties.size());
+	std::memcpy(data.data(), header, sizeof(header));
+	std::memcpy(data.data() + sizeof(header), pipeline.properties.data(), pipeline.properties.size());
+	append(pack_pipeline, data);
+}
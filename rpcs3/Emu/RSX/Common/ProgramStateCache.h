@@ -5,6 +5,24 @@
 #include "Emu/Memory/vm.h"
 
 #include "Utilities/GSL.h"
+#include "Utilities/Config.h"
+#include "Utilities/File.h"
+#include "Utilities/Thread.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+
+enum class shader_miss_policy
+{
+	stall, // Decompile and compile in the draw call
+	skip_draw, // Decompile on worker threads, skip draws until the program is ready
+};
+
+extern cfg::map_entry<shader_miss_policy> g_cfg_rsx_shader_miss_policy;
 
 enum class SHADER_TYPE
 {
@@ -54,6 +72,40 @@ namespace program_hash_util
 	};
 }
 
+/**
+* Persistent list of the programs and pipelines met by program_state_cache (data/cache/<title>/programs.pack).
+* Program records contain RSX ucode and state only, so they don't depend on the backend: programs are decompiled again on load.
+* Pipeline records refer to program records by index and carry raw pipeline properties tagged with the backend which stored them.
+* Every record carries its size and checksum, loading stops at the first damaged record (the file is truncated there).
+*/
+class program_cache_pack
+{
+	fs::file m_file;
+	u32 m_vertex_count = 0;
+	u32 m_fragment_count = 0;
+
+	void append(u32 type, const std::vector<u8>& data);
+
+public:
+	static constexpr u32 invalid_index = ~0u;
+
+	struct pipeline_record
+	{
+		u32 backend; // Tag of the backend traits (pipeline_pack_tag)
+		u32 vertex_program; // Index of the vertex program record
+		u32 fragment_program; // Index of the fragment program record
+		std::vector<u8> properties;
+	};
+
+	// Open the pack and read stored records, fragment programs own their ucode copy (allocated with malloc)
+	void open(std::vector<RSXVertexProgram>& vertex_programs, std::vector<RSXFragmentProgram>& fragment_programs, std::vector<pipeline_record>& pipelines);
+
+	// Return the index of the new record (invalid_index if the pack isn't open)
+	u32 store(const RSXVertexProgram& program);
+	u32 store(const RSXFragmentProgram& program);
+
+	void store(const pipeline_record& pipeline);
+};
 
 /**
 * Cache for program help structure (blob, string...)
@@ -64,10 +116,18 @@ namespace program_hash_util
 * - a typedef PipelineData encapsulating monolithic program.
 * - a typedef PipelineProperties to a type that encapsulate various state info relevant to program compilation (alpha test, primitive type,...)
 * - a	typedef ExtraData type that will be passed to the buildProgram function.
+* - a static constexpr u32 pipeline_pack_tag identifying the backend in pipeline records of program_cache_pack (PipelineProperties are stored as raw bytes, so they must not contain pointers or handles).
 * It should also contains the following function member :
-* - static void recompile_fragment_program(RSXFragmentProgram *RSXFP, FragmentProgramData& fragmentProgramData, size_t ID);
-* - static void recompile_vertex_program(RSXVertexProgram *RSXVP, VertexProgramData& vertexProgramData, size_t ID);
+* - static void decompile_fragment_program(const RSXFragmentProgram &RSXFP, FragmentProgramData& fragmentProgramData, size_t ID);
+* - static void decompile_vertex_program(const RSXVertexProgram &RSXVP, VertexProgramData& vertexProgramData, size_t ID);
+* - static void compile_fragment_program(FragmentProgramData& fragmentProgramData, size_t ID);
+* - static void compile_vertex_program(VertexProgramData& vertexProgramData, size_t ID);
 * - static PipelineData build_program(VertexProgramData &vertexProgramData, FragmentProgramData &fragmentProgramData, const PipelineProperties &pipelineProperties, const ExtraData& extraData);
+* decompile_* functions must be thread-safe: they may run on worker threads (see shader_miss_policy).
+* Backends should do as much work as possible there (GLSL/HLSL generation, native compilation), compile_* is only meant for work bound to the context thread.
+* compile_* and build_program are always called from the thread calling getGraphicPipelineState.
+* Programs stored in program_cache_pack by previous runs are queued for decompilation on the first call of getGraphicPipelineState or process_preloaded.
+* process_preloaded should be called by the backend when the RSX thread is idle: it compiles decompiled programs and prebuilds stored pipelines.
 */
 template<typename backend_traits>
 class program_state_cache
@@ -77,8 +137,25 @@ class program_state_cache
 	using vertex_program_type = typename backend_traits::vertex_program_type;
 	using fragment_program_type = typename backend_traits::fragment_program_type;
 
-	using binary_to_vertex_program = std::unordered_map<RSXVertexProgram, vertex_program_type, program_hash_util::vertex_program_hash, program_hash_util::vertex_program_compare> ;
-	using binary_to_fragment_program = std::unordered_map<RSXFragmentProgram, fragment_program_type, program_hash_util::fragment_program_hash, program_hash_util::fragment_program_compare>;
+	enum program_status : u32
+	{
+		program_queued, // Decompilation not started
+		program_decompiling,
+		program_decompiled, // Published by the decompiler, not compiled yet
+		program_ready,
+	};
+
+	template<typename T>
+	struct program_entry
+	{
+		T program;
+		size_t index;
+		u32 pack_index = program_cache_pack::invalid_index;
+		atomic_t<u32> status{ program_queued };
+	};
+
+	using binary_to_vertex_program = std::unordered_map<RSXVertexProgram, program_entry<vertex_program_type>, program_hash_util::vertex_program_hash, program_hash_util::vertex_program_compare> ;
+	using binary_to_fragment_program = std::unordered_map<RSXFragmentProgram, program_entry<fragment_program_type>, program_hash_util::fragment_program_hash, program_hash_util::fragment_program_compare>;
 
 
 	struct pipeline_key
@@ -108,34 +185,340 @@ class program_state_cache
 		}
 	};
 
+	// Decompiler workers, started on the first asynchronous miss
+	std::vector<std::shared_ptr<thread_ctrl>> m_workers;
+	atomic_t<bool> m_workers_exit{ false };
+	std::mutex m_jobs_mutex;
+	std::condition_variable m_jobs_done; // Signalled when m_jobs_pending drops to zero
+	std::deque<std::function<void()>> m_jobs;
+	atomic_t<u32> m_jobs_pending{ 0 }; // Queued or running jobs
+
+	program_cache_pack m_pack;
+	bool m_pack_loaded = false;
+
+	template<typename Key, typename Program>
+	using preloaded_program = std::pair<const Key*, program_entry<Program>*>;
+
+	struct preloaded_pipeline
+	{
+		program_entry<vertex_program_type>* vertex_program;
+		program_entry<fragment_program_type>* fragment_program;
+		pipeline_properties properties;
+	};
+
+	// Programs and pipelines from the pack which are not ready yet (processed by process_preloaded)
+	std::deque<preloaded_program<RSXVertexProgram, vertex_program_type>> m_preloaded_vertex_programs;
+	std::deque<preloaded_program<RSXFragmentProgram, fragment_program_type>> m_preloaded_fragment_programs;
+	std::deque<preloaded_pipeline> m_preloaded_pipelines;
+
+	// Pipelines stored in the pack (keys contain record indices instead of program ids)
+	std::unordered_set<pipeline_key, pipeline_key_hash, pipeline_key_compare> m_stored_pipelines;
+
+	static void decompile(const RSXVertexProgram& rsx_vp, program_entry<vertex_program_type>& entry)
+	{
+		backend_traits::decompile_vertex_program(rsx_vp, entry.program, entry.index);
+	}
+
+	static void decompile(const RSXFragmentProgram& rsx_fp, program_entry<fragment_program_type>& entry)
+	{
+		backend_traits::decompile_fragment_program(rsx_fp, entry.program, entry.index);
+	}
+
+	static void compile(const RSXVertexProgram&, program_entry<vertex_program_type>& entry)
+	{
+		backend_traits::compile_vertex_program(entry.program, entry.index);
+	}
+
+	static void compile(const RSXFragmentProgram&, program_entry<fragment_program_type>& entry)
+	{
+		backend_traits::compile_fragment_program(entry.program, entry.index);
+	}
+
+	// Claim a queued entry and decompile it (the RSX thread and workers race for it)
+	template<typename Key, typename Program>
+	static bool try_decompile(const Key& key, program_entry<Program>& entry)
+	{
+		if (!entry.status.compare_and_swap_test(program_queued, program_decompiling))
+		{
+			return false;
+		}
+
+		decompile(key, entry);
+		entry.status = program_decompiled;
+		return true;
+	}
+
+	void start_workers()
+	{
+		const u32 count = std::min<u32>(std::max<u32>(std::thread::hardware_concurrency(), 2) - 1, 4);
+
+		m_workers.resize(count);
+
+		for (u32 i = 0; i < count; i++)
+		{
+			thread_ctrl::spawn(m_workers[i], fmt::format("RSX Decompiler %u", i), [this]()
+			{
+				while (!m_workers_exit)
+				{
+					std::function<void()> job;
+					{
+						std::lock_guard<std::mutex> lock(m_jobs_mutex);
+
+						if (!m_jobs.empty())
+						{
+							job = std::move(m_jobs.front());
+							m_jobs.pop_front();
+						}
+					}
+
+					if (!job)
+					{
+						// Notifications are sticky: a job queued after the check above wakes the worker immediately
+						thread_ctrl::wait();
+						continue;
+					}
+
+					job();
+
+					if (--m_jobs_pending == 0)
+					{
+						std::lock_guard<std::mutex> lock(m_jobs_mutex);
+						m_jobs_done.notify_all();
+					}
+				}
+			});
+		}
+	}
+
+	template<typename Key, typename Program>
+	void enqueue(const Key& key, program_entry<Program>& entry)
+	{
+		if (m_workers.empty())
+		{
+			start_workers();
+		}
+
+		m_jobs_pending++;
+
+		{
+			std::lock_guard<std::mutex> lock(m_jobs_mutex);
+			m_jobs.emplace_back([&key, &entry]() { try_decompile(key, entry); });
+		}
+
+		for (auto& worker : m_workers)
+		{
+			worker->notify();
+		}
+	}
+
+	// Add programs stored by previous runs and queue their decompilation, remember stored pipelines
+	void preload_programs()
+	{
+		std::vector<RSXVertexProgram> vertex_programs;
+		std::vector<RSXFragmentProgram> fragment_programs;
+		std::vector<program_cache_pack::pipeline_record> pipelines;
+		m_pack.open(vertex_programs, fragment_programs, pipelines);
+
+		// Entries by record index (duplicate records refer to the same entry)
+		std::vector<program_entry<vertex_program_type>*> vertex_entries;
+		std::vector<program_entry<fragment_program_type>*> fragment_entries;
+
+		for (u32 i = 0; i < vertex_programs.size(); i++)
+		{
+			const auto result = m_vertex_shader_cache.emplace(std::piecewise_construct, std::forward_as_tuple(std::move(vertex_programs[i])), std::forward_as_tuple());
+
+			if (result.second)
+			{
+				result.first->second.index = m_next_id++;
+				result.first->second.pack_index = i;
+				enqueue(result.first->first, result.first->second);
+				m_preloaded_vertex_programs.emplace_back(&result.first->first, &result.first->second);
+			}
+
+			vertex_entries.emplace_back(&result.first->second);
+		}
+
+		for (u32 i = 0; i < fragment_programs.size(); i++)
+		{
+			const auto result = m_fragment_shader_cache.emplace(std::piecewise_construct, std::forward_as_tuple(fragment_programs[i]), std::forward_as_tuple());
+
+			if (result.second)
+			{
+				result.first->second.index = m_next_id++;
+				result.first->second.pack_index = i;
+				enqueue(result.first->first, result.first->second);
+				m_preloaded_fragment_programs.emplace_back(&result.first->first, &result.first->second);
+			}
+			else
+			{
+				free(fragment_programs[i].addr);
+			}
+
+			fragment_entries.emplace_back(&result.first->second);
+		}
+
+		for (const auto& pipeline : pipelines)
+		{
+			// Skip pipelines of other backends
+			if (pipeline.backend != backend_traits::pipeline_pack_tag || pipeline.properties.size() != sizeof(pipeline_properties))
+			{
+				continue;
+			}
+
+			preloaded_pipeline info{ vertex_entries[pipeline.vertex_program], fragment_entries[pipeline.fragment_program] };
+			std::memcpy(&info.properties, pipeline.properties.data(), sizeof(pipeline_properties));
+
+			if (m_stored_pipelines.insert({ pipeline.vertex_program, pipeline.fragment_program, info.properties }).second)
+			{
+				m_preloaded_pipelines.emplace_back(info);
+			}
+		}
+
+		if (!vertex_programs.empty() || !fragment_programs.empty())
+		{
+			LOG_NOTICE(RSX, "Program cache: %u vertex and %u fragment programs queued, %u pipelines to build", vertex_programs.size(), fragment_programs.size(), m_preloaded_pipelines.size());
+		}
+	}
+
+	// Compile the first preloaded program if its decompilation is done (returns false if nothing was done)
+	template<typename Key, typename Program>
+	static bool compile_preloaded(std::deque<preloaded_program<Key, Program>>& queue)
+	{
+		while (!queue.empty())
+		{
+			const auto& key = *queue.front().first;
+			auto& entry = *queue.front().second;
+			const u32 status = entry.status;
+
+			if (status == program_ready)
+			{
+				// Already compiled by a draw
+				queue.pop_front();
+				continue;
+			}
+
+			if (status != program_decompiled)
+			{
+				return false;
+			}
+
+			compile(key, entry);
+			entry.status = program_ready;
+			queue.pop_front();
+			return true;
+		}
+
+		return false;
+	}
+
+	// Wait until the workers don't reference any cache entry
+	void wait_for_jobs()
+	{
+		std::unique_lock<std::mutex> lock(m_jobs_mutex);
+		m_jobs_done.wait(lock, [this]() { return m_jobs_pending == 0; });
+	}
+
+	// Returns nullptr if the program isn't ready and the draw must be skipped
+	template<typename Key, typename Program>
+	program_entry<Program>* finish_program(const Key& key, program_entry<Program>& entry, bool async)
+	{
+		const u32 status = entry.status;
+
+		if (LIKELY(status == program_ready))
+		{
+			return &entry;
+		}
+
+		if (status < program_decompiled)
+		{
+			if (async)
+			{
+				return nullptr;
+			}
+
+			if (!try_decompile(key, entry))
+			{
+				// Taken by a worker (the policy was changed)
+				while (entry.status < program_decompiled)
+				{
+					std::this_thread::yield();
+				}
+			}
+		}
+
+		compile(key, entry);
+		entry.status = program_ready;
+		return &entry;
+	}
+
+	// Find or build the pipeline, the flag is true if it was built
+	template<typename... Args>
+	std::pair<pipeline_storage_type*, bool> build_pipeline(const program_entry<vertex_program_type>& vertex_entry, const program_entry<fragment_program_type>& fragment_entry, const pipeline_properties& properties, Args&& ...args)
+	{
+		pipeline_key key = { vertex_entry.program.id, fragment_entry.program.id, properties };
+
+		const auto I = m_storage.find(key);
+		if (I != m_storage.end())
+			return{ &I->second, false };
+
+		LOG_NOTICE(RSX, "Add program :");
+		LOG_NOTICE(RSX, "*** vp id = %d", vertex_entry.program.id);
+		LOG_NOTICE(RSX, "*** fp id = %d", fragment_entry.program.id);
+
+		return{ &(m_storage[key] = backend_traits::build_pipeline(vertex_entry.program, fragment_entry.program, properties, std::forward<Args>(args)...)), true };
+	}
+
+	void store_pipeline(const program_entry<vertex_program_type>& vertex_entry, const program_entry<fragment_program_type>& fragment_entry, const pipeline_properties& properties)
+	{
+		if (vertex_entry.pack_index == program_cache_pack::invalid_index || fragment_entry.pack_index == program_cache_pack::invalid_index)
+		{
+			return;
+		}
+
+		if (!m_stored_pipelines.insert({ vertex_entry.pack_index, fragment_entry.pack_index, properties }).second)
+		{
+			// Stored by a previous run, not prebuilt yet
+			return;
+		}
+
+		program_cache_pack::pipeline_record record{ backend_traits::pipeline_pack_tag, vertex_entry.pack_index, fragment_entry.pack_index };
+		record.properties.resize(sizeof(pipeline_properties));
+		std::memcpy(record.properties.data(), &properties, sizeof(pipeline_properties));
+		m_pack.store(record);
+	}
+
 protected:
 	size_t m_next_id = 0;
 	binary_to_vertex_program m_vertex_shader_cache;
 	binary_to_fragment_program m_fragment_shader_cache;
 	std::unordered_map <pipeline_key, pipeline_storage_type, pipeline_key_hash, pipeline_key_compare> m_storage;
 
-	/// bool here to inform that the program was preexisting.
-	std::tuple<const vertex_program_type&, bool> search_vertex_program(const RSXVertexProgram& rsx_vp)
+	program_entry<vertex_program_type>* search_vertex_program(const RSXVertexProgram& rsx_vp, bool async)
 	{
 		const auto& I = m_vertex_shader_cache.find(rsx_vp);
 		if (I != m_vertex_shader_cache.end())
 		{
-			return std::forward_as_tuple(I->second, true);
+			return finish_program(I->first, I->second, async);
 		}
 		LOG_NOTICE(RSX, "VP not found in buffer!");
-		vertex_program_type& new_shader = m_vertex_shader_cache[rsx_vp];
-		backend_traits::recompile_vertex_program(rsx_vp, new_shader, m_next_id++);
+		auto& new_entry = *m_vertex_shader_cache.emplace(std::piecewise_construct, std::forward_as_tuple(rsx_vp), std::forward_as_tuple()).first;
+		new_entry.second.index = m_next_id++;
+		new_entry.second.pack_index = m_pack.store(new_entry.first);
+
+		if (async)
+		{
+			enqueue(new_entry.first, new_entry.second);
+		}
 
-		return std::forward_as_tuple(new_shader, false);
+		return finish_program(new_entry.first, new_entry.second, async);
 	}
 
-	/// bool here to inform that the program was preexisting.
-	std::tuple<const fragment_program_type&, bool> search_fragment_program(const RSXFragmentProgram& rsx_fp)
+	program_entry<fragment_program_type>* search_fragment_program(const RSXFragmentProgram& rsx_fp, bool async)
 	{
 		const auto& I = m_fragment_shader_cache.find(rsx_fp);
 		if (I != m_fragment_shader_cache.end())
 		{
-			return std::forward_as_tuple(I->second, true);
+			return finish_program(I->first, I->second, async);
 		}
 		LOG_NOTICE(RSX, "FP not found in buffer!");
 		size_t fragment_program_size = program_hash_util::fragment_program_utils::get_fragment_program_ucode_size(rsx_fp.addr);
@@ -143,16 +526,50 @@ protected:
 		std::memcpy(fragment_program_ucode_copy, rsx_fp.addr, fragment_program_size);
 		RSXFragmentProgram new_fp_key = rsx_fp;
 		new_fp_key.addr = fragment_program_ucode_copy;
-		fragment_program_type &new_shader = m_fragment_shader_cache[new_fp_key];
-		backend_traits::recompile_fragment_program(rsx_fp, new_shader, m_next_id++);
+		auto& new_entry = *m_fragment_shader_cache.emplace(std::piecewise_construct, std::forward_as_tuple(new_fp_key), std::forward_as_tuple()).first;
+		new_entry.second.index = m_next_id++;
+		new_entry.second.pack_index = m_pack.store(new_entry.first);
+
+		// The key owns a copy of the ucode, so the decompiler doesn't depend on guest memory
+		if (async)
+		{
+			enqueue(new_entry.first, new_entry.second);
+		}
 
-		return std::forward_as_tuple(new_shader, false);
+		return finish_program(new_entry.first, new_entry.second, async);
+	}
+
+	// Drop cached programs (no worker may be running)
+	void clear_programs()
+	{
+		wait_for_jobs();
+
+		for (auto& pair : m_fragment_shader_cache)
+		{
+			free(pair.first.addr);
+		}
+
+		m_vertex_shader_cache.clear();
+		m_fragment_shader_cache.clear();
+		m_preloaded_vertex_programs.clear();
+		m_preloaded_fragment_programs.clear();
+		m_preloaded_pipelines.clear();
 	}
 
 public:
 	program_state_cache() = default;
 	~program_state_cache()
 	{
+		wait_for_jobs();
+
+		m_workers_exit = true;
+
+		for (auto& worker : m_workers)
+		{
+			worker->notify();
+			worker->join();
+		}
+
 		for (auto& pair : m_fragment_shader_cache)
 		{
 			free(pair.first.addr);
@@ -162,57 +579,103 @@ public:
 	const vertex_program_type& get_transform_program(const RSXVertexProgram& rsx_vp) const
 	{
 		auto I = m_vertex_shader_cache.find(rsx_vp);
-		if (I != m_vertex_shader_cache.end())
-			return I->second;
+		if (I != m_vertex_shader_cache.end() && I->second.status == program_ready)
+			return I->second.program;
 		fmt::throw_exception("Trying to get unknown transform program" HERE);
 	}
 
 	const fragment_program_type& get_shader_program(const RSXFragmentProgram& rsx_fp) const
 	{
 		auto I = m_fragment_shader_cache.find(rsx_fp);
-		if (I != m_fragment_shader_cache.end())
-			return I->second;
+		if (I != m_fragment_shader_cache.end() && I->second.status == program_ready)
+			return I->second.program;
 		fmt::throw_exception("Trying to get unknown shader program" HERE);
 	}
 
+	/// Returns nullptr if the draw must be skipped because a program is still being decompiled.
 	template<typename... Args>
-	pipeline_storage_type& getGraphicPipelineState(
+	pipeline_storage_type* getGraphicPipelineState(
 		const RSXVertexProgram& vertexShader,
 		const RSXFragmentProgram& fragmentShader,
 		const pipeline_properties& pipelineProperties,
 		Args&& ...args
 		)
 	{
-		// TODO : use tie and implicit variable declaration syntax with c++17
-		const auto &vp_search = search_vertex_program(vertexShader);
-		const auto &fp_search = search_fragment_program(fragmentShader);
-		const vertex_program_type &vertex_program = std::get<0>(vp_search);
-		const fragment_program_type &fragment_program = std::get<0>(fp_search);
-		bool already_existing_fragment_program = std::get<1>(fp_search);
-		bool already_existing_vertex_program = std::get<1>(vp_search);
+		const bool async = g_cfg_rsx_shader_miss_policy.get() == shader_miss_policy::skip_draw;
 
-		pipeline_key key = { vertex_program.id, fragment_program.id, pipelineProperties };
+		if (UNLIKELY(!m_pack_loaded))
+		{
+			m_pack_loaded = true;
+			preload_programs();
+		}
+
+		// Both searches must run so that both programs get queued on a miss
+		const auto vertex_entry = search_vertex_program(vertexShader, async);
+		const auto fragment_entry = search_fragment_program(fragmentShader, async);
 
-		if (already_existing_fragment_program && already_existing_vertex_program)
+		if (!vertex_entry || !fragment_entry)
 		{
-			const auto I = m_storage.find(key);
-			if (I != m_storage.end())
-				return I->second;
+			return nullptr;
 		}
 
-		LOG_NOTICE(RSX, "Add program :");
-		LOG_NOTICE(RSX, "*** vp id = %d", vertex_program.id);
-		LOG_NOTICE(RSX, "*** fp id = %d", fragment_program.id);
+		const auto result = build_pipeline(*vertex_entry, *fragment_entry, pipelineProperties, std::forward<Args>(args)...);
 
-		m_storage[key] = backend_traits::build_pipeline(vertex_program, fragment_program, pipelineProperties, std::forward<Args>(args)...);
-		return m_storage[key];
+		if (result.second)
+		{
+			store_pipeline(*vertex_entry, *fragment_entry, pipelineProperties);
+		}
+
+		return result.first;
+	}
+
+	/**
+	* Compile up to `count` preloaded programs whose decompilation is done, then prebuild stored pipelines (`count` at most).
+	* Must be called from the thread calling getGraphicPipelineState, args are passed to build_pipeline.
+	* Returns true if something was done.
+	*/
+	template<typename... Args>
+	bool process_preloaded(u32 count, Args&& ...args)
+	{
+		if (UNLIKELY(!m_pack_loaded))
+		{
+			m_pack_loaded = true;
+			preload_programs();
+		}
+
+		u32 done = 0;
+
+		while (done < count && (compile_preloaded(m_preloaded_vertex_programs) || compile_preloaded(m_preloaded_fragment_programs)))
+		{
+			done++;
+		}
+
+		if (done || !m_preloaded_vertex_programs.empty() || !m_preloaded_fragment_programs.empty())
+		{
+			// Pipelines are built when all programs are ready
+			return done != 0;
+		}
+
+		for (; done < count && !m_preloaded_pipelines.empty(); done++)
+		{
+			const preloaded_pipeline& pipeline = m_preloaded_pipelines.front();
+
+			// Programs added by draws may still be in the decompiler queue
+			if (pipeline.vertex_program->status == program_ready && pipeline.fragment_program->status == program_ready)
+			{
+				build_pipeline(*pipeline.vertex_program, *pipeline.fragment_program, pipeline.properties, args...);
+			}
+
+			m_preloaded_pipelines.pop_front();
+		}
+
+		return done != 0;
 	}
 
 	size_t get_fragment_constants_buffer_size(const RSXFragmentProgram &fragmentShader) const
 	{
 		const auto I = m_fragment_shader_cache.find(fragmentShader);
-		if (I != m_fragment_shader_cache.end())
-			return I->second.FragmentConstantOffsetCache.size() * 4 * sizeof(float);
+		if (I != m_fragment_shader_cache.end() && I->second.status == program_ready)
+			return I->second.program.FragmentConstantOffsetCache.size() * 4 * sizeof(float);
 		LOG_ERROR(RSX, "Can't retrieve constant offset cache");
 		return 0;
 	}
@@ -220,17 +683,17 @@ public:
 	void fill_fragment_constants_buffer(gsl::span<f32, gsl::dynamic_range> dst_buffer, const RSXFragmentProgram &fragment_program) const
 	{
 		const auto I = m_fragment_shader_cache.find(fragment_program);
-		if (I == m_fragment_shader_cache.end())
+		if (I == m_fragment_shader_cache.end() || I->second.status != program_ready)
 			return;
 		__m128i mask = _mm_set_epi8(0xE, 0xF, 0xC, 0xD,
 			0xA, 0xB, 0x8, 0x9,
 			0x6, 0x7, 0x4, 0x5,
 			0x2, 0x3, 0x0, 0x1);
 
-		verify(HERE), (dst_buffer.size_bytes() >= ::narrow<int>(I->second.FragmentConstantOffsetCache.size()) * 16);
+		verify(HERE), (dst_buffer.size_bytes() >= ::narrow<int>(I->second.program.FragmentConstantOffsetCache.size()) * 16);
 
 		size_t offset = 0;
-		for (size_t offset_in_fragment_program : I->second.FragmentConstantOffsetCache)
+		for (size_t offset_in_fragment_program : I->second.program.FragmentConstantOffsetCache)
 		{
 			void *data = (char*)fragment_program.addr + (u32)offset_in_fragment_program;
 			const __m128i &vector = _mm_loadu_si128((__m128i*)data);
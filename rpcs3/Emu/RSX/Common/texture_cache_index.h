@@ -0,0 +1,80 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+namespace rsx
+{
+	/**
+	 * Address range index for texture cache entries (backend-agnostic).
+	 * Guest memory is split in 64 KB buckets, each bucket keeps ids of all entries overlapping it.
+	 * Lookups only visit the buckets covering the requested range, so their cost doesn't depend on the cache size.
+	 * Entry ids are chosen by the owner (usually an index in its own storage).
+	 */
+	class texture_cache_index
+	{
+		static constexpr u32 bucket_shift = 16;
+
+		std::vector<std::vector<u32>> m_buckets;
+
+		static u32 last_bucket(u32 base, u32 size)
+		{
+			const u64 last = u64{base} + std::max<u32>(size, 1) - 1;
+			return static_cast<u32>(std::min<u64>(last, UINT32_MAX) >> bucket_shift);
+		}
+
+	public:
+		texture_cache_index()
+			: m_buckets(0x100000000ull >> bucket_shift)
+		{
+		}
+
+		// Register the entry for the range (the same id must not be registered twice for overlapping ranges)
+		void insert(u32 id, u32 base, u32 size)
+		{
+			for (u32 i = base >> bucket_shift, end = last_bucket(base, size); i <= end; i++)
+			{
+				m_buckets[i].push_back(id);
+			}
+		}
+
+		// Unregister the entry (the range must be the same as passed to insert())
+		void erase(u32 id, u32 base, u32 size)
+		{
+			for (u32 i = base >> bucket_shift, end = last_bucket(base, size); i <= end; i++)
+			{
+				auto& bucket = m_buckets[i];
+				const auto found = std::find(bucket.begin(), bucket.end(), id);
+
+				if (found != bucket.end())
+				{
+					*found = bucket.back();
+					bucket.pop_back();
+				}
+			}
+		}
+
+		void clear()
+		{
+			for (auto& bucket : m_buckets)
+			{
+				bucket.clear();
+			}
+		}
+
+		// Get ids of the entries which may overlap the range (sorted, without duplicates)
+		std::vector<u32> find(u32 base, u32 size) const
+		{
+			std::vector<u32> result;
+
+			for (u32 i = base >> bucket_shift, end = last_bucket(base, size); i <= end; i++)
+			{
+				result.insert(result.end(), m_buckets[i].begin(), m_buckets[i].end());
+			}
+
+			std::sort(result.begin(), result.end());
+			result.erase(std::unique(result.begin(), result.end()), result.end());
+			return result;
+		}
+	};
+}
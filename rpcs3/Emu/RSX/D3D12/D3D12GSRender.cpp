@@ -324,10 +324,17 @@ void D3D12GSRender::end()
 	m_timers.vertex_index_duration += std::chrono::duration_cast<std::chrono::microseconds>(vertex_index_duration_end - vertex_index_duration_start).count();
 
 	std::chrono::time_point<steady_clock> program_load_start = steady_clock::now();
-	load_program();
+	const bool program_ready = load_program();
 	std::chrono::time_point<steady_clock> program_load_end = steady_clock::now();
 	m_timers.program_load_duration += std::chrono::duration_cast<std::chrono::microseconds>(program_load_end - program_load_start).count();
 
+	if (!program_ready)
+	{
+		// Program not ready (see shader_miss_policy)
+		thread::end();
+		return;
+	}
+
 	get_current_resource_storage().command_list->SetGraphicsRootSignature(m_shared_root_signature.Get());
 	get_current_resource_storage().command_list->OMSetStencilRef(rsx::method_registers.stencil_func_ref());
 
@@ -687,6 +694,12 @@ bool D3D12GSRender::on_access_violation(u32 address, bool is_writing)
 	return false;
 }
 
+bool D3D12GSRender::on_idle()
+{
+	// Prebuild pipeline states stored by previous runs a few at a time
+	return m_pso_cache.process_preloaded(4, m_device.Get(), m_shared_root_signature.Get());
+}
+
 void D3D12GSRender::reset_timer()
 {
 	m_timers.draw_calls_count = 0;
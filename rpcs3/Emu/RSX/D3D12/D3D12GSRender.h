@@ -130,7 +130,7 @@ private:
 	void init_d2d_structures();
 	void release_d2d_structures();
 
-	void load_program();
+	bool load_program();
 
 	void set_rtt_and_ds(ID3D12GraphicsCommandList *command_list);
 
@@ -179,6 +179,7 @@ protected:
 	virtual void flip(int buffer) override;
 
 	virtual bool on_access_violation(u32 address, bool is_writing) override;
+	virtual bool on_idle() override;
 
 	virtual std::array<std::vector<gsl::byte>, 4> copy_render_targets_to_memory() override;
 	virtual std::array<std::vector<gsl::byte>, 2> copy_depth_stencil_buffer_to_memory() override;
@@ -38,7 +38,7 @@ void Shader::Compile(const std::string &code, SHADER_TYPE st)
 	}
 }
 
-void D3D12GSRender::load_program()
+bool D3D12GSRender::load_program()
 {
 	auto rtt_lookup_func = [this](u32 texaddr, bool is_depth) -> std::tuple<bool, u16>
 	{
@@ -315,12 +315,26 @@ void D3D12GSRender::load_program()
 		}
 	}
 
-	m_current_pso = m_pso_cache.getGraphicPipelineState(m_vertex_program, m_fragment_program, prop, m_device.Get(), m_shared_root_signature.Get());
-	return;
+	auto pso = m_pso_cache.getGraphicPipelineState(m_vertex_program, m_fragment_program, prop, m_device.Get(), m_shared_root_signature.Get());
+
+	if (!pso)
+	{
+		m_current_pso = {};
+		return false;
+	}
+
+	m_current_pso = *pso;
+	return true;
 }
 
 std::pair<std::string, std::string> D3D12GSRender::get_programs() const
 {
+	if (!std::get<0>(m_current_pso))
+	{
+		// The draw was skipped, programs aren't ready
+		return{};
+	}
+
 	return std::make_pair(m_pso_cache.get_transform_program(m_vertex_program).content, m_pso_cache.get_shader_program(m_fragment_program).content);
 }
 #endif
@@ -107,13 +107,15 @@ struct D3D12Traits
 	using pipeline_storage_type = std::tuple<ComPtr<ID3D12PipelineState>, size_t, size_t>;
 	using pipeline_properties  = D3D12PipelineProperties;
 
+	static constexpr u32 pipeline_pack_tag = "D3D1"_u32;
+
 	static
-	void recompile_fragment_program(const RSXFragmentProgram &RSXFP, fragment_program_type& fragmentProgramData, size_t ID)
+	void decompile_fragment_program(const RSXFragmentProgram &RSXFP, fragment_program_type& fragmentProgramData, size_t ID)
 	{
 		u32 size;
 		D3D12FragmentDecompiler FS(RSXFP, size);
 		const std::string &shader = FS.Decompile();
-		fragmentProgramData.Compile(shader, Shader::SHADER_TYPE::SHADER_TYPE_FRAGMENT);
+		fragmentProgramData.content = shader;
 		fragmentProgramData.m_textureCount = 0;
 		for (const ParamType& PT : FS.m_parr.params[PF_PARAM_UNIFORM])
 		{
@@ -132,17 +134,29 @@ struct D3D12Traits
 
 		fs::file(fs::get_config_dir() + "shaderlog/FragmentProgram" + std::to_string(ID) + ".hlsl", fs::rewrite).write(shader);
 		fragmentProgramData.id = (u32)ID;
+		fragmentProgramData.Compile(fragmentProgramData.content, Shader::SHADER_TYPE::SHADER_TYPE_FRAGMENT);
 	}
 
 	static
-	void recompile_vertex_program(const RSXVertexProgram &RSXVP, vertex_program_type& vertexProgramData, size_t ID)
+	void decompile_vertex_program(const RSXVertexProgram &RSXVP, vertex_program_type& vertexProgramData, size_t ID)
 	{
 		D3D12VertexProgramDecompiler VS(RSXVP);
-		std::string shaderCode = VS.Decompile();
-		vertexProgramData.Compile(shaderCode, Shader::SHADER_TYPE::SHADER_TYPE_VERTEX);
+		vertexProgramData.content = VS.Decompile();
 		vertexProgramData.vertex_shader_input_count = RSXVP.rsx_vertex_inputs.size();
-		fs::file(fs::get_config_dir() + "shaderlog/VertexProgram" + std::to_string(ID) + ".hlsl", fs::rewrite).write(shaderCode);
+		fs::file(fs::get_config_dir() + "shaderlog/VertexProgram" + std::to_string(ID) + ".hlsl", fs::rewrite).write(vertexProgramData.content);
 		vertexProgramData.id = (u32)ID;
+		vertexProgramData.Compile(vertexProgramData.content, Shader::SHADER_TYPE::SHADER_TYPE_VERTEX);
+	}
+
+	// D3DCompile is thread-safe, shaders are compiled by decompile_* (possibly on worker threads)
+	static
+	void compile_fragment_program(fragment_program_type& fragmentProgramData, size_t ID)
+	{
+	}
+
+	static
+	void compile_vertex_program(vertex_program_type& vertexProgramData, size_t ID)
+	{
 	}
 
 	static
@@ -323,7 +323,12 @@ void GLGSRender::begin()
 		__glcheck enable(value, GL_CLIP_DISTANCE0 + index);
 	};
 
-	load_program();
+	if (!load_program())
+	{
+		// Program not ready (see shader_miss_policy), end() skips the draw
+		return;
+	}
+
 	set_clip_plane_control(0, rsx::method_registers.clip_plane_0_enabled());
 	set_clip_plane_control(1, rsx::method_registers.clip_plane_1_enabled());
 	set_clip_plane_control(2, rsx::method_registers.clip_plane_2_enabled());
@@ -380,7 +385,7 @@ namespace
 
 void GLGSRender::end()
 {
-	if (!draw_fbo || !draw_fbo.check())
+	if (!draw_fbo || !draw_fbo.check() || !m_program)
 	{
 		rsx::thread::end();
 		return;
@@ -730,7 +735,13 @@ bool GLGSRender::load_program()
 	}
 
 	auto old_program = m_program;
-	m_program = &m_prog_buffer.getGraphicPipelineState(vertex_program, fragment_program, nullptr);
+	m_program = m_prog_buffer.getGraphicPipelineState(vertex_program, fragment_program, nullptr);
+
+	if (!m_program)
+	{
+		return false;
+	}
+
 	m_program->use();
 
 	if (old_program == m_program && !m_transform_constants_dirty)
@@ -960,3 +971,9 @@ bool GLGSRender::on_access_violation(u32 address, bool is_writing)
 	if (is_writing) return m_gl_texture_cache.mark_as_dirty(address);
 	return false;
 }
+
+bool GLGSRender::on_idle()
+{
+	// Compile stored programs and link stored pipelines a few at a time
+	return m_prog_buffer.process_preloaded(4);
+}
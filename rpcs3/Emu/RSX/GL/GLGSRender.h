@@ -90,6 +90,7 @@ protected:
 	u64 timestamp() const override;
 
 	bool on_access_violation(u32 address, bool is_writing) override;
+	bool on_idle() override;
 
 	virtual std::array<std::vector<gsl::byte>, 4> copy_render_targets_to_memory() override;
 	virtual std::array<std::vector<gsl::byte>, 2> copy_depth_stencil_buffer_to_memory() override;
@@ -10,17 +10,29 @@ struct GLTraits
 	using pipeline_storage_type = gl::glsl::program;
 	using pipeline_properties = void*;
 
+	static constexpr u32 pipeline_pack_tag = "GL  "_u32;
+
 	static
-	void recompile_fragment_program(const RSXFragmentProgram &RSXFP, fragment_program_type& fragmentProgramData, size_t ID)
+	void decompile_fragment_program(const RSXFragmentProgram &RSXFP, fragment_program_type& fragmentProgramData, size_t ID)
 	{
 		fragmentProgramData.Decompile(RSXFP);
-		fragmentProgramData.Compile();
 	}
 
 	static
-	void recompile_vertex_program(const RSXVertexProgram &RSXVP, vertex_program_type& vertexProgramData, size_t ID)
+	void decompile_vertex_program(const RSXVertexProgram &RSXVP, vertex_program_type& vertexProgramData, size_t ID)
 	{
 		vertexProgramData.Decompile(RSXVP);
+	}
+
+	static
+	void compile_fragment_program(fragment_program_type& fragmentProgramData, size_t ID)
+	{
+		fragmentProgramData.Compile();
+	}
+
+	static
+	void compile_vertex_program(vertex_program_type& vertexProgramData, size_t ID)
+	{
 		vertexProgramData.Compile();
 	}
 
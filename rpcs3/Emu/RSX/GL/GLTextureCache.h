@@ -12,6 +12,7 @@
 #include "GLGSRender.h"
 #include "GLRenderTargets.h"
 #include "../Common/TextureUtils.h"
+#include "../Common/texture_cache_index.h"
 #include <chrono>
 
 namespace gl
@@ -33,6 +34,7 @@ namespace gl
 			u16 mipmap;
 			bool deleted;
 			bool locked;
+			bool indexed;
 		};
 
 		struct invalid_cache_area
@@ -61,6 +63,8 @@ namespace gl
 	private:
 		std::vector<gl_cached_texture> texture_cache;
 		std::vector<cached_rtt> rtt_cache;
+		rsx::texture_cache_index texture_index; // Protected ranges of texture_cache entries
+		rsx::texture_cache_index rtt_index; // Page-aligned ranges of rtt_cache entries
 		u32 frame_ctr;
 		std::pair<u64, u64> texture_cache_range = std::make_pair(0xFFFFFFFF, 0);
 		u32 max_tex_address = 0;
@@ -89,11 +93,30 @@ namespace gl
 			return vm::page_protect(start, size, 0, vm::page_writable, 0);
 		}
 
+		void index_rtt(cached_rtt &rtt, bool insert)
+		{
+			const u32 id = (u32)(&rtt - rtt_cache.data());
+			const u32 base = rtt.data_addr & ~(4096 - 1);
+			const u32 size = (u32)align(rtt.block_sz + (rtt.data_addr - base), 4096);
+
+			if (insert)
+				rtt_index.insert(id, base, size);
+			else
+				rtt_index.erase(id, base, size);
+		}
+
 		void lock_gl_object(gl_cached_texture &obj)
 		{
 			static const u32 memory_page_size = 4096;
+			const u32 id = (u32)(&obj - texture_cache.data());
+
+			if (obj.indexed)
+				texture_index.erase(id, obj.protected_block_start, obj.protected_block_sz);
+
 			obj.protected_block_start = obj.data_addr & ~(memory_page_size - 1);
 			obj.protected_block_sz = (u32)align(obj.block_sz, memory_page_size);
+			texture_index.insert(id, obj.protected_block_start, obj.protected_block_sz);
+			obj.indexed = true;
 
 			if (!lock_memory_region(obj.protected_block_start, obj.protected_block_sz))
 				LOG_ERROR(RSX, "lock_gl_object failed!");
@@ -111,8 +134,10 @@ namespace gl
 
 		gl_cached_texture *find_obj_for_params(u64 texaddr, u32 w, u32 h, u16 mipmap)
 		{
-			for (gl_cached_texture &tex: texture_cache)
+			for (u32 id : texture_index.find((u32)texaddr, 1))
 			{
+				gl_cached_texture &tex = texture_cache[id];
+
 				if (tex.gl_id && tex.data_addr == texaddr)
 				{
 					if (w && h && mipmap && (tex.h != h || tex.w != w || tex.mipmap != mipmap))
@@ -139,6 +164,7 @@ namespace gl
 			obj.mipmap = mipmap;
 			obj.deleted = false;
 			obj.locked = false;
+			obj.indexed = false;
 
 			for (gl_cached_texture &tex : texture_cache)
 			{
@@ -152,6 +178,9 @@ namespace gl
 						tex.gl_id = 0;
 					}
 
+					if (tex.indexed)
+						texture_index.erase((u32)(&tex - texture_cache.data()), tex.protected_block_start, tex.protected_block_sz);
+
 					tex = obj;
 					return tex;
 				}
@@ -196,6 +225,7 @@ namespace gl
 			}
 
 			texture_cache.resize(0);
+			texture_index.clear();
 			destroy_rtt_cache();
 		}
 
@@ -223,8 +253,10 @@ namespace gl
 
 		cached_rtt* find_cached_rtt(u32 base, u32 size)
 		{
-			for (cached_rtt &rtt : rtt_cache)
+			for (u32 id : rtt_index.find(base, size + 1))
 			{
+				cached_rtt &rtt = rtt_cache[id];
+
 				if (region_overlaps(base, base+size, rtt.data_addr, rtt.data_addr+rtt.block_sz))
 				{
 					return &rtt;
@@ -236,8 +268,10 @@ namespace gl
 
 		void invalidate_rtts_in_range(u32 base, u32 size)
 		{
-			for (cached_rtt &rtt : rtt_cache)
+			for (u32 id : rtt_index.find(base, size + 1))
 			{
+				cached_rtt &rtt = rtt_cache[id];
+
 				if (!rtt.data_addr || rtt.is_dirty) continue;
 
 				u32 rtt_aligned_base = ((u32)(rtt.data_addr)) & ~(4096 - 1);
@@ -325,6 +359,7 @@ namespace gl
 						rtt.block_sz = size;
 						rtt.data_addr = base;
 						rtt.is_dirty = true;
+						index_rtt(rtt, true);
 
 						lock_memory_region((u32)rtt.data_addr, rtt.block_sz);
 						rtt.locked = true;
@@ -346,7 +381,9 @@ namespace gl
 				{
 					unlock_memory_region((u32)region->data_addr, region->block_sz);
 
+					index_rtt(*region, false);
 					region->block_sz = size;
+					index_rtt(*region, true);
 					lock_memory_region((u32)region->data_addr, region->block_sz);
 					region->locked = true;
 				}
@@ -386,6 +423,7 @@ namespace gl
 			}
 
 			rtt_cache.resize(0);
+			rtt_index.clear();
 		}
 
 	public:
@@ -521,8 +559,10 @@ namespace gl
 
 			bool response = false;
 
-			for (gl_cached_texture &tex: texture_cache)
+			for (u32 id : texture_index.find(address, 1))
 			{
+				gl_cached_texture &tex = texture_cache[id];
+
 				if (!tex.locked) continue;
 
 				if (tex.protected_block_start <= address &&
@@ -539,8 +579,10 @@ namespace gl
 
 			if (response) return true;
 
-			for (cached_rtt &rtt: rtt_cache)
+			for (u32 id : rtt_index.find(address, 1))
 			{
+				cached_rtt &rtt = rtt_cache[id];
+
 				if (!rtt.data_addr || rtt.is_dirty) continue;
 
 				u32 rtt_aligned_base = ((u32)(rtt.data_addr)) & ~(4096 - 1);
@@ -576,9 +618,12 @@ namespace gl
 			*/
 
 			std::vector<invalid_cache_area> result;
+			std::vector<std::pair<u32, u32>> unlock_ranges;
 
-			for (gl_cached_texture &obj : texture_cache)
+			for (u32 id : texture_index.find(base, limit >= base ? limit - base + 1 : 1))
 			{
+				gl_cached_texture &obj = texture_cache[id];
+
 				//Check for memory area overlap. unlock page(s) if needed and add this index to array.
 				//Axis separation test
 				const u32 &block_start = obj.protected_block_start;
@@ -621,19 +666,47 @@ namespace gl
 						invalid.block_base = obj.protected_block_start + obj.protected_block_sz - 4096;
 
 					invalid.block_sz = 4096;
-					unlock_memory_region(invalid.block_base, invalid.block_sz);
+					unlock_ranges.emplace_back(invalid.block_base, invalid.block_sz);
 					result.push_back(invalid);
 				}
 			}
 
+			// Bulk update is all or nothing: on failure, unlock the ranges that still can be unlocked
+			if (!unlock_ranges.empty() && !vm::page_protect(unlock_ranges, 0, vm::page_writable, 0))
+			{
+				for (const auto& range : unlock_ranges)
+				{
+					if (!unlock_memory_region(range.first, range.second))
+						LOG_ERROR(RSX, "find_and_invalidate_in_range: failed to unlock 0x%x (size=0x%x)", range.first, range.second);
+				}
+			}
+
 			return result;
 		}
 
 		void lock_invalidated_ranges(std::vector<invalid_cache_area> invalid)
 		{
+			std::vector<std::pair<u32, u32>> ranges;
+
 			for (invalid_cache_area area : invalid)
 			{
-				lock_memory_region(area.block_base, area.block_sz);
+				if (area.block_base < texture_cache_range.first)
+					texture_cache_range = std::make_pair(area.block_base, texture_cache_range.second);
+
+				if ((area.block_base + area.block_sz) > texture_cache_range.second)
+					texture_cache_range = std::make_pair(texture_cache_range.first, (area.block_base + area.block_sz));
+
+				ranges.emplace_back(area.block_base, area.block_sz);
+			}
+
+			// Bulk update is all or nothing: on failure, lock the ranges that still can be locked
+			if (!ranges.empty() && !vm::page_protect(ranges, 0, 0, vm::page_writable))
+			{
+				for (const auto& range : ranges)
+				{
+					if (!vm::page_protect(range.first, range.second, 0, 0, vm::page_writable))
+						LOG_ERROR(RSX, "lock_invalidated_ranges: failed to lock 0x%x (size=0x%x)", range.first, range.second);
+				}
 			}
 		}
 
@@ -641,8 +714,10 @@ namespace gl
 		{
 			//Seems that the rsx only 'reads' full texture objects..
 			//This simplifies this function to simply check for matches
-			for (gl_cached_texture &cached : texture_cache)
+			for (u32 id : texture_index.find(texaddr, 1))
 			{
+				gl_cached_texture &cached = texture_cache[id];
+
 				if (cached.data_addr == texaddr &&
 					cached.block_sz == range)
 					remove_obj(cached);
@@ -447,24 +447,64 @@ namespace rsx
 				LOG_WARNING(RSX, "unaligned command: %s (0x%x from 0x%x)", get_method_name(first_cmd).c_str(), first_cmd, cmd & 0xffff);
 			}
 
-			for (u32 i = 0; i < count; i++)
+			const bool non_increment = (cmd & RSX_METHOD_NON_INCREMENT_CMD_MASK) == RSX_METHOD_NON_INCREMENT_CMD;
+			const be_t<u32>* const data = args.get_ptr();
+
+			for (u32 i = 0; i < count;)
 			{
-				u32 reg = ((cmd & RSX_METHOD_NON_INCREMENT_CMD_MASK) == RSX_METHOD_NON_INCREMENT_CMD) ? first_cmd : first_cmd + i;
-				u32 value = args[i];
+				const u32 reg = non_increment ? first_cmd : first_cmd + i;
+
+				if (UNLIKELY(capture_current_frame))
+				{
+					// Slow path: every method word is recorded
+					const u32 value = data[i++];
 
-				//LOG_NOTICE(RSX, "%s(0x%x) = 0x%x", get_method_name(reg).c_str(), reg, value);
+					method_registers.decode(reg, value);
+					frame_debug.command_queue.push_back(std::make_pair(reg, value));
+
+					if (auto method = methods[reg])
+					{
+						method(this, reg, value);
+					}
 
-				method_registers.decode(reg, value);
+					continue;
+				}
 
-				if (capture_current_frame)
+				if (!non_increment)
 				{
-					frame_debug.command_queue.push_back(std::make_pair(reg, value));
+					if (auto batch = batch_methods[reg])
+					{
+						i += batch(this, reg, data + i, count - i);
+						continue;
+					}
 				}
 
 				if (auto method = methods[reg])
 				{
+					const u32 value = data[i++];
+
+					method_registers.decode(reg, value);
 					method(this, reg, value);
+					continue;
+				}
+
+				if (non_increment)
+				{
+					// Only the last value is observable
+					method_registers.decode(reg, data[count - 1]);
+					break;
+				}
+
+				// Copy the run of registers without handlers at once
+				u32 run = 1;
+
+				while (i + run < count && reg + run < methods.size() && !methods[reg + run] && !batch_methods[reg + run])
+				{
+					run++;
 				}
+
+				method_registers.decode(reg, data + i, run);
+				i += run;
 			}
 
 			ctrl->get = get + (count + 1) * 4;
@@ -688,7 +728,10 @@ namespace rsx
 	{
 		if (m_internal_tasks.empty())
 		{
-			std::this_thread::sleep_for(1ms);
+			if (!on_idle())
+			{
+				std::this_thread::sleep_for(1ms);
+			}
 		}
 		else
 		{
@@ -4,6 +4,8 @@
 #include "../../../../Vulkan/glslang/SPIRV/GlslangToSpv.h"
 #include "define_new_memleakdetect.h"
 
+#include <mutex>
+
 namespace vk
 {
 	std::string getFloatTypeNameImpl(size_t elementCount)
@@ -278,11 +280,46 @@ namespace vk
 		fmt::throw_exception("Unknown register name: %s" HERE, name);
 	}
 
+	// glslang keeps a pool allocator per thread: initialise it once in every compiling thread (RSX thread and decompiler workers).
+	// Shared tables are only released when the last such thread exits.
+	struct glslang_thread_guard
+	{
+		static std::mutex& mutex()
+		{
+			static std::mutex s_mutex;
+			return s_mutex;
+		}
+
+		static u32& count()
+		{
+			static u32 s_count = 0;
+			return s_count;
+		}
+
+		glslang_thread_guard()
+		{
+			std::lock_guard<std::mutex> lock(mutex());
+			glslang::InitializeProcess();
+			count()++;
+		}
+
+		~glslang_thread_guard()
+		{
+			std::lock_guard<std::mutex> lock(mutex());
+
+			if (--count() == 0)
+			{
+				glslang::FinalizeProcess();
+			}
+		}
+	};
+
 	bool compile_glsl_to_spv(std::string& shader, glsl::program_domain domain, std::vector<u32>& spv)
 	{
 		EShLanguage lang = (domain == glsl::glsl_fragment_program) ? EShLangFragment : EShLangVertex;
 
-		glslang::InitializeProcess();
+		static thread_local glslang_thread_guard s_glslang;
+
 		glslang::TProgram program;
 		glslang::TShader shader_object(lang);
 		
@@ -311,7 +348,6 @@ namespace vk
 			LOG_ERROR(RSX, "%s", shader_object.getInfoDebugLog());
 		}
 
-		glslang::FinalizeProcess();
 		return success;
 	}
 }
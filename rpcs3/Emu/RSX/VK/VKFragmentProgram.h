@@ -37,7 +37,7 @@ protected:
 };
 
 /** Storage for an Fragment Program in the process of of recompilation.
- *  This class calls OpenGL functions and should only be used from the RSX/Graphics thread.
+ *  Decompile() and Compile() may run on decompiler worker threads, Delete() needs the device to be alive.
  */
 class VKFragmentProgram
 {
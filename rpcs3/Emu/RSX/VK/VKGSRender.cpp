@@ -607,14 +607,6 @@ VKGSRender::~VKGSRender()
 	delete m_swap_chain;
 }
 
-bool VKGSRender::on_access_violation(u32 address, bool is_writing)
-{
-	if (is_writing)
-		return m_texture_cache.invalidate_address(address);
-
-	return false;
-}
-
 void VKGSRender::begin()
 {
 	rsx::thread::begin();
@@ -658,7 +650,11 @@ void VKGSRender::begin()
 	init_buffers();
 
 	if (!load_program())
+	{
+		// Program not ready (see shader_miss_policy), end() skips the draw
+		m_used_descriptors++;
 		return;
+	}
 
 	float actual_line_width = rsx::method_registers.line_width();
 
@@ -675,6 +671,12 @@ void VKGSRender::begin()
 
 void VKGSRender::end()
 {
+	if (!m_program)
+	{
+		rsx::thread::end();
+		return;
+	}
+
 	size_t idx = vk::get_render_pass_location(
 		vk::get_compatible_surface_format(rsx::method_registers.surface_color()).first,
 		vk::get_compatible_depth_surface_format(m_optimal_tiling_supported_formats, rsx::method_registers.surface_depth_fmt()),
@@ -962,6 +964,12 @@ void VKGSRender::sync_at_semaphore_release()
 	open_command_buffer();
 }
 
+bool VKGSRender::on_idle()
+{
+	// Prebuild pipelines stored by previous runs a few at a time
+	return m_prog_buffer.process_preloaded(4, *m_device, pipeline_layout, m_render_passes.data());
+}
+
 bool VKGSRender::do_method(u32 cmd, u32 arg)
 {
 	switch (cmd)
@@ -1063,7 +1071,6 @@ bool VKGSRender::load_program()
 	
 	properties.cs.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
 	properties.cs.attachmentCount = m_draw_buffers_count;
-	properties.cs.pAttachments = properties.att_state;
 	
 	if (rsx::method_registers.logic_op_enabled())
 	{
@@ -1133,12 +1140,20 @@ bool VKGSRender::load_program()
 		vk::get_compatible_depth_surface_format(m_optimal_tiling_supported_formats, rsx::method_registers.surface_depth_fmt()),
 		(u8)vk::get_draw_buffers(rsx::method_registers.surface_color_target()).size());
 	
-	properties.render_pass = m_render_passes[idx];
+	properties.render_pass_location = (u32)idx;
 
 	properties.num_targets = m_draw_buffers_count;
 
 	//Load current program from buffer
-	m_program = m_prog_buffer.getGraphicPipelineState(vertex_program, fragment_program, properties, *m_device, pipeline_layout).get();
+	auto pipeline = m_prog_buffer.getGraphicPipelineState(vertex_program, fragment_program, properties, *m_device, pipeline_layout, m_render_passes.data());
+
+	if (!pipeline)
+	{
+		m_program = nullptr;
+		return false;
+	}
+
+	m_program = pipeline->get();
 
 	//TODO: Update constant buffers..
 	//1. Update scale-offset matrix
@@ -113,6 +113,6 @@ protected:
 	void on_exit() override;
 	bool do_method(u32 id, u32 arg) override;
 	void flip(int buffer) override;
+	bool on_idle() override;
 
-	bool on_access_violation(u32 address, bool is_writing) override;
 };
@@ -13,8 +13,8 @@ namespace vk
 		VkPipelineColorBlendAttachmentState att_state[4];
 		VkPipelineColorBlendStateCreateInfo cs;
 		VkPipelineRasterizationStateCreateInfo rs;
-		
-		VkRenderPass render_pass;
+
+		u32 render_pass_location; // Index of the render pass (see vk::get_render_pass_location), cs.pAttachments is set by build_pipeline
 		int num_targets;
 
 		bool operator==(const pipeline_props& other) const
@@ -29,7 +29,7 @@ namespace vk
 				return false;
 			if (memcmp(&rs, &other.rs, sizeof(VkPipelineRasterizationStateCreateInfo)))
 				return false;
-			if (render_pass != other.render_pass)
+			if (render_pass_location != other.render_pass_location)
 				return false;
 
 			return num_targets == other.num_targets;
@@ -55,7 +55,7 @@ namespace std
 	template <>
 	struct hash<vk::pipeline_props> {
 		size_t operator()(const vk::pipeline_props &pipelineProperties) const {
-			size_t seed = hash<unsigned>()(pipelineProperties.num_targets);
+			size_t seed = hash<unsigned>()(pipelineProperties.num_targets) ^ hash<unsigned>()(pipelineProperties.render_pass_location);
 			seed ^= hash_struct(pipelineProperties.ia);
 			seed ^= hash_struct(pipelineProperties.ds);
 			seed ^= hash_struct(pipelineProperties.rs);
@@ -73,22 +73,39 @@ struct VKTraits
 	using pipeline_storage_type = std::unique_ptr<vk::glsl::program>;
 	using pipeline_properties = vk::pipeline_props;
 
+	static constexpr u32 pipeline_pack_tag = "VK  "_u32;
+
+	// SPIR-V generation and vkCreateShaderModule don't need the RSX thread, so programs are compiled by the decompiler too
 	static
-	void recompile_fragment_program(const RSXFragmentProgram &RSXFP, fragment_program_type& fragmentProgramData, size_t ID)
+	void decompile_fragment_program(const RSXFragmentProgram &RSXFP, fragment_program_type& fragmentProgramData, size_t ID)
 	{
 		fragmentProgramData.Decompile(RSXFP);
+		fs::create_path(fs::get_config_dir() + "/shaderlog");
+		fs::file(fs::get_config_dir() + "shaderlog/FragmentProgram" + std::to_string(ID) + ".spirv", fs::rewrite).write(fragmentProgramData.shader);
 		fragmentProgramData.Compile();
 	}
 
 	static
-	void recompile_vertex_program(const RSXVertexProgram &RSXVP, vertex_program_type& vertexProgramData, size_t ID)
+	void decompile_vertex_program(const RSXVertexProgram &RSXVP, vertex_program_type& vertexProgramData, size_t ID)
 	{
 		vertexProgramData.Decompile(RSXVP);
+		fs::create_path(fs::get_config_dir() + "/shaderlog");
+		fs::file(fs::get_config_dir() + "shaderlog/VertexProgram" + std::to_string(ID) + ".spirv", fs::rewrite).write(vertexProgramData.shader);
 		vertexProgramData.Compile();
 	}
 
 	static
-	pipeline_storage_type build_pipeline(const vertex_program_type &vertexProgramData, const fragment_program_type &fragmentProgramData, const vk::pipeline_props &pipelineProperties, VkDevice dev, VkPipelineLayout common_pipeline_layout)
+	void compile_fragment_program(fragment_program_type& fragmentProgramData, size_t ID)
+	{
+	}
+
+	static
+	void compile_vertex_program(vertex_program_type& vertexProgramData, size_t ID)
+	{
+	}
+
+	static
+	pipeline_storage_type build_pipeline(const vertex_program_type &vertexProgramData, const fragment_program_type &fragmentProgramData, const vk::pipeline_props &pipelineProperties, VkDevice dev, VkPipelineLayout common_pipeline_layout, const VkRenderPass* render_passes)
 	{
 //		pstate.dynamic_state.pDynamicStates = pstate.dynamic_state_descriptors;
 //		pstate.cb.pAttachments = pstate.att_state;
@@ -131,7 +148,10 @@ struct VKTraits
 		info.pVertexInputState = &vi;
 		info.pInputAssemblyState = &pipelineProperties.ia;
 		info.pRasterizationState = &pipelineProperties.rs;
-		info.pColorBlendState = &pipelineProperties.cs;
+		VkPipelineColorBlendStateCreateInfo cs = pipelineProperties.cs;
+		cs.pAttachments = pipelineProperties.att_state;
+
+		info.pColorBlendState = &cs;
 		info.pMultisampleState = &ms;
 		info.pViewportState = &vp;
 		info.pDepthStencilState = &pipelineProperties.ds;
@@ -141,7 +161,7 @@ struct VKTraits
 		info.layout = common_pipeline_layout;
 		info.basePipelineIndex = -1;
 		info.basePipelineHandle = VK_NULL_HANDLE;
-		info.renderPass = pipelineProperties.render_pass;
+		info.renderPass = render_passes[pipelineProperties.render_pass_location];
 
 		CHECK_RESULT(vkCreateGraphicsPipelines(dev, nullptr, 1, &info, NULL, &pipeline));
 
@@ -157,7 +177,6 @@ public:
 	void clear()
 	{
 		program_state_cache<VKTraits>::clear();
-		m_vertex_shader_cache.clear();
-		m_fragment_shader_cache.clear();
+		clear_programs();
 	}
 };
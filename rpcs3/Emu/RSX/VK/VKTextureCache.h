@@ -3,6 +3,7 @@
 #include "VKRenderTargets.h"
 #include "VKGSRender.h"
 #include "../Common/TextureUtils.h"
+#include "../Common/texture_cache_index.h"
 
 namespace vk
 {
@@ -20,38 +21,21 @@ namespace vk
 
 		u64  protected_rgn_start;
 		u64  protected_rgn_end;
+		u64  write_gen; // Write watch generation of the guest memory at upload
 		
 		bool exists = false;
-		bool locked = false;
 		bool dirty = true;
+		bool indexed = false;
 	};
 
 	class texture_cache
 	{
 	private:
 		std::vector<cached_texture_object> m_cache;
-		std::pair<u64, u64> texture_cache_range = std::make_pair(0xFFFFFFFF, 0);
+		rsx::texture_cache_index m_cache_index; // Watched ranges of m_cache entries
 		std::vector<std::unique_ptr<vk::image_view> > m_temporary_image_view;
 		std::vector<std::unique_ptr<vk::image>> m_dirty_textures;
 
-		bool lock_memory_region(u32 start, u32 size)
-		{
-			static const u32 memory_page_size = 4096;
-			start = start & ~(memory_page_size - 1);
-			size = (u32)align(size, memory_page_size);
-
-			return vm::page_protect(start, size, 0, 0, vm::page_writable);
-		}
-
-		bool unlock_memory_region(u32 start, u32 size)
-		{
-			static const u32 memory_page_size = 4096;
-			start = start & ~(memory_page_size - 1);
-			size = (u32)align(size, memory_page_size);
-
-			return vm::page_protect(start, size, 0, vm::page_writable, 0);
-		}
-
 		bool region_overlaps(u32 base1, u32 limit1, u32 base2, u32 limit2)
 		{
 			//Check for memory area overlap. unlock page(s) if needed and add this index to array.
@@ -74,11 +58,27 @@ namespace vk
 			return false;
 		}
 
+		// Mark the object dirty if its guest memory was written since upload
+		bool check_written(cached_texture_object &obj)
+		{
+			if (!obj.dirty && vm::page_written_since((u32)obj.protected_rgn_start, (u32)(obj.protected_rgn_end - obj.protected_rgn_start), obj.write_gen))
+			{
+				unindex_object(obj);
+
+				obj.native_rsx_address = 0;
+				obj.dirty = true;
+			}
+
+			return obj.dirty;
+		}
+
 		cached_texture_object& find_cached_texture(u32 rsx_address, u32 rsx_size, bool confirm_dimensions = false, u16 width = 0, u16 height = 0, u16 mipmaps = 0)
 		{
-			for (cached_texture_object &tex : m_cache)
+			for (u32 id : m_cache_index.find(rsx_address, 1))
 			{
-				if (!tex.dirty && tex.exists &&
+				cached_texture_object &tex = m_cache[id];
+
+				if (!check_written(tex) && tex.exists &&
 					tex.native_rsx_address == rsx_address &&
 					tex.native_rsx_size == rsx_size)
 				{
@@ -96,7 +96,7 @@ namespace vk
 
 			for (cached_texture_object &tex : m_cache)
 			{
-				if (tex.dirty)
+				if (check_written(tex))
 				{
 					if (tex.exists)
 					{
@@ -113,25 +113,25 @@ namespace vk
 			return m_cache[m_cache.size() - 1];
 		}
 
-		void lock_object(cached_texture_object &obj)
+		void index_object(cached_texture_object &obj)
 		{
 			static const u32 memory_page_size = 4096;
+
+			if (obj.indexed) unindex_object(obj);
+
 			obj.protected_rgn_start = obj.native_rsx_address & ~(memory_page_size - 1);
 			obj.protected_rgn_end = (u32)align(obj.native_rsx_size, memory_page_size);
 			obj.protected_rgn_end += obj.protected_rgn_start;
 
-			lock_memory_region(static_cast<u32>(obj.protected_rgn_start), static_cast<u32>(obj.native_rsx_size));
-			
-			if (obj.protected_rgn_start < texture_cache_range.first)
-				texture_cache_range = std::make_pair(obj.protected_rgn_start, texture_cache_range.second);
-
-			if (obj.protected_rgn_end > texture_cache_range.second)
-				texture_cache_range = std::make_pair(texture_cache_range.first, obj.protected_rgn_end);
+			m_cache_index.insert((u32)(&obj - m_cache.data()), (u32)obj.protected_rgn_start, (u32)(obj.protected_rgn_end - obj.protected_rgn_start));
+			obj.indexed = true;
 		}
 
-		void unlock_object(cached_texture_object &obj)
+		void unindex_object(cached_texture_object &obj)
 		{
-			unlock_memory_region(static_cast<u32>(obj.protected_rgn_start), static_cast<u32>(obj.native_rsx_size));
+			// The range is the same as registered in index_object() (protected_rgn_* are only updated there)
+			m_cache_index.erase((u32)(&obj - m_cache.data()), (u32)obj.protected_rgn_start, (u32)(obj.protected_rgn_end - obj.protected_rgn_start));
+			obj.indexed = false;
 		}
 
 		void purge_cache()
@@ -140,15 +140,13 @@ namespace vk
 			{
 				if (tex.exists)
 					m_dirty_textures.push_back(std::move(tex.uploaded_texture));
-
-				if (tex.locked)
-					unlock_object(tex);
 			}
 
 			m_temporary_image_view.clear();
 			m_dirty_textures.clear();
 
 			m_cache.resize(0);
+			m_cache_index.clear();
 		}
 
 		//Helpers
@@ -205,6 +203,9 @@ namespace vk
 			u32 raw_format = tex.format();
 			u32 format = raw_format & ~(CELL_GCM_TEXTURE_LN | CELL_GCM_TEXTURE_UN);
 
+			// Arm write watch before reading guest memory, writes during upload are detected later
+			const u64 write_gen = vm::page_watch(texaddr, range);
+
 			VkComponentMapping mapping = get_component_map(tex, format);
 			VkFormat vk_format = get_compatible_sampler_format(format);
 
@@ -278,37 +279,13 @@ namespace vk
 			cto.width = tex.width();
 			cto.height = tex.height();
 			cto.mipmaps = tex.get_exact_mipmap_count();
+			cto.write_gen = write_gen;
 			
-			lock_object(cto);
+			index_object(cto);
 
 			return cto.uploaded_image_view.get();
 		}
 
-		bool invalidate_address(u32 rsx_address)
-		{
-			if (rsx_address < texture_cache_range.first ||
-				rsx_address > texture_cache_range.second)
-				return false;
-
-			for (cached_texture_object &tex : m_cache)
-			{
-				if (tex.dirty) continue;
-
-				if (rsx_address >= tex.protected_rgn_start &&
-					rsx_address < tex.protected_rgn_end)
-				{
-					unlock_object(tex);
-
-					tex.native_rsx_address = 0;
-					tex.dirty = true;
-
-					return true;
-				}
-			}
-
-			return false;
-		}
-
 		void flush()
 		{
 			m_dirty_textures.clear();
@@ -28,6 +28,7 @@ namespace rsx
 	rsx_state method_registers;
 	
 	std::array<rsx_method_t, 0x10000 / 4> methods{};
+	std::array<rsx_method_batch_t, 0x10000 / 4> batch_methods{};
 
 	[[noreturn]] void invalid_method(thread*, u32 _reg, u32 arg)
 	{
@@ -105,13 +106,13 @@ namespace rsx
 				(arg & 0xff00ff00) | ((arg & 0xff) << 16) | ((arg >> 16) & 0xff));
 		}
 
-		template<u32 id, u32 index, int count, typename type>
-		void set_vertex_data_impl(thread* rsx, u32 arg)
+		template<int count, typename type>
+		void set_vertex_data_impl(u32 index, u32 arg)
 		{
 			static const size_t increment_per_array_index = (count * sizeof(type)) / sizeof(u32);
 
-			static const size_t attribute_index = index / increment_per_array_index;
-			static const size_t vertex_subreg = index % increment_per_array_index;
+			const size_t attribute_index = index / increment_per_array_index;
+			const size_t vertex_subreg = index % increment_per_array_index;
 
 			auto& info = rsx::method_registers.register_vertex_info[attribute_index];
 
@@ -119,7 +120,23 @@ namespace rsx
 			info.size = count;
 			info.frequency = 0;
 			info.stride = 0;
-			rsx::method_registers.register_vertex_info[attribute_index].data[vertex_subreg] = arg;
+			info.data[vertex_subreg] = arg;
+		}
+
+		template<u32 id, u32 range, int count, typename type>
+		u32 set_vertex_data_batch(thread* rsx, u32 reg, const be_t<u32>* args, u32 num)
+		{
+			const u32 index = reg - id;
+			const u32 run = std::min(num, range - index);
+
+			method_registers.decode(reg, args, run);
+
+			for (u32 i = 0; i < run; i++)
+			{
+				set_vertex_data_impl<count, type>(index + i, args[i]);
+			}
+
+			return run;
 		}
 
 		template<u32 index>
@@ -127,7 +144,7 @@ namespace rsx
 		{
 			static void impl(thread* rsx, u32 _reg, u32 arg)
 			{
-				set_vertex_data_impl<NV4097_SET_VERTEX_DATA4UB_M, index, 4, u8>(rsx, arg);
+				set_vertex_data_impl<4, u8>(index, arg);
 			}
 		};
 
@@ -136,7 +153,7 @@ namespace rsx
 		{
 			static void impl(thread* rsx, u32 _reg, u32 arg)
 			{
-				set_vertex_data_impl<NV4097_SET_VERTEX_DATA1F_M, index, 1, f32>(rsx, arg);
+				set_vertex_data_impl<1, f32>(index, arg);
 			}
 		};
 
@@ -145,7 +162,7 @@ namespace rsx
 		{
 			static void impl(thread* rsx, u32 _reg, u32 arg)
 			{
-				set_vertex_data_impl<NV4097_SET_VERTEX_DATA2F_M, index, 2, f32>(rsx, arg);
+				set_vertex_data_impl<2, f32>(index, arg);
 			}
 		};
 
@@ -154,7 +171,7 @@ namespace rsx
 		{
 			static void impl(thread* rsx, u32 _reg, u32 arg)
 			{
-				set_vertex_data_impl<NV4097_SET_VERTEX_DATA3F_M, index, 3, f32>(rsx, arg);
+				set_vertex_data_impl<3, f32>(index, arg);
 			}
 		};
 
@@ -163,7 +180,7 @@ namespace rsx
 		{
 			static void impl(thread* rsx, u32 _reg, u32 arg)
 			{
-				set_vertex_data_impl<NV4097_SET_VERTEX_DATA4F_M, index, 4, f32>(rsx, arg);
+				set_vertex_data_impl<4, f32>(index, arg);
 			}
 		};
 
@@ -172,7 +189,7 @@ namespace rsx
 		{
 			static void impl(thread* rsx, u32 _reg, u32 arg)
 			{
-				set_vertex_data_impl<NV4097_SET_VERTEX_DATA2S_M, index, 2, u16>(rsx, arg);
+				set_vertex_data_impl<2, u16>(index, arg);
 			}
 		};
 
@@ -181,7 +198,7 @@ namespace rsx
 		{
 			static void impl(thread* rsx, u32 _reg, u32 arg)
 			{
-				set_vertex_data_impl<NV4097_SET_VERTEX_DATA4S_M, index, 4, u16>(rsx, arg);
+				set_vertex_data_impl<4, u16>(index, arg);
 			}
 		};
 
@@ -223,6 +240,32 @@ namespace rsx
 			}
 		};
 
+		u32 set_transform_constant_batch(thread* rsxthr, u32 reg, const be_t<u32>* args, u32 count)
+		{
+			const u32 index = reg - NV4097_SET_TRANSFORM_CONSTANT;
+			const u32 run = std::min(count, 32 - index);
+
+			method_registers.decode(reg, args, run);
+
+			const u32 load = rsx::method_registers.transform_constant_load();
+
+			for (u32 i = index; i < index + run;)
+			{
+				// Update each constant once
+				auto& constant = rsx::method_registers.transform_constants[load + i / 4];
+
+				do
+				{
+					const u32 arg = args[i - index];
+					constant.rgba[i % 4] = (f32&)arg;
+				}
+				while (++i % 4 && i < index + run);
+			}
+
+			rsxthr->m_transform_constants_dirty = true;
+			return run;
+		}
+
 		template<u32 index>
 		struct set_transform_program
 		{
@@ -634,10 +677,7 @@ namespace rsx
 				u16 sw_width = 1 << sw_width_log2;
 				u16 sw_height = 1 << sw_height_log2;
 
-				temp2.reset(new u8[out_bpp * sw_width * sw_height]);
-
 				u8* linear_pixels = pixels_src;
-				u8* swizzled_pixels = temp2.get();
 
 				// Check and pad texture out if we are given non square texture for swizzle to be correct
 				if (sw_width != out_w || sw_height != out_h)
@@ -660,20 +700,28 @@ namespace rsx
 					linear_pixels = sw_temp.get();
 				}
 
+				// Swizzle straight into the destination unless the source overlaps it
+				const u32 sw_size = out_bpp * sw_width * sw_height;
+
+				if (linear_pixels < pixels_dst + sw_size && pixels_dst < linear_pixels + sw_size)
+				{
+					sw_temp.reset(new u8[sw_size]);
+					std::memcpy(sw_temp.get(), linear_pixels, sw_size);
+					linear_pixels = sw_temp.get();
+				}
+
 				switch (out_bpp)
 				{
 				case 1:
-					convert_linear_swizzle<u8>(linear_pixels, swizzled_pixels, sw_width, sw_height, false);
+					convert_linear_swizzle<u8>(linear_pixels, pixels_dst, sw_width, sw_height, false);
 					break;
 				case 2:
-					convert_linear_swizzle<u16>(linear_pixels, swizzled_pixels, sw_width, sw_height, false);
+					convert_linear_swizzle<u16>(linear_pixels, pixels_dst, sw_width, sw_height, false);
 					break;
 				case 4:
-					convert_linear_swizzle<u32>(linear_pixels, swizzled_pixels, sw_width, sw_height, false);
+					convert_linear_swizzle<u32>(linear_pixels, pixels_dst, sw_width, sw_height, false);
 					break;
 				}
-
-				std::memcpy(pixels_dst, swizzled_pixels, out_bpp * sw_width * sw_height);
 			}
 		}
 	}
@@ -893,6 +941,14 @@ namespace rsx
 		registers[reg] = value;
 	}
 
+	void rsx_state::decode(u32 reg, const be_t<u32>* values, u32 count)
+	{
+		for (u32 i = 0; i < count; i++)
+		{
+			registers[reg + i] = values[i];
+		}
+	}
+
 	namespace method_detail
 	{
 		template<int Id, int Step, int Count, template<u32> class T, int Index = 0>
@@ -933,6 +989,15 @@ namespace rsx
 				methods[i] = Func;
 			}
 		}
+
+		template<int Id, int Count, rsx_method_batch_t Func>
+		static void bind_batch()
+		{
+			for (int i = Id; i < Id + Count; i++)
+			{
+				batch_methods[i] = Func;
+			}
+		}
 	}
 
 	// TODO: implement this as virtual function: rsx::thread::init_methods() or something
@@ -1290,6 +1355,14 @@ namespace rsx
 		bind_range<NV4097_SET_VERTEX_DATA2S_M, 1, 16, nv4097::set_vertex_data2s_m>();
 		bind_range<NV4097_SET_VERTEX_DATA4S_M, 1, 32, nv4097::set_vertex_data4s_m>();
 		bind_range<NV4097_SET_TRANSFORM_CONSTANT, 1, 32, nv4097::set_transform_constant>();
+		bind_batch<NV4097_SET_VERTEX_DATA4UB_M, 16, nv4097::set_vertex_data_batch<NV4097_SET_VERTEX_DATA4UB_M, 16, 4, u8>>();
+		bind_batch<NV4097_SET_VERTEX_DATA1F_M, 16, nv4097::set_vertex_data_batch<NV4097_SET_VERTEX_DATA1F_M, 16, 1, f32>>();
+		bind_batch<NV4097_SET_VERTEX_DATA2F_M, 32, nv4097::set_vertex_data_batch<NV4097_SET_VERTEX_DATA2F_M, 32, 2, f32>>();
+		bind_batch<NV4097_SET_VERTEX_DATA3F_M, 48, nv4097::set_vertex_data_batch<NV4097_SET_VERTEX_DATA3F_M, 48, 3, f32>>();
+		bind_batch<NV4097_SET_VERTEX_DATA4F_M, 64, nv4097::set_vertex_data_batch<NV4097_SET_VERTEX_DATA4F_M, 64, 4, f32>>();
+		bind_batch<NV4097_SET_VERTEX_DATA2S_M, 16, nv4097::set_vertex_data_batch<NV4097_SET_VERTEX_DATA2S_M, 16, 2, u16>>();
+		bind_batch<NV4097_SET_VERTEX_DATA4S_M, 32, nv4097::set_vertex_data_batch<NV4097_SET_VERTEX_DATA4S_M, 32, 4, u16>>();
+		bind_batch<NV4097_SET_TRANSFORM_CONSTANT, 32, nv4097::set_transform_constant_batch>();
 		bind_range<NV4097_SET_TRANSFORM_PROGRAM + 3, 4, 128, nv4097::set_transform_program>();
 		bind<NV4097_GET_REPORT, nv4097::get_report>();
 		bind<NV4097_CLEAR_REPORT_VALUE, nv4097::clear_report_value>();
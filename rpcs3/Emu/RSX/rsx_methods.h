@@ -47,6 +47,9 @@ namespace rsx
 
 	using rsx_method_t = void(*)(class thread*, u32 reg, u32 arg);
 
+	// Handler for a run of consecutive method words, returns the number of words processed (at least 1)
+	using rsx_method_batch_t = u32(*)(class thread*, u32 reg, const be_t<u32>* args, u32 count);
+
 	//TODO
 	union alignas(4) method_registers_t
 	{
@@ -180,6 +183,9 @@ namespace rsx
 
 		void decode(u32 reg, u32 value);
 
+		// Decode a run of consecutive registers (no side effects)
+		void decode(u32 reg, const be_t<u32>* values, u32 count);
+
 		void reset();
 
 		template<typename Archive>
@@ -1144,4 +1150,5 @@ namespace rsx
 
 	extern rsx_state method_registers;
 	extern std::array<rsx_method_t, 0x10000 / 4> methods;
+	extern std::array<rsx_method_batch_t, 0x10000 / 4> batch_methods;
 }
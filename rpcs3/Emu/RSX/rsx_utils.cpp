@@ -3,6 +3,12 @@
 #include "rsx_methods.h"
 #include "Emu/RSX/GCM.h"
 #include "Common/BufferUtils.h"
+#include "Emu/System.h"
+#include "Emu/IdManager.h"
+#include "Utilities/Thread.h"
+
+#include <condition_variable>
+#include <thread>
 
 extern "C"
 {
@@ -11,6 +17,109 @@ extern "C"
 
 namespace rsx
 {
+	// Worker threads for heavy texture conversions (one job at a time, the submitting thread takes part in it)
+	class texture_worker_pool
+	{
+		std::mutex m_submit_mutex;
+		std::mutex m_mutex;
+		std::condition_variable m_done_cv;
+		const std::function<void(u32)>* m_task = nullptr;
+		u32 m_count = 0;
+		u32 m_next = 0;
+		u32 m_done = 0;
+		std::vector<std::shared_ptr<thread_ctrl>> m_workers;
+		atomic_t<bool> m_exit{false};
+
+		// Run tasks of the current job until there is none left
+		void work()
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+
+			while (m_next < m_count)
+			{
+				const u32 index = m_next++;
+				const auto task = m_task;
+				lock.unlock();
+				(*task)(index);
+				lock.lock();
+
+				if (++m_done == m_count)
+				{
+					m_done_cv.notify_all();
+				}
+			}
+		}
+
+	public:
+		texture_worker_pool()
+		{
+			m_workers.resize(std::min<u32>(std::max<u32>(std::thread::hardware_concurrency(), 2) - 1, 4));
+
+			for (u32 i = 0; i < m_workers.size(); i++)
+			{
+				thread_ctrl::spawn(m_workers[i], fmt::format("RSX Texture Worker %u", i), [this]()
+				{
+					while (!m_exit && !Emu.IsStopped())
+					{
+						work();
+						thread_ctrl::wait_for(10000);
+					}
+				});
+			}
+		}
+
+		void run(u32 count, const std::function<void(u32)>& task)
+		{
+			std::lock_guard<std::mutex> submit(m_submit_mutex);
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_task = &task;
+				m_count = count;
+				m_next = 0;
+				m_done = 0;
+			}
+
+			for (const auto& worker : m_workers)
+			{
+				worker->notify();
+			}
+
+			work();
+
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_done_cv.wait(lock, [&] { return m_done == m_count; });
+			m_task = nullptr;
+			m_count = 0;
+			m_next = 0;
+		}
+
+		~texture_worker_pool()
+		{
+			m_exit = true;
+
+			for (const auto& worker : m_workers)
+			{
+				worker->notify();
+				worker->join();
+			}
+		}
+	};
+
+	void run_parallel_tasks(u32 count, const std::function<void(u32)>& task)
+	{
+		if (count <= 1)
+		{
+			for (u32 i = 0; i < count; i++)
+			{
+				task(i);
+			}
+
+			return;
+		}
+
+		fxm::get_always<texture_worker_pool>()->run(count, task);
+	}
+
 	void convert_scale_image(u8 *dst, AVPixelFormat dst_format, int dst_width, int dst_height, int dst_pitch,
 		const u8 *src, AVPixelFormat src_format, int src_width, int src_height, int src_pitch, int src_slice_h, bool bilinear)
 	{
@@ -34,76 +34,265 @@ namespace rsx
 	*       - Input can be swizzled or linear, bool flag handles conversion to and from
 	*       - It will handle any width and height that are a power of 2, square or non square
 	*	 Restriction: It has mixed results if the height or width is not a power of 2
+	*
+	*   Swizzled offset interleaves x (even bits) and y (odd bits) up to the smaller dimension, the rest of the larger one is stored above.
+	*   So every aligned 4x4 tile is 16 consecutive texels, which are reordered with SSE shuffles.
 	*/
-	template<typename T>
-	void convert_linear_swizzle(void* input_pixels, void* output_pixels, u16 width, u16 height, bool input_is_swizzled)
+
+	// Spread the lower 16 bits of the value to the even bits of the result
+	static inline u32 spread_bits(u32 value)
+	{
+		value = (value | (value << 8)) & 0x00ff00ff;
+		value = (value | (value << 4)) & 0x0f0f0f0f;
+		value = (value | (value << 2)) & 0x33333333;
+		value = (value | (value << 1)) & 0x55555555;
+		return value;
+	}
+
+	// Get the swizzled index of the texel, log2_min is ceil_log2 of the smaller dimension
+	static inline u32 get_swizzled_offset(u32 x, u32 y, u32 log2_min)
+	{
+		const u32 mask = (1u << log2_min) - 1;
+		return spread_bits(x & mask) | (spread_bits(y & mask) << 1) | ((x | y) >> log2_min << log2_min << log2_min);
+	}
+
+	template<u32 Size, bool swap_bytes>
+	inline void copy_texel(u8* dst, const u8* src)
+	{
+		if (swap_bytes)
+		{
+			std::reverse_copy(src, src + Size, dst);
+		}
+		else
+		{
+			std::memcpy(dst, src, Size);
+		}
+	}
+
+	// Reorder a 4x4 tile between linear (pitch in bytes) and swizzled layouts.
+	// Swizzled index has x0, y0, x1, y1 bits, linear index has x0, x1, y0, y1 bits: the permutation is its own inverse.
+	template<u32 Size, bool swap_bytes>
+	struct swizzle_tile
 	{
-		u32 log2width = ceil_log2(width);
-		u32 log2height = ceil_log2(height);
+		static void to_linear(const u8* src, u8* dst, u32 pitch)
+		{
+			for (u32 i = 0; i < 16; i++)
+			{
+				copy_texel<Size, swap_bytes>(dst + (((i >> 1) & 1) | ((i >> 2) & 2)) * pitch + ((i & 1) | ((i >> 1) & 2)) * Size, src + i * Size);
+			}
+		}
 
-		// Max mask possible for square texture
-		u32 x_mask = 0x55555555;
-		u32 y_mask = 0xAAAAAAAA;
+		static void to_swizzled(const u8* src, u32 pitch, u8* dst)
+		{
+			for (u32 i = 0; i < 16; i++)
+			{
+				copy_texel<Size, swap_bytes>(dst + i * Size, src + (((i >> 1) & 1) | ((i >> 2) & 2)) * pitch + ((i & 1) | ((i >> 1) & 2)) * Size);
+			}
+		}
+	};
 
-		// We have to limit the masks to the lower of the two dimensions to allow for non-square textures
-		u32 limit_mask = (log2width < log2height) ? log2width : log2height;
-		// double the limit mask to account for bits in both x and y
-		limit_mask = 1 << (limit_mask << 1);
+	template<bool swap_bytes>
+	struct swizzle_tile<1, swap_bytes>
+	{
+		static __m128i shuffle(__m128i v)
+		{
+			v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(3, 1, 2, 0));
+			return _mm_shufflehi_epi16(v, _MM_SHUFFLE(3, 1, 2, 0));
+		}
 
-		//x_mask, bits above limit are 1's for x-carry
-		x_mask = (x_mask | ~(limit_mask - 1));
-		//y_mask. bits above limit are 0'd, as we use a different method for y-carry over
-		y_mask = (y_mask & (limit_mask - 1));
+		static void to_linear(const u8* src, u8* dst, u32 pitch)
+		{
+			const __m128i v = shuffle(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)));
+			const u32 rows[4] = { (u32)_mm_cvtsi128_si32(v), (u32)_mm_cvtsi128_si32(_mm_srli_si128(v, 4)), (u32)_mm_cvtsi128_si32(_mm_srli_si128(v, 8)), (u32)_mm_cvtsi128_si32(_mm_srli_si128(v, 12)) };
 
-		u32 offs_y = 0;
-		u32 offs_x = 0;
-		u32 offs_x0 = 0; //total y-carry offset for x
-		u32 y_incr = limit_mask;
+			for (u32 i = 0; i < 4; i++)
+			{
+				std::memcpy(dst + i * pitch, rows + i, 4);
+			}
+		}
 
-		if (!input_is_swizzled)
+		static void to_swizzled(const u8* src, u32 pitch, u8* dst)
 		{
-			for (int y = 0; y < height; ++y)
+			u32 rows[4];
+
+			for (u32 i = 0; i < 4; i++)
 			{
-				T *src = static_cast<T*>(input_pixels) + y * width;
-				T *dst = static_cast<T*>(output_pixels) + offs_y;
-				offs_x = offs_x0;
+				std::memcpy(rows + i, src + i * pitch, 4);
+			}
 
-				for (int x = 0; x < width; ++x)
-				{
-					dst[offs_x] = src[x];
-					offs_x = (offs_x - x_mask) & x_mask;
-				}
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), shuffle(_mm_setr_epi32(rows[0], rows[1], rows[2], rows[3])));
+		}
+	};
+
+	template<bool swap_bytes>
+	struct swizzle_tile<2, swap_bytes>
+	{
+		// Reorder two rows of the tile, optionally byteswapping texels
+		static __m128i shuffle(__m128i v)
+		{
+			v = _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 1, 2, 0));
+			return swap_bytes ? _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8)) : v;
+		}
 
-				offs_y = (offs_y - y_mask) & y_mask;
+		static void to_linear(const u8* src, u8* dst, u32 pitch)
+		{
+			const __m128i lo = shuffle(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)));
+			const __m128i hi = shuffle(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 16)));
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(dst), lo);
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(dst + pitch), _mm_unpackhi_epi64(lo, lo));
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(dst + pitch * 2), hi);
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(dst + pitch * 3), _mm_unpackhi_epi64(hi, hi));
+		}
 
-				if (offs_y == 0)
-				{
-					offs_x0 += y_incr;
-				}
+		static void to_swizzled(const u8* src, u32 pitch, u8* dst)
+		{
+			const __m128i lo = _mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src)), _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + pitch)));
+			const __m128i hi = _mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + pitch * 2)), _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + pitch * 3)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), shuffle(lo));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 16), shuffle(hi));
+		}
+	};
+
+	template<bool swap_bytes>
+	struct swizzle_tile<4, swap_bytes>
+	{
+		static __m128i swap(__m128i v)
+		{
+			return swap_bytes ? _mm_shuffle_epi8(v, _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3)) : v;
+		}
+
+		// Every vector is a 2x2 block in swizzled layout or a half of the row in linear layout
+		static void shuffle(const __m128i(&in)[4], __m128i(&out)[4])
+		{
+			out[0] = swap(_mm_unpacklo_epi64(in[0], in[1]));
+			out[1] = swap(_mm_unpackhi_epi64(in[0], in[1]));
+			out[2] = swap(_mm_unpacklo_epi64(in[2], in[3]));
+			out[3] = swap(_mm_unpackhi_epi64(in[2], in[3]));
+		}
+
+		static void to_linear(const u8* src, u8* dst, u32 pitch)
+		{
+			__m128i in[4], out[4];
+
+			for (u32 i = 0; i < 4; i++)
+			{
+				in[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 16));
+			}
+
+			shuffle(in, out);
+
+			for (u32 i = 0; i < 4; i++)
+			{
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * pitch), out[i]);
 			}
 		}
-		else
+
+		static void to_swizzled(const u8* src, u32 pitch, u8* dst)
 		{
-			for (int y = 0; y < height; ++y)
+			__m128i in[4], out[4];
+
+			for (u32 i = 0; i < 4; i++)
 			{
-				T *src = static_cast<T*>(input_pixels) + offs_y;
-				T *dst = static_cast<T*>(output_pixels) + y * width;
-				offs_x = offs_x0;
+				in[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * pitch));
+			}
+
+			shuffle(in, out);
 
-				for (int x = 0; x < width; ++x)
+			for (u32 i = 0; i < 4; i++)
+			{
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 16), out[i]);
+			}
+		}
+	};
+
+	// Convert rows [y_begin, y_end) of the image, y_begin must be a multiple of 4
+	template<typename T, bool swap_bytes>
+	void convert_linear_swizzle_rows(const u8* src, u8* dst, u16 width, u32 y_begin, u32 y_end, u32 linear_pitch, u32 log2_min, bool input_is_swizzled)
+	{
+		using tile = swizzle_tile<sizeof(T), swap_bytes>;
+
+		const auto convert_texel = [&](u32 x, u32 y)
+		{
+			const std::size_t swizzled = std::size_t{get_swizzled_offset(x, y, log2_min)} * sizeof(T);
+			const std::size_t linear = std::size_t{y} * linear_pitch + x * sizeof(T);
+
+			if (input_is_swizzled)
+				copy_texel<sizeof(T), swap_bytes>(dst + linear, src + swizzled);
+			else
+				copy_texel<sizeof(T), swap_bytes>(dst + swizzled, src + linear);
+		};
+
+		u32 y = y_begin;
+
+		if (log2_min >= 2)
+		{
+			const u32 tiled_width = width & ~3;
+
+			for (; y + 4 <= y_end; y += 4)
+			{
+				for (u32 x = 0; x < tiled_width; x += 4)
 				{
-					dst[x] = src[offs_x];
-					offs_x = (offs_x - x_mask) & x_mask;
-				}
+					const std::size_t swizzled = std::size_t{get_swizzled_offset(x, y, log2_min)} * sizeof(T);
+					const std::size_t linear = std::size_t{y} * linear_pitch + x * sizeof(T);
 
-				offs_y = (offs_y - y_mask) & y_mask;
+					if (input_is_swizzled)
+						tile::to_linear(src + swizzled, dst + linear, linear_pitch);
+					else
+						tile::to_swizzled(src + linear, linear_pitch, dst + swizzled);
+				}
 
-				if (offs_y == 0)
+				for (u32 x = tiled_width; x < width; x++)
 				{
-					offs_x0 += y_incr;
+					for (u32 i = 0; i < 4; i++)
+					{
+						convert_texel(x, y + i);
+					}
 				}
 			}
 		}
+
+		for (; y < y_end; y++)
+		{
+			for (u32 x = 0; x < width; x++)
+			{
+				convert_texel(x, y);
+			}
+		}
+	}
+
+	// Run task(0) ... task(count - 1) on the texture worker threads and the current thread, wait for completion
+	void run_parallel_tasks(u32 count, const std::function<void(u32)>& task);
+
+	// Images of this size (in bytes) or larger are converted by several threads
+	constexpr u32 swizzle_parallel_threshold = 0x80000;
+
+	// Convert between linear (with pitch in bytes) and swizzled images, optionally byteswapping texels
+	template<typename T, bool swap_bytes = false>
+	void convert_linear_swizzle(const void* input_pixels, void* output_pixels, u16 width, u16 height, u32 linear_pitch, bool input_is_swizzled)
+	{
+		const u32 log2_min = std::min(ceil_log2(width), ceil_log2(height));
+		const auto src = static_cast<const u8*>(input_pixels);
+		const auto dst = static_cast<u8*>(output_pixels);
+
+		if (u64{width} * height * sizeof(T) < swizzle_parallel_threshold)
+		{
+			convert_linear_swizzle_rows<T, swap_bytes>(src, dst, width, 0, height, linear_pitch, log2_min, input_is_swizzled);
+			return;
+		}
+
+		// Split in bands of rows, bands don't share any tile
+		constexpr u32 band_height = 64;
+
+		run_parallel_tasks((height + band_height - 1) / band_height, [&](u32 index)
+		{
+			convert_linear_swizzle_rows<T, swap_bytes>(src, dst, width, index * band_height, std::min<u32>(height, (index + 1) * band_height), linear_pitch, log2_min, input_is_swizzled);
+		});
+	}
+
+	template<typename T>
+	void convert_linear_swizzle(void* input_pixels, void* output_pixels, u16 width, u16 height, bool input_is_swizzled)
+	{
+		convert_linear_swizzle<T>(input_pixels, output_pixels, width, height, width * sizeof(T), input_is_swizzled);
 	}
 
 	void convert_scale_image(u8 *dst, AVPixelFormat dst_format, int dst_width, int dst_height, int dst_pitch,
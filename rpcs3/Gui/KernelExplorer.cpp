@@ -69,10 +69,19 @@ void KernelExplorer::Update()
 		return;
 	}
 
-	const u32 total_memory_usage = vm_block->used();
+	const auto stats = vm_block->stats();
+
+	const u32 total_memory_usage = stats.used;
 
 	const auto& root = m_tree->AddRoot(fmt::format("Process, ID = 0x00000001, Total Memory Usage = 0x%x (%0.2f MB)", total_memory_usage, (float)total_memory_usage / (1024 * 1024)));
 
+	// Memory block fragmentation
+	{
+		const auto& node = m_tree->AppendItem(root, fmt::format("User Memory (%u allocations)", stats.allocs));
+		m_tree->AppendItem(node, fmt::format("Free: 0x%x (%0.2f MB) in %u extents", stats.free, (float)stats.free / (1024 * 1024), stats.free_extents));
+		m_tree->AppendItem(node, fmt::format("Largest Free Extent: 0x%x (%0.2f MB)", stats.largest_free, (float)stats.largest_free / (1024 * 1024)));
+	}
+
 	union name64
 	{
 		u64 u64_data;